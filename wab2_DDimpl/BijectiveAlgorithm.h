@@ -5,6 +5,11 @@
 #include <stdexcept>
 #include <algorithm>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
+#include <memory>
+#include <iterator>
 
 // TODO: only needed for debugging. Must be removed in the end
 #include <iostream>
@@ -17,11 +22,12 @@
 * -> Build BijectiveModifer
 *	-> Must be at least AttributePath-Value -> std::string
 *	-> can contain more steps, must be chained in this case
+*	-> hot chains can be built as FusedModifier and converted to a BijectiveModifier afterwards
 * -> Build Columns using AttributePaths and BijectiveModifer
 * -> Init Algorithm with a view and columns, check if it is valid and run
+*	-> apply() returns strings, apply_typed() keeps native values until they are exported
 */
 
-
 /*
 * Contains a function resolving a DiagramElement to some value T
 */
@@ -243,14 +249,34 @@ template<typename T_node, typename T_in, typename T_out>
 class BijeciveModifier
 {
 public:
+	using node_type = T_node;
+	using in_type = T_in;
+	using out_type = T_out;
+
 	std::function<T_out(T_in)> func_apply;
 	std::function<T_in(T_out)> func_revert;
 
+	// Optional: whole-column variants of func_apply/func_revert (input, output, count).
+	// If they are not set the batch functions fall back to calling the row-wise functions
+	std::function<void(const T_in*, T_out*, size_t)> func_apply_batch;
+	std::function<void(const T_out*, T_in*, size_t)> func_revert_batch;
+
 	BijeciveModifier(std::function<T_out(T_in)> func_apply, std::function<T_in(T_out)> func_revert)
 		: func_apply(func_apply),
 		  func_revert(func_revert)
 	{}
 
+	BijeciveModifier(
+		std::function<T_out(T_in)> func_apply,
+		std::function<T_in(T_out)> func_revert,
+		std::function<void(const T_in*, T_out*, size_t)> func_apply_batch,
+		std::function<void(const T_out*, T_in*, size_t)> func_revert_batch)
+		: func_apply(func_apply),
+		  func_revert(func_revert),
+		  func_apply_batch(func_apply_batch),
+		  func_revert_batch(func_revert_batch)
+	{}
+
 	T_out apply(T_in value) const
 	{
 		return func_apply(value);
@@ -261,6 +287,77 @@ public:
 		return func_revert(value);
 	}
 
+	/*
+	* \brief apply the modifier on count values. values and out must not overlap
+	*/
+	void apply_batch(const T_in* values, T_out* out, size_t count) const
+	{
+		if (func_apply_batch)
+		{
+			func_apply_batch(values, out, count);
+			return;
+		}
+
+		for (size_t i = 0; i < count; i++) out[i] = func_apply(values[i]);
+	}
+
+	/*
+	* \brief revert count values. values and out must not overlap
+	*/
+	void revert_batch(const T_out* values, T_in* out, size_t count) const
+	{
+		if (func_revert_batch)
+		{
+			func_revert_batch(values, out, count);
+			return;
+		}
+
+		for (size_t i = 0; i < count; i++) out[i] = func_revert(values[i]);
+	}
+
+	/*
+	* \brief like the pointer variant. Types without default constructor can't be batched into a buffer, they are applied row-wise
+	*/
+	std::vector<T_out> apply_batch(const std::vector<T_in>& values) const
+	{
+		std::vector<T_out> out;
+		if constexpr (std::is_default_constructible_v<T_out>)
+		{
+			out.resize(values.size());
+			apply_batch(values.data(), out.data(), values.size());
+		}
+		else
+		{
+			out.reserve(values.size());
+			for (const T_in& value : values) out.push_back(func_apply(value));
+		}
+		return out;
+	}
+
+	std::vector<T_in> revert_batch(const std::vector<T_out>& values) const
+	{
+		std::vector<T_in> out;
+		if constexpr (std::is_default_constructible_v<T_in>)
+		{
+			out.resize(values.size());
+			revert_batch(values.data(), out.data(), values.size());
+		}
+		else
+		{
+			out.reserve(values.size());
+			for (const T_out& value : values) out.push_back(func_revert(value));
+		}
+		return out;
+	}
+
+	/*
+	* \brief true if at least one direction has a dedicated batch implementation
+	*/
+	bool has_batch() const
+	{
+		return func_apply_batch || func_revert_batch;
+	}
+
 	/*
 	* Validate the stored functions.
 	* True if the fuctions are bijective for the given values
@@ -308,9 +405,9 @@ public:
 	* \brief Chain this BijectiveModifier with another one and return the newly created Modifier
 	*/
 	template<typename T_out_new>
-	BijeciveModifier<T_node, T_in, T_out_new> chain_with(BijeciveModifier<T_node, T_out, T_out_new>& modifier_second)
+	BijeciveModifier<T_node, T_in, T_out_new> chain_with(const BijeciveModifier<T_node, T_out, T_out_new>& modifier_second)
 	{
-		return BijeciveModifier<T_node, T_in, T_out_new>(
+		BijeciveModifier<T_node, T_in, T_out_new> chained(
 			[modifier_first = *this, modifier_second](const T_in& val)->T_out_new
 			{
 				T_out cache = modifier_first.apply(val);
@@ -322,9 +419,180 @@ public:
 				return modifier_first.revert(cache_reverse);
 			}
 			);
+
+		// the intermediate column is buffered, which needs a default constructible T_out. Other chains stay row-wise
+		if constexpr (std::is_default_constructible_v<T_out>)
+		{
+			// Without any batch stage the row-wise chain is cheaper than buffering the intermediate column
+			if (!has_batch() && !modifier_second.has_batch()) return chained;
+
+			chained.func_apply_batch = [modifier_first = *this, modifier_second](const T_in* values, T_out_new* out, size_t count)
+			{
+				std::vector<T_out> cache(count);
+				modifier_first.apply_batch(values, cache.data(), count);
+				modifier_second.apply_batch(cache.data(), out, count);
+			};
+			chained.func_revert_batch = [modifier_first = *this, modifier_second](const T_out_new* values, T_in* out, size_t count)
+			{
+				std::vector<T_out> cache_reverse(count);
+				modifier_second.revert_batch(values, cache_reverse.data(), count);
+				modifier_first.revert_batch(cache_reverse.data(), out, count);
+			};
+		}
+
+		return chained;
 	}
 };
 
+// forward declaration, needed by FusedModifierBase::chain_with
+template<typename T_first, typename T_second>
+class ModifierChain;
+
+/*
+* Shared functionality of all compile-time modifiers.
+* T_derived must provide node_type, in_type, out_type, apply() and revert()
+*/
+template<typename T_derived>
+class FusedModifierBase
+{
+public:
+	/*
+	* \brief Chain this modifier with another one. The resulting type contains both stages by value,
+	*        no std::function is created
+	* \param modifier_second: any modifier whose in_type matches this out_type (fused or BijeciveModifier)
+	*/
+	template<typename T_next>
+	ModifierChain<T_derived, T_next> chain_with(const T_next& modifier_second) const &
+	{
+		return ModifierChain<T_derived, T_next>(derived(), modifier_second);
+	}
+
+	template<typename T_next>
+	ModifierChain<T_derived, T_next> chain_with(const T_next& modifier_second) &&
+	{
+		return ModifierChain<T_derived, T_next>(std::move(static_cast<T_derived&>(*this)), modifier_second);
+	}
+
+	/*
+	* \brief Convert into the type-erased BijeciveModifier. The whole pipeline is wrapped only once,
+	*        so applying the result costs a single indirect call
+	*/
+	template<typename T_self = T_derived>
+	BijeciveModifier<typename T_self::node_type, typename T_self::in_type, typename T_self::out_type> to_modifier() const
+	{
+		using T_in = typename T_self::in_type;
+		using T_out = typename T_self::out_type;
+
+		// the batch variants run the inlined pipeline in a tight loop
+		return BijeciveModifier<typename T_self::node_type, T_in, T_out>(
+			[pipe = derived()](T_in val)->T_out { return pipe.apply(val); },
+			[pipe = derived()](T_out val)->T_in { return pipe.revert(val); },
+			[pipe = derived()](const T_in* values, T_out* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = pipe.apply(values[i]);
+			},
+			[pipe = derived()](const T_out* values, T_in* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = pipe.revert(values[i]);
+			}
+			);
+	}
+
+	template<typename T_node, typename T_in, typename T_out>
+	operator BijeciveModifier<T_node, T_in, T_out>() const
+	{
+		return to_modifier();
+	}
+
+private:
+	const T_derived& derived() const
+	{
+		return static_cast<const T_derived&>(*this);
+	}
+};
+
+/*
+* Compile-time counterpart of BijeciveModifier.
+* The functors are stored by their own type and called directly, so the compiler can inline them
+*/
+template<typename T_node, typename T_in, typename T_out, typename F_apply, typename F_revert>
+class FusedModifier : public FusedModifierBase<FusedModifier<T_node, T_in, T_out, F_apply, F_revert>>
+{
+public:
+	using node_type = T_node;
+	using in_type = T_in;
+	using out_type = T_out;
+
+	F_apply func_apply;
+	F_revert func_revert;
+
+	FusedModifier(F_apply func_apply, F_revert func_revert)
+		: func_apply(std::move(func_apply)),
+		  func_revert(std::move(func_revert))
+	{}
+
+	T_out apply(const T_in& value) const
+	{
+		return func_apply(value);
+	}
+
+	T_in revert(const T_out& value) const
+	{
+		return func_revert(value);
+	}
+};
+
+/*
+* Two modifiers executed one after another.
+* Nesting ModifierChains builds an expression chain which is expanded at compile time
+*/
+template<typename T_first, typename T_second>
+class ModifierChain : public FusedModifierBase<ModifierChain<T_first, T_second>>
+{
+	static_assert(std::is_same<typename T_first::out_type, typename T_second::in_type>::value,
+		"ModifierChain: output of the first modifier must be the input of the second one");
+	static_assert(std::is_same<typename T_first::node_type, typename T_second::node_type>::value,
+		"ModifierChain: both modifiers must operate on the same node type");
+
+public:
+	using node_type = typename T_first::node_type;
+	using in_type = typename T_first::in_type;
+	using out_type = typename T_second::out_type;
+
+	T_first first;
+	T_second second;
+
+	ModifierChain(T_first first, T_second second)
+		: first(std::move(first)),
+		  second(std::move(second))
+	{}
+
+	out_type apply(const in_type& value) const
+	{
+		return second.apply(first.apply(value));
+	}
+
+	in_type revert(const out_type& value) const
+	{
+		return first.revert(second.revert(value));
+	}
+};
+
+/*
+* \brief generate a FusedModifier, the functor types are deduced
+*/
+template<typename T_node, typename T_in, typename T_out, typename F_apply, typename F_revert>
+FusedModifier<T_node, T_in, T_out, std::decay_t<F_apply>, std::decay_t<F_revert>> make_fused_modifier(F_apply&& func_apply, F_revert&& func_revert)
+{
+	return FusedModifier<T_node, T_in, T_out, std::decay_t<F_apply>, std::decay_t<F_revert>>(
+		std::forward<F_apply>(func_apply),
+		std::forward<F_revert>(func_revert));
+}
+
+// forward declaration, see TypedTable
+template <typename T_node>
+class TypedColumnBase;
+
 /*
 * This class represents a column
 * All in all it just stores a list of values which may be displayed as a column
@@ -333,12 +601,23 @@ template <typename T_node>
 class ColumnBase
 {
 public:
+	virtual ~ColumnBase() = default;
 
 	virtual std::vector<std::string> build(const SelectiveView<T_node>& values) const = 0;
 	virtual std::string header() const = 0;
 
+	/*
+	* \brief string value of a single node. Allows streaming a table row by row
+	*/
+	virtual std::string build_value(const T_node* node) const = 0;
+
 	virtual bool is_valid(const SelectiveView<T_node>& values) const { return false; }
 	virtual bool sync_with(const SelectiveView<T_node>& values, std::vector<std::string> col_out) { return false; }
+
+	/*
+	* \brief create an empty storage holding this columns values in their native type. nullptr if not supported
+	*/
+	virtual std::unique_ptr<TypedColumnBase<T_node>> make_typed() { return nullptr; }
 };
 
 template<typename T_node, typename T_val>
@@ -366,18 +645,26 @@ public:
 	*/
 	std::vector<std::string> build(const SelectiveView<T_node>& values) const
 	{
-		std::vector<std::string> ret_vector{ header() };
+		// collect the whole column first so the modifier can process it in one batch
+		std::vector<T_val> vals;
+		vals.reserve(values.view_nodes.size());
 		for (const T_node* node : values.view_nodes)
 		{
-			const T_val val = linked_attr.get_value(node);
-			const std::string val_modified = modifier_pipe.apply(val);
-
-			ret_vector.push_back(val_modified);
+			vals.push_back(linked_attr.get_value(node));
 		}
 
+		std::vector<std::string> ret_vector(vals.size() + 1);
+		ret_vector.front() = header();
+		modifier_pipe.apply_batch(vals.data(), ret_vector.data() + 1, vals.size());
+
 		return ret_vector;
 	}
 
+	std::string build_value(const T_node* node) const override
+	{
+		return modifier_pipe.apply(linked_attr.get_value(node));
+	}
+
 	/*
 	* \brief  Check if the combination of values, AttributePath and BijectiveModifier is valid
 	*/
@@ -409,27 +696,27 @@ public:
 		col_build.erase(col_build.begin());
 
 		// get original set
-		std::vector<T_val> col_originals = {};
-		for (const std::string& val : col_build)
-		{
-			col_originals.push_back(modifier_pipe.revert(val));
-		}
+		const std::vector<T_val> col_originals = modifier_pipe.revert_batch(col_build);
 
 		// drop header
 		
 		col_out.erase(col_out.begin());
 
+		// revert the passed column at once
+		const std::vector<T_val> col_out_reverted = modifier_pipe.revert_batch(col_out);
+
 		// store T_vals which are new due to the sync
 		std::vector<T_val> reached_vals = {};
 		std::vector<std::string> reached_val_keys = {};
 
 		// Check if there are collisions with the currently existing sets
-		for(const std::string& val : col_out)
+		for(size_t i = 0; i < col_out.size(); i++)
 		{
+			const std::string& val = col_out.at(i);
 			if (std::find(col_build.begin(), col_build.end(), val) == col_build.end())
 			{
 				//check if pipe is bijective for this value
-				const T_val reverted = modifier_pipe.revert(val);
+				const T_val& reverted = col_out_reverted.at(i);
 				const std::string applied = modifier_pipe.apply(reverted);
 
 				// same value after transition?
@@ -458,15 +745,11 @@ public:
 		for(size_t i = 0; i < col_out.size(); i++)
 		{
 			T_node* node = values.view_nodes.at(i);
-			T_val val_new = modifier_pipe.revert(col_out.at(i));
+			const T_val& val_new = col_out_reverted.at(i);
 			T_val val_old = linked_attr.get_value(node);
 
 			// set value
-			if (val_old != val_new) 
-			{
-				success_flag &= linked_attr.set_value(node, val_new);
-				std::cout << "comparing " << val_old << " " << val_new << " new flag state: " << success_flag << "\n";
-			}
+			if (val_old != val_new) success_flag &= linked_attr.set_value(node, val_new);
 		}
 		return success_flag;
 	}
@@ -475,6 +758,256 @@ public:
 	{
 		return _header;
 	}
+
+	std::unique_ptr<TypedColumnBase<T_node>> make_typed() override;
+};
+
+/*
+* Type erased part of a TypedColumn
+*/
+template <typename T_node>
+class TypedColumnBase
+{
+public:
+	virtual ~TypedColumnBase() = default;
+
+	virtual std::string header() const = 0;
+	virtual size_t size() const = 0;
+
+	/*
+	* \brief replace the stored values with the current values of the view
+	*/
+	virtual void load(const SelectiveView<T_node>& values) = 0;
+
+	/*
+	* \brief string representation of a single value. Conversion is only done here
+	*/
+	virtual std::string export_value(size_t row) const = 0;
+
+	/*
+	* \brief string representation of the whole column, header included. Same layout as Column::build
+	*/
+	virtual std::vector<std::string> export_column() const = 0;
+
+	/*
+	* \brief append values given by their string representation. Returns false and keeps the stored values
+	*        if a string does not survive an import/export round trip
+	*/
+	virtual bool import_values(const std::vector<std::string>& strings) = 0;
+
+	/*
+	* \brief rows whose stored value differs from the value of the corresponding view node
+	*/
+	virtual std::vector<size_t> diff(const SelectiveView<T_node>& values) const = 0;
+
+	virtual bool is_valid(const SelectiveView<T_node>& values) const = 0;
+
+	/*
+	* \brief write all changed values back into the nodes. Resolving is done by position
+	*/
+	virtual bool sync_with(const SelectiveView<T_node>& values) = 0;
+};
+
+/*
+* Column values stored in their native type in contiguous storage.
+* Validation and diffing compare T_vals directly, strings are only created on export
+*/
+template<typename T_node, typename T_val>
+class TypedColumn : public TypedColumnBase<T_node>
+{
+public:
+	// column this storage was created from. Provides AttributePath and BijeciveModifier
+	Column<T_node, T_val>* column;
+	std::vector<T_val> data;
+
+	TypedColumn(Column<T_node, T_val>* column)
+		: column(column)
+	{}
+
+	std::string header() const override
+	{
+		return column->header();
+	}
+
+	size_t size() const override
+	{
+		return data.size();
+	}
+
+	void load(const SelectiveView<T_node>& values) override
+	{
+		data.clear();
+		data.reserve(values.view_nodes.size());
+
+		for (const T_node* node : values.view_nodes)
+		{
+			data.push_back(column->linked_attr.get_value(node));
+		}
+	}
+
+	std::string export_value(size_t row) const override
+	{
+		return column->modifier_pipe.apply(data.at(row));
+	}
+
+	std::vector<std::string> export_column() const override
+	{
+		std::vector<std::string> ret_vector(data.size() + 1);
+		ret_vector.front() = header();
+		column->modifier_pipe.apply_batch(data.data(), ret_vector.data() + 1, data.size());
+
+		return ret_vector;
+	}
+
+	bool import_values(const std::vector<std::string>& strings) override
+	{
+		const BijeciveModifier<T_node, T_val, std::string>& pipe = column->modifier_pipe;
+		std::vector<T_val> reverted = pipe.revert_batch(strings);
+
+		for (size_t i = 0; i < strings.size(); i++)
+		{
+			if (pipe.apply(reverted.at(i)) != strings.at(i)) return false;
+		}
+
+		data.insert(data.end(), std::make_move_iterator(reverted.begin()), std::make_move_iterator(reverted.end()));
+		return true;
+	}
+
+	std::vector<size_t> diff(const SelectiveView<T_node>& values) const override
+	{
+		std::vector<size_t> rows;
+		const size_t count = std::min(data.size(), values.view_nodes.size());
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!(column->linked_attr.get_value(values.view_nodes.at(i)) == data.at(i))) rows.push_back(i);
+		}
+		return rows;
+	}
+
+	/*
+	* \brief Check if the stored values can be written back.
+	*        The column must be valid for the view and every changed value must survive an export/import round trip
+	*        without colliding with another value of the column: neither with the value of an unchanged row
+	*        nor with the new value of another changed row
+	*/
+	bool is_valid(const SelectiveView<T_node>& values) const override
+	{
+		if (data.size() != values.view_nodes.size()) return false;
+		if (!column->is_valid(values)) return false;
+
+		const std::vector<size_t> changed = diff(values);
+		if (changed.empty()) return true;
+
+		std::vector<bool> is_changed(data.size(), false);
+		for (size_t row : changed) is_changed.at(row) = true;
+
+		// exported values of the unchanged rows. Round trips are exact, so comparing exports compares values
+		std::unordered_set<std::string> taken;
+		taken.reserve(data.size());
+		for (size_t row = 0; row < data.size(); row++)
+		{
+			if (!is_changed.at(row)) taken.insert(export_value(row));
+		}
+
+		const BijeciveModifier<T_node, T_val, std::string>& pipe = column->modifier_pipe;
+		for (size_t row : changed)
+		{
+			const T_val& val = data.at(row);
+			const std::string applied = pipe.apply(val);
+
+			// same value after transition?
+			if (!(pipe.revert(applied) == val)) return false;
+
+			// value already used by another row?
+			if (!taken.insert(applied).second) return false;
+		}
+		return true;
+	}
+
+	bool sync_with(const SelectiveView<T_node>& values) override
+	{
+		if (!is_valid(values)) return false;
+
+		bool success_flag = true;
+		for (size_t row : diff(values))
+		{
+			success_flag &= column->linked_attr.set_value(values.view_nodes.at(row), data.at(row));
+		}
+		return success_flag;
+	}
+
+	T_val& at(size_t row)
+	{
+		return data.at(row);
+	}
+
+	const T_val& at(size_t row) const
+	{
+		return data.at(row);
+	}
+};
+
+template<typename T_node, typename T_val>
+std::unique_ptr<TypedColumnBase<T_node>> Column<T_node, T_val>::make_typed()
+{
+	return std::make_unique<TypedColumn<T_node, T_val>>(this);
+}
+
+/*
+* Table of TypedColumns. Counterpart of the string table returned by BijectiveAlgorithm::apply
+*/
+template <typename T_node>
+class TypedTable
+{
+public:
+	std::vector<std::unique_ptr<TypedColumnBase<T_node>>> columns;
+
+	/*
+	* \brief access a column with its native type. Throws if T_val does not match the column
+	*/
+	template<typename T_val>
+	TypedColumn<T_node, T_val>& column(size_t index)
+	{
+		TypedColumn<T_node, T_val>* col = dynamic_cast<TypedColumn<T_node, T_val>*>(columns.at(index).get());
+		if (col == nullptr) throw std::logic_error("TypedTable: column '" + columns.at(index)->header() + "' does not store the requested type");
+
+		return *col;
+	}
+
+	/*
+	* \brief convert all columns to strings. Same layout as BijectiveAlgorithm::apply
+	*/
+	std::vector<std::vector<std::string>> export_strings() const
+	{
+		std::vector<std::vector<std::string>> table;
+		table.reserve(columns.size());
+
+		for (const std::unique_ptr<TypedColumnBase<T_node>>& col : columns)
+		{
+			table.push_back(col->export_column());
+		}
+		return table;
+	}
+};
+
+/*
+* Outcome of BijectiveAlgorithm::sync_with_key
+*/
+template <typename T_node>
+struct SyncReport
+{
+	// true if the table could be matched and every matched value was set
+	bool success = false;
+
+	// row indices (header excluded) whose key does not belong to any node of the view
+	std::vector<size_t> unmatched_rows;
+
+	// row indices (header excluded) whose key was already used by an earlier row. These rows are ignored
+	std::vector<size_t> duplicate_rows;
+
+	// nodes of the view no row was found for. They are left untouched
+	std::vector<T_node*> unmatched_nodes;
 };
 
 template <typename T_node>
@@ -506,6 +1039,27 @@ public:
 		return table;
 	}
 
+	/*
+	* \brief generate a table holding the native values of all columns. No string conversion is done
+	*        Throws if a column does not support typed storage
+	*/
+	TypedTable<T_node> apply_typed()
+	{
+		TypedTable<T_node> table;
+		table.columns.reserve(columns.size());
+
+		for (ColumnBase<T_node>* col : columns)
+		{
+			std::unique_ptr<TypedColumnBase<T_node>> typed = col->make_typed();
+			if (typed == nullptr) throw std::logic_error("column '" + col->header() + "' does not support typed storage");
+
+			typed->load(view);
+			table.columns.push_back(std::move(typed));
+		}
+
+		return table;
+	}
+
 	void register_column(ColumnBase<T_node>* col)
 	{
 		columns.push_back(col);
@@ -551,6 +1105,149 @@ public:
 		return success_flag;
 	}
 
+	/*
+	* \brief try to sync the passed table. Rows are resolved by the value in key_column instead of their position,
+	*        so rows may be reordered, filtered or contain unknown keys. The key column itself is not modified
+	*        Matching is done via a hash map: O(rows + nodes)
+	*        Bijectivity is checked over the whole view: a changed value must not be used by any other node,
+	*        unmatched nodes count with their current values
+	* \param table: column major table like returned by apply()
+	* \param key_column: index of the column containing unique keys, e.g. an id column
+	*/
+	SyncReport<T_node> sync_with_key(const std::vector<std::vector<std::string>>& table, size_t key_column)
+	{
+		SyncReport<T_node> report;
+
+		// This object must be valid
+		if (!is_valid()) return report;
+
+		// columns are still mapped by vector position
+		if (table.size() != columns.size() || key_column >= columns.size()) return report;
+
+		// all columns must have the same amount of rows
+		const size_t row_count = table.at(key_column).size();
+		if (row_count == 0) return report;
+		for (const std::vector<std::string>& col_output : table) if (col_output.size() != row_count) return report;
+
+		// hash the keys of all nodes
+		std::unordered_map<std::string, size_t> node_of_key;
+		node_of_key.reserve(view.view_nodes.size());
+
+		for (size_t i = 0; i < view.view_nodes.size(); i++)
+		{
+			// a key shared by multiple nodes can't be resolved
+			if (!node_of_key.insert({ columns.at(key_column)->build_value(view.view_nodes.at(i)), i }).second) return report;
+		}
+
+		// resolve rows, skip header. Row of every node, 0 if unmatched
+		std::vector<size_t> row_of_node(view.view_nodes.size(), 0);
+
+		for (size_t row = 1; row < row_count; row++)
+		{
+			auto it = node_of_key.find(table.at(key_column).at(row));
+			if (it == node_of_key.end())
+			{
+				report.unmatched_rows.push_back(row - 1);
+				continue;
+			}
+			if (row_of_node.at(it->second) != 0)
+			{
+				report.duplicate_rows.push_back(row - 1);
+				continue;
+			}
+
+			row_of_node.at(it->second) = row;
+		}
+
+		for (size_t i = 0; i < row_of_node.size(); i++)
+		{
+			if (row_of_node.at(i) == 0) report.unmatched_nodes.push_back(view.view_nodes.at(i));
+		}
+
+		// whole columns in view order: matched nodes get the value of their row, unmatched nodes keep their current value
+		std::vector<std::vector<std::string>> full_table(columns.size());
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			if (i == key_column) continue;
+
+			std::vector<std::string>& col_full = full_table.at(i);
+			col_full.reserve(view.view_nodes.size() + 1);
+			col_full.push_back(table.at(i).front());
+
+			std::unordered_set<std::string> taken;
+			std::vector<size_t> changed;
+			for (size_t node = 0; node < view.view_nodes.size(); node++)
+			{
+				std::string current = columns.at(i)->build_value(view.view_nodes.at(node));
+				const size_t row = row_of_node.at(node);
+
+				if (row == 0 || table.at(i).at(row) == current)
+				{
+					taken.insert(current);
+					col_full.push_back(std::move(current));
+				}
+				else
+				{
+					changed.push_back(col_full.size());
+					col_full.push_back(table.at(i).at(row));
+				}
+			}
+
+			// validate everything before the first value is written
+			for (size_t index : changed)
+			{
+				if (!taken.insert(col_full.at(index)).second) return report;
+			}
+		}
+
+		// the key column is identical by construction
+		bool success_flag = true;
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			if (i == key_column) continue;
+			success_flag &= columns.at(i)->sync_with(view, full_table.at(i));
+		}
+
+		report.success = success_flag;
+		return report;
+	}
+
+	/*
+	* \brief like sync_with_key, the key column is selected by its header
+	*/
+	SyncReport<T_node> sync_with_key(const std::vector<std::vector<std::string>>& table, const std::string& key_header)
+	{
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			if (columns.at(i)->header() == key_header) return sync_with_key(table, i);
+		}
+		return SyncReport<T_node>();
+	}
+
+	/*
+	* \brief like sync_with, but takes a table created by apply_typed. Resolving is done by vector position!
+	*        Only values which differ from the tree are written
+	*/
+	bool sync_with(TypedTable<T_node>& table)
+	{
+		if (!is_valid()) return false;
+
+		if (table.columns.size() != columns.size()) return false;
+
+		// validate everything before the first value is written
+		for (const std::unique_ptr<TypedColumnBase<T_node>>& col : table.columns)
+		{
+			if (!col->is_valid(view)) return false;
+		}
+
+		bool success_flag = true;
+		for (std::unique_ptr<TypedColumnBase<T_node>>& col : table.columns)
+		{
+			success_flag &= col->sync_with(view);
+		}
+		return success_flag;
+	}
+
 	/*
 	* Helper Functions - mainly constructor forwarders with some template types set
 	*/
@@ -587,4 +1284,13 @@ public:
 	{
 		return BijeciveModifier<T_node, T_in, T_out>(func_apply, func_revert);
 	}
+
+	/*
+	* \brief generate a FusedModifier-object. Use it for chains which are applied often
+	*/
+	template<typename T_in, typename T_out, typename F_apply, typename F_revert>
+	auto make_fused_modifier(F_apply&& func_apply, F_revert&& func_revert)
+	{
+		return ::make_fused_modifier<T_node, T_in, T_out>(std::forward<F_apply>(func_apply), std::forward<F_revert>(func_revert));
+	}
 };
\ No newline at end of file
@@ -0,0 +1,293 @@
+#pragma once
+#include "BijectiveAlgorithm.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+* CSV/TSV import and export for BijectiveAlgorithm tables.
+* The file layout is row based: the first row contains the column headers, every other row one view node.
+* -> write_csv streams rows straight from the view, the table is never materialized
+* -> sync_with_csv reads rows in chunks and keeps only one chunk as strings, values are written after the whole file was validated
+*/
+
+/*
+* \brief Separator and quoting settings
+*/
+struct CsvDialect
+{
+	char delimiter = ',';
+	char quote = '"';
+	std::string line_end = "\r\n"; // RFC 4180
+
+	static CsvDialect csv()
+	{
+		return CsvDialect();
+	}
+
+	static CsvDialect tsv()
+	{
+		CsvDialect dialect;
+		dialect.delimiter = '\t';
+		dialect.line_end = "\n";
+		return dialect;
+	}
+};
+
+/*
+* Writes fields and rows to a stream, quoting fields when needed
+*/
+class CsvWriter
+{
+public:
+	std::ostream& out;
+	CsvDialect dialect;
+
+	CsvWriter(std::ostream& out, const CsvDialect& dialect = CsvDialect::csv())
+		: out(out),
+		  dialect(dialect)
+	{}
+
+	/*
+	* \brief write a single field. Fields containing delimiter, quote, line breaks or outer spaces are quoted,
+	*        quotes inside are doubled
+	*/
+	void write_field(const std::string& field)
+	{
+		bool needs_quotes = !field.empty() && (field.front() == ' ' || field.back() == ' ');
+		for (char c : field)
+		{
+			if (c == dialect.delimiter || c == dialect.quote || c == '\n' || c == '\r')
+			{
+				needs_quotes = true;
+				break;
+			}
+		}
+
+		if (!needs_quotes)
+		{
+			out << field;
+			return;
+		}
+
+		out << dialect.quote;
+		for (char c : field)
+		{
+			if (c == dialect.quote) out << dialect.quote;
+			out << c;
+		}
+		out << dialect.quote;
+	}
+
+	void write_row(const std::vector<std::string>& fields)
+	{
+		for (size_t i = 0; i < fields.size(); i++)
+		{
+			if (i != 0) out << dialect.delimiter;
+			write_field(fields.at(i));
+		}
+		out << dialect.line_end;
+	}
+};
+
+/*
+* Reads rows from a stream. Handles quoted fields with embedded delimiters, quotes and line breaks
+*/
+class CsvReader
+{
+public:
+	std::istream& in;
+	CsvDialect dialect;
+
+	CsvReader(std::istream& in, const CsvDialect& dialect = CsvDialect::csv())
+		: in(in),
+		  dialect(dialect)
+	{}
+
+	/*
+	* \brief read the next row into fields. Returns false if the stream has no more rows
+	*        Throws a std::logic_error for unterminated quotes
+	*/
+	bool read_row(std::vector<std::string>& fields)
+	{
+		fields.clear();
+
+		std::streambuf* buf = in.rdbuf();
+		if (buf->sgetc() == std::char_traits<char>::eof())
+		{
+			in.setstate(std::ios::eofbit);
+			return false;
+		}
+
+		std::string field;
+		bool quoted = false;      // currently inside quotes
+		bool was_quoted = false;  // field started with a quote
+
+		while (true)
+		{
+			const int ch = buf->sbumpc();
+
+			if (ch == std::char_traits<char>::eof())
+			{
+				if (quoted) throw std::logic_error("CsvReader: unterminated quoted field");
+				in.setstate(std::ios::eofbit);
+				break;
+			}
+
+			const char c = static_cast<char>(ch);
+
+			if (quoted)
+			{
+				if (c != dialect.quote)
+				{
+					field.push_back(c);
+				}
+				// doubled quote -> literal quote
+				else if (buf->sgetc() == dialect.quote)
+				{
+					buf->sbumpc();
+					field.push_back(c);
+				}
+				else
+				{
+					quoted = false;
+				}
+			}
+			else if (c == dialect.quote && field.empty() && !was_quoted)
+			{
+				quoted = true;
+				was_quoted = true;
+			}
+			else if (c == dialect.delimiter)
+			{
+				fields.push_back(std::move(field));
+				field.clear();
+				was_quoted = false;
+			}
+			else if (c == '\n')
+			{
+				break;
+			}
+			else if (c == '\r')
+			{
+				if (buf->sgetc() == '\n') buf->sbumpc();
+				break;
+			}
+			else
+			{
+				field.push_back(c);
+			}
+		}
+
+		fields.push_back(std::move(field));
+		return true;
+	}
+};
+
+/*
+* \brief Stream the table of alg into out. One row per view node, the first row contains the headers
+*/
+template<typename T_node>
+void write_csv(const BijectiveAlgorithm<T_node>& alg, std::ostream& out, const CsvDialect& dialect = CsvDialect::csv())
+{
+	CsvWriter writer(out, dialect);
+
+	std::vector<std::string> row;
+	row.reserve(alg.columns.size());
+
+	for (const ColumnBase<T_node>* col : alg.columns) row.push_back(col->header());
+	writer.write_row(row);
+
+	for (const T_node* node : alg.view.view_nodes)
+	{
+		row.clear();
+		for (const ColumnBase<T_node>* col : alg.columns) row.push_back(col->build_value(node));
+		writer.write_row(row);
+	}
+}
+
+/*
+* \brief Read a table written by write_csv and sync it into the view of alg. Resolving is done by row position!
+*        Rows are read in chunks of chunk_size rows, each chunk is converted into the native column types,
+*        so only one chunk is held as strings.
+*        Column order may differ from alg, columns are matched by their header.
+*        Nothing is written before the whole file was read and validated, bijectivity is checked over all rows
+* \return false if the file does not match alg or a modifier rejected a value
+*/
+template<typename T_node>
+bool sync_with_csv(BijectiveAlgorithm<T_node>& alg, std::istream& in, const CsvDialect& dialect = CsvDialect::csv(), size_t chunk_size = 4096)
+{
+	if (chunk_size == 0) throw std::invalid_argument("sync_with_csv: chunk_size must be > 0");
+	if (!alg.is_valid()) return false;
+	if (alg.columns.empty()) return false;
+
+	CsvReader reader(in, dialect);
+	std::vector<std::string> row;
+
+	// resolve header -> column, the header has to be a permutation of the column headers
+	if (!reader.read_row(row)) return false;
+	if (row.size() != alg.columns.size()) return false;
+
+	std::vector<size_t> col_of_field(row.size());
+	std::vector<bool> matched(alg.columns.size(), false);
+	for (size_t field = 0; field < row.size(); field++)
+	{
+		size_t col = 0;
+		while (col < alg.columns.size() && (matched.at(col) || alg.columns.at(col)->header() != row.at(field))) col++;
+		if (col == alg.columns.size()) return false;
+
+		matched.at(col) = true;
+		col_of_field.at(field) = col;
+	}
+
+	// values of all rows in their native type
+	TypedTable<T_node> table;
+	table.columns.reserve(alg.columns.size());
+	for (ColumnBase<T_node>* col : alg.columns)
+	{
+		std::unique_ptr<TypedColumnBase<T_node>> typed = col->make_typed();
+		if (typed == nullptr) return false;
+
+		table.columns.push_back(std::move(typed));
+	}
+
+	// column major chunk of strings
+	std::vector<std::vector<std::string>> chunk(alg.columns.size());
+	const size_t node_count = alg.view.view_nodes.size();
+	size_t row_index = 0;
+
+	auto flush_chunk = [&]()
+	{
+		for (size_t i = 0; i < chunk.size(); i++)
+		{
+			if (!table.columns.at(i)->import_values(chunk.at(i))) return false;
+			chunk.at(i).clear();
+		}
+		return true;
+	};
+
+	while (reader.read_row(row))
+	{
+		// skip empty lines, they can't be told apart from an empty value in single column tables
+		if (row.size() == 1 && row.front().empty() && col_of_field.size() > 1) continue;
+
+		if (row.size() != col_of_field.size()) return false;
+		if (row_index >= node_count) return false;
+
+		for (size_t field = 0; field < row.size(); field++)
+		{
+			chunk.at(col_of_field.at(field)).push_back(std::move(row.at(field)));
+		}
+		row_index++;
+
+		if (chunk.front().size() == chunk_size && !flush_chunk()) return false;
+	}
+	if (!flush_chunk()) return false;
+
+	// mapping is done by position, so every node needs a row
+	if (row_index != node_count) return false;
+
+	// validates every column before the first value is written
+	return alg.sync_with(table);
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include "BijectiveAlgorithm.h"
+#include "DiagramCommons.hpp"
+#include <charconv>
+#include <string>
+
+/*
+* Commonly used BijectiveModifiers.
+* Each of them ships a batch implementation processing a whole column in a tight loop.
+* Use them like any other modifier, e.g. alg.make_column(p_id, modifiers::int_to_string<T_node>(), "ID")
+*/
+namespace modifiers
+{
+	namespace detail
+	{
+		/*
+		* \brief parse a complete string as int. Throws like std::stoi if it is not an int
+		*/
+		inline int parse_int(const std::string& val)
+		{
+			int ret = 0;
+			const char* end = val.data() + val.size();
+			const std::from_chars_result res = std::from_chars(val.data(), end, ret);
+
+			if (res.ec == std::errc::result_out_of_range) throw std::out_of_range("'" + val + "' is out of int range");
+			if (res.ec != std::errc() || res.ptr != end) throw std::invalid_argument("'" + val + "' is not an int");
+
+			return ret;
+		}
+
+		inline std::string format_int(int val)
+		{
+			char buffer[16];
+			const std::to_chars_result res = std::to_chars(buffer, buffer + sizeof(buffer), val);
+			return std::string(buffer, res.ptr);
+		}
+
+		inline int hex_digit(char c)
+		{
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+			throw std::invalid_argument(std::string("'") + c + "' is not a hex digit");
+		}
+
+		/*
+		* \brief "#rrggbb" -> Color
+		*/
+		inline Color parse_hex_color(const std::string& val)
+		{
+			if (val.size() != 7 || val.front() != '#') throw std::invalid_argument("'" + val + "' is not of the format '#rrggbb'");
+
+			const char* p = val.data() + 1;
+			return Color(
+				hex_digit(p[0]) * 16 + hex_digit(p[1]),
+				hex_digit(p[2]) * 16 + hex_digit(p[3]),
+				hex_digit(p[4]) * 16 + hex_digit(p[5]));
+		}
+
+		/*
+		* \brief Color -> "#rrggbb", lower case like drawio writes it
+		*/
+		inline std::string format_hex_color(const Color& val)
+		{
+			static const char digits[] = "0123456789abcdef";
+
+			std::string ret(7, '#');
+			const int channels[3] = { val.red, val.green, val.blue };
+			for (size_t i = 0; i < 3; i++)
+			{
+				ret[1 + i * 2] = digits[(channels[i] >> 4) & 0xf];
+				ret[2 + i * 2] = digits[channels[i] & 0xf];
+			}
+			return ret;
+		}
+	}
+
+	/*
+	* \brief int <-> decimal string. Reverting throws if the string is not a complete int
+	*/
+	template<typename T_node>
+	BijeciveModifier<T_node, int, std::string> int_to_string()
+	{
+		return BijeciveModifier<T_node, int, std::string>(
+			detail::format_int,
+			detail::parse_int,
+			[](const int* values, std::string* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = detail::format_int(values[i]);
+			},
+			[](const std::string* values, int* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = detail::parse_int(values[i]);
+			}
+			);
+	}
+
+	/*
+	* \brief hex color string ("#rrggbb") <-> Color
+	*/
+	template<typename T_node>
+	BijeciveModifier<T_node, std::string, Color> hex_color_to_rgb()
+	{
+		return BijeciveModifier<T_node, std::string, Color>(
+			detail::parse_hex_color,
+			detail::format_hex_color,
+			[](const std::string* values, Color* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = detail::parse_hex_color(values[i]);
+			},
+			[](const Color* values, std::string* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = detail::format_hex_color(values[i]);
+			}
+			);
+	}
+
+	/*
+	* \brief Color <-> "r,g,b" string, chain it after hex_color_to_rgb to display decimal channels
+	*/
+	template<typename T_node>
+	BijeciveModifier<T_node, Color, std::string> rgb_to_string()
+	{
+		const auto format = [](const Color& c)
+		{
+			return detail::format_int(c.red) + ',' + detail::format_int(c.green) + ',' + detail::format_int(c.blue);
+		};
+		const auto parse = [](const std::string& val)
+		{
+			const size_t first = val.find(',');
+			const size_t second = val.find(',', first == std::string::npos ? first : first + 1);
+			if (first == std::string::npos || second == std::string::npos) throw std::invalid_argument("'" + val + "' is not of the format 'r,g,b'");
+
+			return Color(
+				detail::parse_int(val.substr(0, first)),
+				detail::parse_int(val.substr(first + 1, second - first - 1)),
+				detail::parse_int(val.substr(second + 1)));
+		};
+
+		return BijeciveModifier<T_node, Color, std::string>(
+			format,
+			parse,
+			[format](const Color* values, std::string* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = format(values[i]);
+			},
+			[parse](const std::string* values, Color* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = parse(values[i]);
+			}
+			);
+	}
+
+	/*
+	* \brief value * factor + offset. factor must not be 0
+	*        Both directions round, only a power of two factor without offset reverts every value exactly.
+	*        Otherwise some values change in their last bit (0.1 with factor 3), BijeciveModifier::is_valid rejects them
+	*        The batch loops contain no calls, so the compiler is able to vectorize them
+	*/
+	template<typename T_node>
+	BijeciveModifier<T_node, double, double> linear_scale(double factor, double offset = 0)
+	{
+		if (factor == 0) throw std::invalid_argument("linear_scale: factor 0 is not bijective");
+
+		return BijeciveModifier<T_node, double, double>(
+			[factor, offset](double val) { return val * factor + offset; },
+			[factor, offset](double val) { return (val - offset) / factor; },
+			[factor, offset](const double* values, double* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = values[i] * factor + offset;
+			},
+			[factor, offset](const double* values, double* out, size_t count)
+			{
+				for (size_t i = 0; i < count; i++) out[i] = (values[i] - offset) / factor;
+			}
+			);
+	}
+}
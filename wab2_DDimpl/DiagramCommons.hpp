@@ -1,5 +1,8 @@
 #pragma once
 #include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <limits>
 
 /*
 * \brief a simple 2d point
@@ -23,6 +26,109 @@ struct Bounds
 	Dimension dim; //TODO: we don't need 2 dimensions, right?
 };
 
+/*
+* \brief axis aligned box given by its min and max corner
+*        Default constructed boxes are empty, adding points or boxes grows them
+*/
+struct BoundingBox
+{
+	double x0 = std::numeric_limits<double>::infinity(), y0 = std::numeric_limits<double>::infinity();
+	double x1 = -std::numeric_limits<double>::infinity(), y1 = -std::numeric_limits<double>::infinity();
+
+	static BoundingBox from(const Bounds& b)
+	{
+		BoundingBox box;
+		box.x0 = b.pos.x;
+		box.y0 = b.pos.y;
+		box.x1 = b.pos.x + b.dim.width;
+		box.y1 = b.pos.y + b.dim.height;
+		return box;
+	}
+
+	bool empty() const
+	{
+		return !(x0 <= x1 && y0 <= y1);
+	}
+
+	void add(const Point& p)
+	{
+		x0 = std::min(x0, p.x);
+		y0 = std::min(y0, p.y);
+		x1 = std::max(x1, p.x);
+		y1 = std::max(y1, p.y);
+	}
+
+	/*
+	* \brief union with other
+	*/
+	void add(const BoundingBox& other)
+	{
+		if (other.empty()) return;
+
+		x0 = std::min(x0, other.x0);
+		y0 = std::min(y0, other.y0);
+		x1 = std::max(x1, other.x1);
+		y1 = std::max(y1, other.y1);
+	}
+
+	/*
+	* \brief grow by distance in every direction
+	*/
+	void inflate(double distance)
+	{
+		if (empty()) return;
+
+		x0 -= distance;
+		y0 -= distance;
+		x1 += distance;
+		y1 += distance;
+	}
+
+	BoundingBox intersection(const BoundingBox& other) const
+	{
+		BoundingBox box;
+		box.x0 = std::max(x0, other.x0);
+		box.y0 = std::max(y0, other.y0);
+		box.x1 = std::min(x1, other.x1);
+		box.y1 = std::min(y1, other.y1);
+		return box.empty() ? BoundingBox() : box;
+	}
+
+	bool intersects(const BoundingBox& other) const
+	{
+		return !empty() && !other.empty() && x0 <= other.x1 && other.x0 <= x1 && y0 <= other.y1 && other.y0 <= y1;
+	}
+
+	bool contains(const Point& p) const
+	{
+		return p.x >= x0 && p.x <= x1 && p.y >= y0 && p.y <= y1;
+	}
+
+	bool contains(const BoundingBox& other) const
+	{
+		return !other.empty() && other.x0 >= x0 && other.x1 <= x1 && other.y0 >= y0 && other.y1 <= y1;
+	}
+
+	/*
+	* \brief position and dimension. Empty boxes result in zero bounds
+	*/
+	Bounds to_bounds() const
+	{
+		if (empty()) return Bounds{ Point(), Dimension{ 0, 0 } };
+		return Bounds{ Point{ x0, y0 }, Dimension{ x1 - x0, y1 - y0 } };
+	}
+
+	bool operator==(const BoundingBox& other) const
+	{
+		return (empty() && other.empty()) || (x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1);
+	}
+
+	bool operator!=(const BoundingBox& other) const
+	{
+		return !(*this == other);
+	}
+};
+
 /*
 * \brief RGB-Color
 */
@@ -40,12 +146,32 @@ struct Color
 
 	int red, green, blue; //TODO: add constraints: min:0, max:255
 
-	bool operator==(const Color& other)
+	bool operator==(const Color& other) const
 	{
 		return red == other.red && green == other.green && blue == other.blue;
 	}
+
+	bool operator!=(const Color& other) const
+	{
+		return !(*this == other);
+	}
 };
 
+/*
+* allows Colors as keys in unordered containers
+*/
+namespace std
+{
+	template<>
+	struct hash<Color>
+	{
+		size_t operator()(const Color& c) const noexcept
+		{
+			return hash<int>()((c.red << 16) | (c.green << 8) | c.blue);
+		}
+	};
+}
+
 /*
 * Enums
 */
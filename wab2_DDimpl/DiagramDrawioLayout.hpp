@@ -0,0 +1,552 @@
+#pragma once
+#include "DiagramInterChangeDrawio.hpp"
+#include "DiagramThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Hierarchical (Sugiyama) layout of drawio vertices, edges point downwards
+* -> cycles are broken by reversing the back edges of a depth first search
+* -> layers by longest path, edges spanning several layers get a chain of dummy nodes
+* -> crossings are reduced by barycenter sweeps, the ordering with the fewest crossings is kept
+* -> x coordinates: every layer is placed as close as possible to the centers of its neighbors while keeping its order
+* The positions are written into the mxGeometry of the vertices, dummy nodes become the waypoints of their edge
+*/
+namespace drawio
+{
+	class HierarchicalLayout
+	{
+	public:
+		// drawio defaults for vertices without geometry
+		static constexpr double DEFAULT_WIDTH = 120;
+		static constexpr double DEFAULT_HEIGHT = 60;
+
+		// free space between layers and between neighbors in a layer
+		double layer_spacing = 60;
+		double node_spacing = 40;
+
+		// barycenter sweeps, alternating downwards and upwards
+		int sweeps = 24;
+
+		// upper limit of threads of the shared pool, 0: all of them (one per hardware thread)
+		unsigned threads = 0;
+
+		/*
+		* \brief lay out the vertices below root which are not nested in another vertex. Nested vertices move with their parent
+		*        Edges between nested vertices count as edges of their outermost vertices
+		*/
+		void layout(DI::DiagramElement* root)
+		{
+			nodes.clear();
+			edges.clear();
+			node_of.clear();
+
+			collect(root, nullptr);
+
+			remove_cycles();
+			assign_layers();
+			add_dummies();
+			order_layers();
+			assign_coordinates();
+			write_back();
+		}
+
+		/*
+		* \brief edge crossings of the last layout
+		*/
+		size_t crossings() const
+		{
+			return best_crossings;
+		}
+
+	private:
+		struct Node
+		{
+			// nullptr for dummy nodes
+			DI::DiagramElement* cell = nullptr;
+			double width = 0, height = 0;
+
+			size_t layer = 0;
+			size_t position = 0;
+			double x = 0, y = 0;
+
+			// neighbors in the layer above and below
+			std::vector<size_t> up, down;
+		};
+
+		struct Edge
+		{
+			DrawioArrow* arrow;
+			size_t from, to;
+			bool reversed = false;
+
+			// dummy nodes from "from" to "to" after cycle removal
+			std::vector<size_t> chain;
+		};
+
+		std::vector<Node> nodes;
+		std::vector<Edge> edges;
+		std::unordered_map<const DI::DiagramElement*, size_t> node_of;
+		std::vector<std::vector<size_t>> layers;
+		size_t best_crossings = 0;
+
+		static bool is_vertex(const DI::DiagramElement* node)
+		{
+			const DrawioMxcell* cell = dynamic_cast<const DrawioMxcell*>(node);
+			if (cell == nullptr) return false;
+
+			const std::string* vertex = cell->local_style->find("vertex");
+			return vertex != nullptr && *vertex == "1";
+		}
+
+		/*
+		* \brief find the vertices and arrows. top: outermost vertex containing node
+		*/
+		void collect(DI::DiagramElement* node, DI::DiagramElement* top)
+		{
+			DrawioArrow* arrow = dynamic_cast<DrawioArrow*>(node);
+			if (arrow != nullptr)
+			{
+				edges.push_back(Edge{ arrow, 0, 0, false, {} });
+			}
+			else if (is_vertex(node))
+			{
+				if (top == nullptr)
+				{
+					Node vertex;
+					vertex.cell = node;
+
+					Bounds bounds;
+					const bool placed = get_drawio_bounds(node, bounds);
+					vertex.width = placed && bounds.dim.width > 0 ? bounds.dim.width : DEFAULT_WIDTH;
+					vertex.height = placed && bounds.dim.height > 0 ? bounds.dim.height : DEFAULT_HEIGHT;
+
+					top = node;
+					node_of.insert({ node, nodes.size() });
+					nodes.push_back(vertex);
+				}
+				else
+				{
+					node_of.insert({ node, node_of.at(top) });
+				}
+			}
+
+			for (DI::DiagramElement* child : node->owned_elements) collect(child, top);
+		}
+
+		/*
+		* \brief resolve the endpoints and reverse the back edges of a depth first search, afterwards the graph is acyclic
+		*/
+		void remove_cycles()
+		{
+			std::vector<Edge> resolved;
+			for (Edge& edge : edges)
+			{
+				auto source = node_of.find(edge.arrow->source), target = node_of.find(edge.arrow->target);
+
+				// loops and edges to other cells don't take part
+				if (source == node_of.end() || target == node_of.end() || source->second == target->second) continue;
+
+				edge.from = source->second;
+				edge.to = target->second;
+				resolved.push_back(edge);
+			}
+			edges.swap(resolved);
+
+			std::vector<std::vector<size_t>> out(nodes.size());
+			for (size_t i = 0; i < edges.size(); i++) out.at(edges.at(i).from).push_back(i);
+
+			// 0: unvisited, 1: on the stack, 2: done. Iterative, deep graphs would overflow the call stack
+			std::vector<uint8_t> state(nodes.size(), 0);
+			std::vector<std::pair<size_t, size_t>> stack;
+
+			for (size_t root = 0; root < nodes.size(); root++)
+			{
+				if (state.at(root) != 0) continue;
+
+				state.at(root) = 1;
+				stack.push_back({ root, 0 });
+				while (!stack.empty())
+				{
+					auto& [node, next] = stack.back();
+					if (next == out.at(node).size())
+					{
+						state.at(node) = 2;
+						stack.pop_back();
+						continue;
+					}
+
+					Edge& edge = edges.at(out.at(node).at(next++));
+					if (state.at(edge.to) == 1)
+					{
+						edge.reversed = true;
+					}
+					else if (state.at(edge.to) == 0)
+					{
+						state.at(edge.to) = 1;
+						stack.push_back({ edge.to, 0 });
+					}
+				}
+			}
+
+			for (Edge& edge : edges)
+			{
+				if (edge.reversed) std::swap(edge.from, edge.to);
+			}
+		}
+
+		/*
+		* \brief longest path layering: sources on layer 0, every node one layer below its lowest predecessor
+		*/
+		void assign_layers()
+		{
+			std::vector<std::vector<size_t>> out(nodes.size());
+			std::vector<size_t> incoming(nodes.size(), 0);
+			for (const Edge& edge : edges)
+			{
+				out.at(edge.from).push_back(edge.to);
+				incoming.at(edge.to)++;
+			}
+
+			std::vector<size_t> ready;
+			for (size_t i = 0; i < nodes.size(); i++)
+			{
+				if (incoming.at(i) == 0) ready.push_back(i);
+			}
+
+			while (!ready.empty())
+			{
+				const size_t node = ready.back();
+				ready.pop_back();
+
+				for (size_t next : out.at(node))
+				{
+					nodes.at(next).layer = std::max(nodes.at(next).layer, nodes.at(node).layer + 1);
+					if (--incoming.at(next) == 0) ready.push_back(next);
+				}
+			}
+		}
+
+		/*
+		* \brief replace edges spanning several layers by chains of dummy nodes, every edge connects neighboring layers afterwards
+		*/
+		void add_dummies()
+		{
+			for (Edge& edge : edges)
+			{
+				size_t previous = edge.from;
+				for (size_t layer = nodes.at(edge.from).layer + 1; layer < nodes.at(edge.to).layer; layer++)
+				{
+					Node dummy;
+					dummy.layer = layer;
+					nodes.push_back(dummy);
+
+					const size_t id = nodes.size() - 1;
+					nodes.at(previous).down.push_back(id);
+					nodes.at(id).up.push_back(previous);
+					edge.chain.push_back(id);
+					previous = id;
+				}
+				nodes.at(previous).down.push_back(edge.to);
+				nodes.at(edge.to).up.push_back(previous);
+			}
+		}
+
+		/*
+		* \brief run body(i) for i in [0, count) on ThreadPool::shared(), in parallel if there is enough work
+		*        The sweeps call this for every layer, the pool keeps its threads between the calls
+		*/
+		template<typename F>
+		void parallel_for(size_t count, size_t min_per_thread, F body) const
+		{
+			ThreadPool& pool = ThreadPool::shared();
+			unsigned workers = threads != 0 ? std::min(threads, pool.size()) : pool.size();
+			workers = static_cast<unsigned>(std::min<size_t>(workers, count / std::max<size_t>(min_per_thread, 1)));
+
+			if (workers <= 1)
+			{
+				for (size_t i = 0; i < count; i++) body(i);
+				return;
+			}
+			pool.parallel_for(count, [&](size_t i, unsigned) { body(i); }, workers);
+		}
+
+		/*
+		* \brief crossings between layer and the layer below (Barth, Juenger, Mutzel: accumulator tree over the lower positions)
+		*/
+		size_t count_crossings(size_t layer) const
+		{
+			const std::vector<size_t>& lower = layers.at(layer + 1);
+			if (lower.size() < 2) return 0;
+
+			// lower positions of the edges, sorted by upper position first
+			std::vector<size_t> sequence;
+			std::vector<size_t> targets;
+			for (size_t node : layers.at(layer))
+			{
+				targets.clear();
+				for (size_t next : nodes.at(node).down) targets.push_back(nodes.at(next).position);
+				std::sort(targets.begin(), targets.end());
+				sequence.insert(sequence.end(), targets.begin(), targets.end());
+			}
+
+			size_t first = 1;
+			while (first < lower.size()) first *= 2;
+			std::vector<size_t> tree(2 * first - 1, 0);
+			first -= 1;
+
+			size_t crossings = 0;
+			for (size_t position : sequence)
+			{
+				size_t index = position + first;
+				tree.at(index)++;
+				while (index > 0)
+				{
+					if (index % 2 == 1) crossings += tree.at(index + 1);
+					index = (index - 1) / 2;
+					tree.at(index)++;
+				}
+			}
+			return crossings;
+		}
+
+		size_t total_crossings() const
+		{
+			if (layers.size() < 2) return 0;
+
+			// layer pairs are independent
+			std::vector<size_t> per_layer(layers.size() - 1, 0);
+			parallel_for(per_layer.size(), 1, [&](size_t layer) { per_layer[layer] = count_crossings(layer); });
+
+			size_t total = 0;
+			for (size_t c : per_layer) total += c;
+			return total;
+		}
+
+		void update_positions(size_t layer)
+		{
+			const std::vector<size_t>& order = layers.at(layer);
+			for (size_t i = 0; i < order.size(); i++) nodes.at(order[i]).position = i;
+		}
+
+		/*
+		* \brief initial order by a depth first search from the top, then barycenter sweeps
+		*/
+		void order_layers()
+		{
+			size_t count = 0;
+			for (const Node& node : nodes) count = std::max(count, node.layer + 1);
+			layers.assign(count, {});
+
+			// connected nodes start next to each other
+			std::vector<bool> placed(nodes.size(), false);
+			std::vector<size_t> stack;
+			for (size_t root = 0; root < nodes.size(); root++)
+			{
+				if (placed.at(root) || !nodes.at(root).up.empty()) continue;
+
+				stack.push_back(root);
+				while (!stack.empty())
+				{
+					const size_t node = stack.back();
+					stack.pop_back();
+					if (placed.at(node)) continue;
+
+					placed.at(node) = true;
+					layers.at(nodes.at(node).layer).push_back(node);
+					for (auto it = nodes.at(node).down.rbegin(); it != nodes.at(node).down.rend(); it++) stack.push_back(*it);
+				}
+			}
+			for (size_t layer = 0; layer < layers.size(); layer++) update_positions(layer);
+
+			best_crossings = total_crossings();
+			std::vector<std::vector<size_t>> best = layers;
+
+			std::vector<double> barycenter;
+			int without_progress = 0;
+			for (int sweep = 0; sweep < sweeps && best_crossings > 0 && without_progress < 4; sweep++)
+			{
+				const bool downwards = sweep % 2 == 0;
+				for (size_t step = 1; step < layers.size(); step++)
+				{
+					const size_t layer = downwards ? step : layers.size() - 1 - step;
+					std::vector<size_t>& order = layers.at(layer);
+
+					// barycenters only read the fixed neighbor layer, large layers are split across threads
+					barycenter.assign(order.size(), 0);
+					parallel_for(order.size(), 1024, [&](size_t i)
+					{
+						const Node& node = nodes.at(order[i]);
+						const std::vector<size_t>& neighbors = downwards ? node.up : node.down;
+
+						// nodes without neighbors stay where they are
+						if (neighbors.empty())
+						{
+							barycenter[i] = static_cast<double>(node.position);
+							return;
+						}
+
+						double sum = 0;
+						for (size_t neighbor : neighbors) sum += static_cast<double>(nodes.at(neighbor).position);
+						barycenter[i] = sum / neighbors.size();
+					});
+
+					std::vector<size_t> index(order.size());
+					for (size_t i = 0; i < index.size(); i++) index[i] = i;
+					std::stable_sort(index.begin(), index.end(), [&](size_t a, size_t b) { return barycenter[a] < barycenter[b]; });
+
+					std::vector<size_t> sorted(order.size());
+					for (size_t i = 0; i < index.size(); i++) sorted[i] = order[index[i]];
+					order.swap(sorted);
+					update_positions(layer);
+				}
+
+				const size_t crossings = total_crossings();
+				if (crossings < best_crossings)
+				{
+					best_crossings = crossings;
+					best = layers;
+					without_progress = 0;
+				}
+				else
+				{
+					without_progress++;
+				}
+			}
+
+			layers.swap(best);
+			for (size_t layer = 0; layer < layers.size(); layer++) update_positions(layer);
+		}
+
+		/*
+		* \brief centers of the nodes of layer as close as possible (least squares) to desired, keeping their order and spacing
+		*        Pool adjacent violators on the centers minus the minimal offsets to the first node
+		*/
+		void place_layer(size_t layer, const std::vector<double>& desired)
+		{
+			const std::vector<size_t>& order = layers.at(layer);
+
+			std::vector<double> offset(order.size(), 0);
+			for (size_t i = 1; i < order.size(); i++)
+			{
+				offset[i] = offset[i - 1] + (nodes.at(order[i - 1]).width + nodes.at(order[i]).width) / 2 + node_spacing;
+			}
+
+			// blocks of equal value: sum and count
+			std::vector<std::pair<double, size_t>> blocks;
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				blocks.push_back({ desired[i] - offset[i], 1 });
+				while (blocks.size() > 1)
+				{
+					const auto& last = blocks[blocks.size() - 1];
+					const auto& before = blocks[blocks.size() - 2];
+					if (before.first / before.second <= last.first / last.second) break;
+
+					const std::pair<double, size_t> merged{ before.first + last.first, before.second + last.second };
+					blocks.pop_back();
+					blocks.back() = merged;
+				}
+			}
+
+			size_t i = 0;
+			for (const auto& block : blocks)
+			{
+				const double value = block.first / block.second;
+				for (size_t k = 0; k < block.second; k++, i++) nodes.at(order[i]).x = value + offset[i];
+			}
+		}
+
+		void assign_coordinates()
+		{
+			// layers are as high as their highest vertex, vertices are centered in their layer
+			double top = 0;
+			for (const std::vector<size_t>& order : layers)
+			{
+				double height = 0;
+				for (size_t node : order) height = std::max(height, nodes.at(node).height);
+				for (size_t node : order) nodes.at(node).y = top + (height - nodes.at(node).height) / 2;
+				top += height + layer_spacing;
+			}
+
+			// packed start, then every layer follows the centers of its neighbors
+			std::vector<double> desired;
+			for (size_t layer = 0; layer < layers.size(); layer++)
+			{
+				desired.assign(layers.at(layer).size(), 0);
+				place_layer(layer, desired);
+			}
+
+			for (int pass = 0; pass < 8; pass++)
+			{
+				const bool downwards = pass % 2 == 0;
+				for (size_t step = 0; step < layers.size(); step++)
+				{
+					const size_t layer = downwards ? step : layers.size() - 1 - step;
+					const std::vector<size_t>& order = layers.at(layer);
+
+					desired.assign(order.size(), 0);
+					for (size_t i = 0; i < order.size(); i++)
+					{
+						const Node& node = nodes.at(order[i]);
+
+						// the last pass uses both sides
+						std::vector<size_t> neighbors = downwards ? node.up : node.down;
+						if (pass == 7) neighbors.insert(neighbors.end(), node.up.begin(), node.up.end());
+
+						double sum = 0;
+						for (size_t neighbor : neighbors) sum += nodes.at(neighbor).x;
+						desired[i] = neighbors.empty() ? node.x : sum / neighbors.size();
+					}
+					place_layer(layer, desired);
+				}
+			}
+
+			// left border at 0
+			double left = std::numeric_limits<double>::infinity();
+			for (const Node& node : nodes) left = std::min(left, node.x - node.width / 2);
+			for (Node& node : nodes) node.x -= left;
+		}
+
+		static std::string coordinate(double value)
+		{
+			return std::to_string(static_cast<long long>(std::llround(value)));
+		}
+
+		/*
+		* \brief store the top left corners in mxGeometry (created if missing) and the dummy centers as waypoints
+		*/
+		void write_back()
+		{
+			for (const Node& node : nodes)
+			{
+				if (node.cell == nullptr) continue;
+
+				DI::DiagramElement* geometry = const_cast<DI::DiagramElement*>(find_drawio_geometry(node.cell));
+				if (geometry == nullptr)
+				{
+					geometry = new DI::DiagramElement;
+					geometry->local_style->set("as", "geometry");
+					geometry->local_style->set("width", coordinate(node.width));
+					geometry->local_style->set("height", coordinate(node.height));
+					node.cell->add_owned_element(geometry);
+				}
+				geometry->local_style->set("x", coordinate(node.x - node.width / 2));
+				geometry->local_style->set("y", coordinate(node.y));
+			}
+
+			for (const Edge& edge : edges)
+			{
+				std::vector<Point>& waypoints = edge.arrow->waypoints;
+				waypoints.clear();
+				for (size_t dummy : edge.chain) waypoints.push_back(Point{ std::round(nodes.at(dummy).x), std::round(nodes.at(dummy).y) });
+
+				// the chain runs against reversed edges
+				if (edge.reversed) std::reverse(waypoints.begin(), waypoints.end());
+			}
+		}
+	};
+}
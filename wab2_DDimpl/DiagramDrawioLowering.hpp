@@ -0,0 +1,465 @@
+#pragma once
+#include "DiagramInterChangeDrawio.hpp"
+#include "DiagramGraphics.hpp"
+#include <cctype>
+#include <optional>
+#include <unordered_map>
+
+/*
+* Lowering of a parsed drawio tree (DI) into a renderable canvas (DG)
+* -> vertices become Rectangle/Polygon/Path depending on their drawio_style, labels become Text
+* -> arrows become PolyLines from border to border, arrowheads are shared Markers
+* -> drawio style values are translated into DG::Styles. Equal styles are stored once in Canvas::package_styles
+* Everything is done in one pass over the tree
+*/
+namespace drawio
+{
+	namespace detail
+	{
+		/*
+		* \brief "#rgb", "#rrggbb" -> Color. Empty for "none" or unparseable values
+		*/
+		inline std::optional<Color> parse_color(const std::string& val)
+		{
+			auto hex = [](char c) -> int
+			{
+				if (c >= '0' && c <= '9') return c - '0';
+				if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+				if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+				return -1;
+			};
+
+			if (val.size() == 7 && val.front() == '#')
+			{
+				int channels[3];
+				for (int i = 0; i < 3; i++)
+				{
+					const int high = hex(val[1 + i * 2]), low = hex(val[2 + i * 2]);
+					if (high < 0 || low < 0) return {};
+					channels[i] = high * 16 + low;
+				}
+				return Color(channels[0], channels[1], channels[2]);
+			}
+			if (val.size() == 4 && val.front() == '#')
+			{
+				int channels[3];
+				for (int i = 0; i < 3; i++)
+				{
+					const int digit = hex(val[1 + i]);
+					if (digit < 0) return {};
+					channels[i] = digit * 17;
+				}
+				return Color(channels[0], channels[1], channels[2]);
+			}
+			if (val == "white") return KnownColor::white;
+			if (val == "black") return KnownColor::black;
+
+			return {};
+		}
+
+		inline const std::string* find_value(const std::unordered_map<std::string, std::string>& style, const std::string& key)
+		{
+			auto it = style.find(key);
+			return it != style.end() ? &it->second : nullptr;
+		}
+
+		inline double number_or(const std::unordered_map<std::string, std::string>& style, const std::string& key, double fallback)
+		{
+			const std::string* val = find_value(style, key);
+			if (val == nullptr) return fallback;
+
+			try
+			{
+				return std::stod(*val);
+			}
+			catch (const std::exception&)
+			{
+				return fallback;
+			}
+		}
+
+		/*
+		* \brief plain text of an html label (html=1): <br> and block ends become line breaks, other tags are dropped
+		*/
+		inline std::string html_to_text(const std::string& html)
+		{
+			static const std::pair<const char*, const char*> entities[] = { { "&amp;", "&" }, { "&lt;", "<" }, { "&gt;", ">" }, { "&quot;", "\"" }, { "&nbsp;", " " }, { "&#39;", "'" } };
+
+			std::string out;
+			out.reserve(html.size());
+
+			for (size_t i = 0; i < html.size();)
+			{
+				if (html[i] == '<')
+				{
+					const size_t close = html.find('>', i);
+					if (close == std::string::npos) break;
+
+					// element name without '/' and attributes
+					const size_t begin = html[i + 1] == '/' ? i + 2 : i + 1;
+					std::string name = html.substr(begin, std::min(html.find_first_of(" />", begin), close) - begin);
+					for (char& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+					// blocks start on a new line, every <br> adds one
+					if (name == "br") out += '\n';
+					else if ((name == "div" || name == "p") && !out.empty() && out.back() != '\n') out += '\n';
+
+					i = close + 1;
+					continue;
+				}
+
+				if (html[i] == '&')
+				{
+					bool decoded = false;
+					for (const auto& entity : entities)
+					{
+						const size_t length = std::char_traits<char>::length(entity.first);
+						if (html.compare(i, length, entity.first) == 0)
+						{
+							out += entity.second;
+							i += length;
+							decoded = true;
+							break;
+						}
+					}
+					if (decoded) continue;
+				}
+
+				out += html[i++];
+			}
+
+			while (!out.empty() && out.back() == '\n') out.pop_back();
+			return out;
+		}
+
+		inline Point center_of(const Bounds& b)
+		{
+			return Point{ b.pos.x + b.dim.width / 2, b.pos.y + b.dim.height / 2 };
+		}
+
+		/*
+		* \brief point where the segment from inside (center of b) to outside leaves b
+		*/
+		inline Point clip_to_border(const Bounds& b, const Point& inside, const Point& outside)
+		{
+			const double dx = outside.x - inside.x, dy = outside.y - inside.y;
+			double t = 1;
+
+			if (dx > 0) t = std::min(t, (b.pos.x + b.dim.width - inside.x) / dx);
+			if (dx < 0) t = std::min(t, (b.pos.x - inside.x) / dx);
+			if (dy > 0) t = std::min(t, (b.pos.y + b.dim.height - inside.y) / dy);
+			if (dy < 0) t = std::min(t, (b.pos.y - inside.y) / dy);
+
+			t = std::max(t, 0.0);
+			return Point{ inside.x + dx * t, inside.y + dy * t };
+		}
+	}
+
+	/*
+	* \brief Converts a drawio DI tree into DG elements. The created elements are owned by the target canvas
+	*/
+	class DrawioLowering
+	{
+	public:
+		// drawio defaults
+		static constexpr double DEFAULT_FONT_SIZE = 11;
+		static constexpr double DEFAULT_ROUNDING = 15; // percent of min(width, height)
+		static constexpr double ARROW_SIZE = 10;
+
+		/*
+		* \brief append the graphical representation of all cells below root to canvas
+		*/
+		void lower(const DI::DiagramElement* root, DG::Canvas& canvas)
+		{
+			target = &canvas;
+			style_index.clear();
+			arrow_markers.clear();
+			bounds_of.clear();
+
+			// in drawio later cells are drawn above earlier ones
+			std::vector<DG::abstracts::GraphicalElement*> draw_order;
+			visit(root, Point(), draw_order);
+
+			// edges are resolved against the absolute bounds collected during the visit
+			for (const DrawioArrow* arrow : arrows) lower_arrow(arrow, draw_order);
+			arrows.clear();
+
+			// DG draws earlier members above later ones
+			for (auto it = draw_order.rbegin(); it != draw_order.rend(); it++) canvas.add_member(*it);
+		}
+
+		/*
+		* \brief absolute bounds of a lowered vertex
+		*/
+		const Bounds* absolute_bounds(const DI::DiagramElement* cell) const
+		{
+			auto it = bounds_of.find(cell);
+			return it != bounds_of.end() ? &it->second : nullptr;
+		}
+
+	private:
+		DG::Canvas* target = nullptr;
+
+		// style -> shared copy in Canvas::package_styles
+		std::unordered_map<DG::Style, DG::Style*> style_index;
+
+		// arrowheads by color
+		std::unordered_map<Color, DG::Marker*> arrow_markers;
+
+		std::unordered_map<const DI::DiagramElement*, Bounds> bounds_of;
+		std::vector<const DrawioArrow*> arrows;
+
+		template<typename T>
+		T* make()
+		{
+			return target->create<T>();
+		}
+
+		/*
+		* \brief use the shared copy of style, creating it if needed
+		*/
+		void share_style(DG::abstracts::GraphicalElement* element, const DG::Style& style)
+		{
+			auto it = style_index.find(style);
+			if (it == style_index.end())
+			{
+				target->package_styles.push_back(style);
+				it = style_index.insert({ style, &target->package_styles.back() }).first;
+			}
+			element->s_shared.push_back(it->second);
+		}
+
+		void visit(const DI::DiagramElement* node, const Point& offset, std::vector<DG::abstracts::GraphicalElement*>& draw_order)
+		{
+			Point child_offset = offset;
+
+			if (const DrawioMxcell* cell = dynamic_cast<const DrawioMxcell*>(node))
+			{
+				Bounds bounds;
+				const std::string* vertex = detail::find_value(cell->local_style->properties, "vertex");
+
+				if (vertex != nullptr && *vertex == "1" && get_drawio_bounds(cell, bounds))
+				{
+					bounds.pos.x += offset.x;
+					bounds.pos.y += offset.y;
+					bounds_of.insert({ cell, bounds });
+
+					lower_vertex(cell, bounds, draw_order);
+
+					// children of a vertex are positioned relative to it
+					child_offset = bounds.pos;
+				}
+			}
+			else if (const DrawioArrow* arrow = dynamic_cast<const DrawioArrow*>(node))
+			{
+				arrows.push_back(arrow);
+			}
+
+			for (const DI::DiagramElement* child : node->owned_elements) visit(child, child_offset, draw_order);
+		}
+
+		void lower_vertex(const DrawioMxcell* cell, const Bounds& b, std::vector<DG::abstracts::GraphicalElement*>& draw_order)
+		{
+			const auto& style = cell->drawio_style;
+			DG::abstracts::GraphicalElement* shape = nullptr;
+
+			if (style.count("ellipse") != 0)
+			{
+				// two half ellipses
+				DG::Path* path = make<DG::Path>();
+				const Point c = detail::center_of(b);
+				const Dimension radii{ b.dim.width / 2, b.dim.height / 2 };
+
+				DG::MoveTo move;
+				move.point = Point{ b.pos.x, c.y };
+				path->commands.reserve(4);
+				path->commands.push_back(move);
+
+				for (double x : { b.pos.x + b.dim.width, b.pos.x })
+				{
+					DG::EllipticalArcTo arc;
+					arc.point = Point{ x, c.y };
+					arc.radii = radii;
+					arc.sweep = true;
+					path->commands.push_back(arc);
+				}
+				path->commands.push_back(DG::ClosePath());
+				shape = path;
+			}
+			else if (style.count("rhombus") != 0)
+			{
+				DG::Polygon* polygon = make<DG::Polygon>();
+				const Point c = detail::center_of(b);
+				polygon->points = { { c.x, b.pos.y }, { b.pos.x + b.dim.width, c.y }, { c.x, b.pos.y + b.dim.height }, { b.pos.x, c.y } };
+				shape = polygon;
+			}
+			else if (style.count("triangle") != 0)
+			{
+				DG::Polygon* polygon = make<DG::Polygon>();
+				const double x0 = b.pos.x, y0 = b.pos.y, x1 = b.pos.x + b.dim.width, y1 = b.pos.y + b.dim.height;
+				const Point c = detail::center_of(b);
+
+				const std::string* direction = detail::find_value(style, "direction");
+				if (direction != nullptr && *direction == "south") polygon->points = { { x0, y0 }, { x1, y0 }, { c.x, y1 } };
+				else if (direction != nullptr && *direction == "north") polygon->points = { { x0, y1 }, { c.x, y0 }, { x1, y1 } };
+				else if (direction != nullptr && *direction == "west") polygon->points = { { x1, y0 }, { x1, y1 }, { x0, c.y } };
+				else polygon->points = { { x0, y0 }, { x1, c.y }, { x0, y1 } };
+
+				shape = polygon;
+			}
+			else
+			{
+				DG::Rectangle* rect = make<DG::Rectangle>();
+				rect->bounds = b;
+
+				const std::string* rounded = detail::find_value(style, "rounded");
+				if (rounded != nullptr && *rounded == "1")
+				{
+					rect->corner_radius = std::min(b.dim.width, b.dim.height) * detail::number_or(style, "arcSize", DEFAULT_ROUNDING) / 100;
+				}
+				shape = rect;
+			}
+
+			// shape style, drawio fills vertices white and strokes them black by default
+			DG::Style shape_style;
+
+			const std::string* fill = detail::find_value(style, "fillColor");
+			const std::optional<Color> fill_color = detail::parse_color(fill != nullptr ? *fill : "#ffffff");
+			if (fill_color.has_value()) shape_style.set_fill_color(fill_color.value());
+
+			add_stroke_style(style, shape_style);
+
+			const double opacity = detail::number_or(style, "opacity", 100) / 100;
+			if (opacity < 1)
+			{
+				shape_style.set_fill_opacity(opacity);
+				shape_style.set_stroke_opacity(opacity);
+			}
+
+			share_style(shape, shape_style);
+			draw_order.push_back(shape);
+
+			// label
+			const std::string* label = detail::find_value(cell->local_style->properties, "value");
+			if (label != nullptr && !label->empty())
+			{
+				const std::string* html = detail::find_value(style, "html");
+				const std::string* white_space = detail::find_value(style, "whiteSpace");
+
+				DG::Text* text = make<DG::Text>();
+				text->data = html != nullptr && *html == "1" ? detail::html_to_text(*label) : *label;
+				text->bounds = b;
+				text->wrap = white_space != nullptr && *white_space == "wrap";
+
+				const std::string* align = detail::find_value(style, "align");
+				if (align != nullptr && *align == "left") text->alignment = AlignmentKind::start;
+				else if (align != nullptr && *align == "right") text->alignment = AlignmentKind::end;
+				else text->alignment = AlignmentKind::center;
+
+				lower_text_style(style, text);
+				draw_order.push_back(text);
+			}
+		}
+
+		void add_stroke_style(const std::unordered_map<std::string, std::string>& style, DG::Style& out)
+		{
+			const std::string* stroke = detail::find_value(style, "strokeColor");
+			const std::optional<Color> stroke_color = detail::parse_color(stroke != nullptr ? *stroke : "#000000");
+			const double width = detail::number_or(style, "strokeWidth", 1);
+
+			if (!stroke_color.has_value()) return;
+
+			out.set_stroke_color(stroke_color.value());
+			out.set_stroke_width(width);
+
+			const std::string* dashed = detail::find_value(style, "dashed");
+			if (dashed != nullptr && *dashed == "1")
+			{
+				out.set_stroke_dash_length({ 3 * width, 3 * width });
+			}
+		}
+
+		void lower_text_style(const std::unordered_map<std::string, std::string>& style, DG::Text* text)
+		{
+			DG::Style text_style;
+
+			const std::string* font_color = detail::find_value(style, "fontColor");
+			const Color color = detail::parse_color(font_color != nullptr ? *font_color : "#000000").value_or(KnownColor::black);
+			const double size = detail::number_or(style, "fontSize", DEFAULT_FONT_SIZE);
+			const std::string* family = detail::find_value(style, "fontFamily");
+			const int font_style = static_cast<int>(detail::number_or(style, "fontStyle", 0));
+
+			text_style.set_font_color(color);
+			text_style.set_font_size(size);
+			text_style.set_font_name(family != nullptr ? *family : "Helvetica");
+			// drawio fontStyle is a bitmask
+			text_style.set_font_bold((font_style & 1) != 0);
+			text_style.set_font_italic((font_style & 2) != 0);
+			text_style.set_font_underline((font_style & 4) != 0);
+			text_style.set_font_strike_through((font_style & 8) != 0);
+
+			share_style(text, text_style);
+		}
+
+		/*
+		* \brief shared arrowhead for the given color, pointing along +x with its tip at reference
+		*/
+		DG::Marker* arrow_marker(const Color& color)
+		{
+			auto it = arrow_markers.find(color);
+			if (it != arrow_markers.end()) return it->second;
+
+			DG::Marker* marker = make<DG::Marker>();
+			marker->size = Dimension{ ARROW_SIZE, ARROW_SIZE };
+			marker->reference = Point{ ARROW_SIZE, ARROW_SIZE / 2 };
+			marker->owner = target;
+
+			DG::Polygon* head = make<DG::Polygon>();
+			head->points = { { 0, 0 }, { ARROW_SIZE, ARROW_SIZE / 2 }, { 0, ARROW_SIZE } };
+
+			DG::Style head_style;
+			head_style.set_fill_color(color);
+			head_style.set_stroke_color(color);
+			head_style.set_stroke_width(1);
+			share_style(head, head_style);
+
+			marker->add_member(head);
+			arrow_markers.insert({ color, marker });
+			return marker;
+		}
+
+		void lower_arrow(const DrawioArrow* arrow, std::vector<DG::abstracts::GraphicalElement*>& draw_order)
+		{
+			const Bounds* source = arrow->source != nullptr ? absolute_bounds(arrow->source) : nullptr;
+			const Bounds* target_bounds = arrow->target != nullptr ? absolute_bounds(arrow->target) : nullptr;
+
+			// edges need two placed endpoints
+			if (source == nullptr || target_bounds == nullptr || source == target_bounds) return;
+
+			DG::PolyLine* line = make<DG::PolyLine>();
+
+			const Point source_center = detail::center_of(*source);
+			const Point target_center = detail::center_of(*target_bounds);
+
+			const Point first_hop = arrow->waypoints.empty() ? target_center : arrow->waypoints.front();
+			const Point last_hop = arrow->waypoints.empty() ? source_center : arrow->waypoints.back();
+
+			line->points.push_back(detail::clip_to_border(*source, source_center, first_hop));
+			line->points.insert(line->points.end(), arrow->waypoints.begin(), arrow->waypoints.end());
+			line->points.push_back(detail::clip_to_border(*target_bounds, target_center, last_hop));
+
+			const auto& style = arrow->drawio_style;
+			DG::Style line_style;
+			add_stroke_style(style, line_style);
+			share_style(line, line_style);
+
+			const std::string* end_arrow = detail::find_value(style, "endArrow");
+			if (line_style.has(DG::Style::Key::strokeColor) && (end_arrow == nullptr || *end_arrow != "none"))
+			{
+				line->end = arrow_marker(line_style.stroke_color());
+			}
+
+			draw_order.push_back(line);
+		}
+	};
+}
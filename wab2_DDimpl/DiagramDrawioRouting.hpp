@@ -0,0 +1,714 @@
+#pragma once
+#include "DiagramInterChangeDrawio.hpp"
+#include "DiagramThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Orthogonal routing of drawio edges (edgeStyle=orthogonalEdgeStyle)
+* -> vertices are the obstacles, their absolute bounds are kept in a uniform grid (ObstacleIndex)
+* -> every edge searches the Hanan grid (lines along the obstacle borders) around its endpoints with A*, bends cost extra
+* -> the corners are written into DI::Edge::waypoints in absolute coordinates, DrawioLowering connects them border to border
+* -> routes are kept in a second grid, after vertices moved only their incident edges and the routes they now block are routed again
+* Edges don't avoid each other, so all of them are routed in parallel
+*/
+namespace drawio
+{
+	/*
+	* \brief uniform grid over boxes, finds the boxes which may intersect a query box
+	*/
+	class ObstacleIndex
+	{
+	public:
+		/*
+		* \brief remove everything, cell should be about twice the size of a typical box
+		*/
+		void reset(double cell)
+		{
+			cell_size = cell > 0 ? cell : 1;
+			cells.clear();
+		}
+
+		void insert(size_t id, const BoundingBox& box)
+		{
+			for_cells(box, [&](uint64_t key) { cells[key].push_back(id); });
+		}
+
+		/*
+		* \brief box must be the one id was inserted with
+		*/
+		void remove(size_t id, const BoundingBox& box)
+		{
+			for_cells(box, [&](uint64_t key)
+			{
+				auto it = cells.find(key);
+				if (it == cells.end()) return;
+
+				std::vector<size_t>& ids = it->second;
+				ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+				if (ids.empty()) cells.erase(it);
+			});
+		}
+
+		/*
+		* \brief ids of the boxes sharing a cell with box, every id once
+		*/
+		void query(const BoundingBox& box, std::vector<size_t>& out) const
+		{
+			out.clear();
+			if (box.empty()) return;
+
+			// boxes spanning more cells than are occupied are answered from the occupied ones
+			const double columns = std::floor(box.x1 / cell_size) - std::floor(box.x0 / cell_size) + 1;
+			const double rows = std::floor(box.y1 / cell_size) - std::floor(box.y0 / cell_size) + 1;
+			if (columns * rows > static_cast<double>(cells.size()))
+			{
+				const int64_t x0 = cell_of(box.x0), x1 = cell_of(box.x1), y0 = cell_of(box.y0), y1 = cell_of(box.y1);
+				for (const auto& cell : cells)
+				{
+					const int64_t x = static_cast<int32_t>(cell.first >> 32), y = static_cast<int32_t>(cell.first & 0xffffffffu);
+					if (x >= x0 && x <= x1 && y >= y0 && y <= y1) out.insert(out.end(), cell.second.begin(), cell.second.end());
+				}
+			}
+			else
+			{
+				for_cells(box, [&](uint64_t key)
+				{
+					auto it = cells.find(key);
+					if (it != cells.end()) out.insert(out.end(), it->second.begin(), it->second.end());
+				});
+			}
+
+			std::sort(out.begin(), out.end());
+			out.erase(std::unique(out.begin(), out.end()), out.end());
+		}
+
+	private:
+		double cell_size = 100;
+		std::unordered_map<uint64_t, std::vector<size_t>> cells;
+
+		int64_t cell_of(double v) const
+		{
+			// far away coordinates share the outermost cells
+			return static_cast<int64_t>(std::clamp(std::floor(v / cell_size), -2147483647.0, 2147483647.0));
+		}
+
+		static uint64_t key(int64_t x, int64_t y)
+		{
+			return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+		}
+
+		template<typename F>
+		void for_cells(const BoundingBox& box, F f) const
+		{
+			if (box.empty()) return;
+			for (int64_t y = cell_of(box.y0); y <= cell_of(box.y1); y++)
+			{
+				for (int64_t x = cell_of(box.x0); x <= cell_of(box.x1); x++) f(key(x, y));
+			}
+		}
+	};
+
+	/*
+	* \brief computes orthogonal waypoints for the edges of a drawio tree
+	*/
+	class EdgeRouter
+	{
+	public:
+		// distance kept to vertices
+		static constexpr double MARGIN = 10;
+
+		// a bend costs as much as this length, routes prefer few bends over short detours
+		static constexpr double BEND_PENALTY = 40;
+
+		// largest grid searched for one edge, larger searches give up and leave the edge straight
+		// A worker needs 49 bytes per node (flags, cost and predecessor per direction), about 25 MB at this limit
+		static constexpr size_t MAX_NODES = size_t(1) << 19;
+
+		// upper limit of threads of the shared pool, 0: all of them (one per hardware thread)
+		unsigned threads = 0;
+
+		/*
+		* \brief route every orthogonal edge below root
+		*/
+		void route(DI::DiagramElement* root)
+		{
+			index(root);
+			route_edges(edges);
+		}
+
+		/*
+		* \brief collect the vertices below root as obstacles and the edges with edgeStyle=orthogonalEdgeStyle
+		*/
+		void index(DI::DiagramElement* root)
+		{
+			obstacles.clear();
+			obstacle_of.clear();
+			edges.clear();
+			edge_of.clear();
+			pending.clear();
+
+			visit(root, Point());
+
+			// cells about twice the average vertex
+			double size = 0;
+			for (const Obstacle& o : obstacles) size += std::max(o.box.x1 - o.box.x0, o.box.y1 - o.box.y0);
+			typical_size = obstacles.empty() ? 50 : size / obstacles.size() + 2 * MARGIN;
+			grid.reset(2 * typical_size);
+
+			extent = BoundingBox();
+			for (size_t i = 0; i < obstacles.size(); i++)
+			{
+				grid.insert(i, obstacles.at(i).box);
+				extent.add(obstacles.at(i).box);
+			}
+
+			route_index.reset(2 * typical_size);
+			route_boxes.assign(edges.size(), {});
+			for (size_t i = 0; i < edges.size(); i++) edge_of.insert({ edges.at(i), i });
+		}
+
+		/*
+		* \brief route edges in parallel on ThreadPool::shared(), index must have been called before
+		*        Edges whose endpoints are no placed vertices are left unchanged, unroutable edges lose their waypoints
+		*/
+		void route_edges(const std::vector<DrawioArrow*>& todo)
+		{
+			// buffers per pool worker, kept for the next call
+			ThreadPool& pool = ThreadPool::shared();
+			if (searches.size() < pool.size()) searches.resize(pool.size());
+
+			pool.parallel_for(todo.size(), [&](size_t job, unsigned worker)
+			{
+				std::unique_ptr<Search>& search = searches[worker];
+				if (search == nullptr) search = std::make_unique<Search>();
+				route_edge(*todo.at(job), *search);
+			}, threads);
+
+			for (DrawioArrow* edge : todo) index_route(*edge);
+		}
+
+		/*
+		* \brief change notification: the geometry of cell changed. Handled by the next update call
+		*/
+		void moved(const DI::DiagramElement* cell)
+		{
+			pending.push_back(cell);
+		}
+
+		/*
+		* \brief take over the new positions of the moved cells and their children, then route the affected edges again:
+		*        edges incident to a moved vertex and edges whose route runs through its new place
+		*        Routes which only avoided the old place are kept. Returns the routed edges
+		*/
+		std::vector<DrawioArrow*> update()
+		{
+			std::vector<size_t> changed;
+			for (const DI::DiagramElement* cell : pending) relocate(cell, absolute_offset(cell), changed);
+			pending.clear();
+			return reroute(changed);
+		}
+
+		/*
+		* \brief like update, for edits without notification (e.g. BijectiveAlgorithm::sync_with): compares the geometry of all vertices below root
+		*        Vertices and edges added or removed since index need a new index call
+		*/
+		std::vector<DrawioArrow*> refresh(const DI::DiagramElement* root)
+		{
+			std::vector<size_t> changed;
+			relocate(root, Point(), changed);
+			pending.clear();
+			return reroute(changed);
+		}
+
+		/*
+		* \brief absolute bounds of a vertex, nullptr if cell is no placed vertex
+		*/
+		const Bounds* absolute_bounds(const DI::DiagramElement* cell) const
+		{
+			auto it = obstacle_of.find(cell);
+			return it != obstacle_of.end() ? &obstacles.at(it->second).bounds : nullptr;
+		}
+
+		/*
+		* \brief edges found by the last index call
+		*/
+		const std::vector<DrawioArrow*>& orthogonal_edges() const
+		{
+			return edges;
+		}
+
+	private:
+		struct Obstacle
+		{
+			const DI::DiagramElement* cell;
+			Bounds bounds;
+			BoundingBox box;
+		};
+
+		std::vector<Obstacle> obstacles;
+		std::unordered_map<const DI::DiagramElement*, size_t> obstacle_of;
+		ObstacleIndex grid;
+		BoundingBox extent;
+
+		// average vertex with margin
+		double typical_size = 50;
+
+		std::vector<DrawioArrow*> edges;
+		std::unordered_map<const DrawioArrow*, size_t> edge_of;
+
+		// segments of the current routes, source center to target center, per edge
+		ObstacleIndex route_index;
+		std::vector<std::vector<BoundingBox>> route_boxes;
+
+		// cells passed to moved, not handled yet
+		std::vector<const DI::DiagramElement*> pending;
+
+		// directions of grid moves: right, down, left, up
+		static constexpr int DX[4] = { 1, 0, -1, 0 };
+		static constexpr int DY[4] = { 0, 1, 0, -1 };
+
+		// node flags
+		static constexpr uint8_t BLOCKED = 1, NO_RIGHT = 2, NO_DOWN = 4;
+
+		/*
+		* \brief buffers of one worker, reused between edges
+		*/
+		struct Search
+		{
+			std::vector<double> xs, ys;
+			std::vector<uint8_t> flags;
+			std::vector<BoundingBox> blockers;
+			std::vector<size_t> candidates;
+
+			// per node and direction of arrival
+			std::vector<double> cost;
+			std::vector<uint32_t> previous;
+
+			// (estimated total cost, state), min heap
+			std::vector<std::pair<double, uint32_t>> open;
+
+			std::vector<Point> route;
+		};
+
+		// per worker of the shared pool
+		std::vector<std::unique_ptr<Search>> searches;
+
+		/*
+		* \brief grid position and direction the route leaves a source or enters a target
+		*/
+		struct Port
+		{
+			Point point;
+			int direction;
+			size_t node = 0;
+		};
+
+		/*
+		* \brief bounds of a vertex relative to its parent vertex. False for other cells
+		*/
+		static bool vertex_bounds(const DI::DiagramElement* node, Bounds& bounds)
+		{
+			const DrawioMxcell* cell = dynamic_cast<const DrawioMxcell*>(node);
+			if (cell == nullptr) return false;
+
+			const std::string* vertex = cell->local_style->find("vertex");
+			return vertex != nullptr && *vertex == "1" && get_drawio_bounds(cell, bounds);
+		}
+
+		/*
+		* \brief absolute position of the parent vertex of node, children of a vertex are positioned relative to it
+		*/
+		static Point absolute_offset(const DI::DiagramElement* node)
+		{
+			Point offset;
+			for (const DI::DiagramElement* parent = node->owning_element; parent != nullptr; parent = parent->owning_element)
+			{
+				Bounds bounds;
+				if (!vertex_bounds(parent, bounds)) continue;
+				offset.x += bounds.pos.x;
+				offset.y += bounds.pos.y;
+			}
+			return offset;
+		}
+
+		void visit(DI::DiagramElement* node, const Point& offset)
+		{
+			Point child_offset = offset;
+
+			if (const DrawioMxcell* cell = dynamic_cast<const DrawioMxcell*>(node))
+			{
+				Bounds bounds;
+				if (vertex_bounds(cell, bounds))
+				{
+					bounds.pos.x += offset.x;
+					bounds.pos.y += offset.y;
+					obstacle_of.insert({ cell, obstacles.size() });
+					obstacles.push_back(Obstacle{ cell, bounds, BoundingBox::from(bounds) });
+
+					// children of a vertex are positioned relative to it
+					child_offset = bounds.pos;
+				}
+			}
+			else if (DrawioArrow* arrow = dynamic_cast<DrawioArrow*>(node))
+			{
+				// styles are memoized and must not be resolved by the workers
+				const std::string* edge_style = arrow->resolve_style("edgeStyle");
+				if (edge_style != nullptr && *edge_style == "orthogonalEdgeStyle") edges.push_back(arrow);
+			}
+
+			for (DI::DiagramElement* child : node->owned_elements) visit(child, child_offset);
+		}
+
+		/*
+		* \brief like visit, updates the vertices below node whose bounds changed and appends their ids to changed
+		*/
+		void relocate(const DI::DiagramElement* node, const Point& offset, std::vector<size_t>& changed)
+		{
+			Point child_offset = offset;
+
+			Bounds bounds;
+			if (vertex_bounds(node, bounds))
+			{
+				bounds.pos.x += offset.x;
+				bounds.pos.y += offset.y;
+				child_offset = bounds.pos;
+
+				auto it = obstacle_of.find(node);
+				if (it == obstacle_of.end())
+				{
+					// new vertices become obstacles, their edges are unknown until the next index call
+					obstacle_of.insert({ node, obstacles.size() });
+					obstacles.push_back(Obstacle{ node, bounds, BoundingBox::from(bounds) });
+					grid.insert(obstacles.size() - 1, obstacles.back().box);
+					extent.add(obstacles.back().box);
+				}
+				else
+				{
+					Obstacle& obstacle = obstacles.at(it->second);
+					const BoundingBox box = BoundingBox::from(bounds);
+					if (box != obstacle.box)
+					{
+						grid.remove(it->second, obstacle.box);
+						obstacle.bounds = bounds;
+						obstacle.box = box;
+						grid.insert(it->second, box);
+						extent.add(box);
+						changed.push_back(it->second);
+					}
+				}
+			}
+
+			for (const DI::DiagramElement* child : node->owned_elements) relocate(child, child_offset, changed);
+		}
+
+		/*
+		* \brief route the edges affected by the moved obstacles again
+		*/
+		std::vector<DrawioArrow*> reroute(const std::vector<size_t>& changed)
+		{
+			std::vector<bool> affected(edges.size(), false);
+			std::vector<size_t> candidates;
+
+			for (size_t id : changed)
+			{
+				const Obstacle& obstacle = obstacles.at(id);
+
+				// the adjacency index of the DI tree knows the edges of the vertex
+				for (const DI::Edge* edge : obstacle.cell->incident_edges)
+				{
+					auto it = edge_of.find(dynamic_cast<const DrawioArrow*>(edge));
+					if (it != edge_of.end()) affected.at(it->second) = true;
+				}
+
+				// routes running through the new place
+				BoundingBox blocker = obstacle.box;
+				blocker.inflate(MARGIN);
+				route_index.query(blocker, candidates);
+				for (size_t candidate : candidates)
+				{
+					if (affected.at(candidate)) continue;
+					for (const BoundingBox& segment : route_boxes.at(candidate))
+					{
+						if (segment.x0 < blocker.x1 && segment.x1 > blocker.x0 && segment.y0 < blocker.y1 && segment.y1 > blocker.y0)
+						{
+							affected.at(candidate) = true;
+							break;
+						}
+					}
+				}
+			}
+
+			std::vector<DrawioArrow*> todo;
+			for (size_t i = 0; i < edges.size(); i++)
+			{
+				if (affected.at(i)) todo.push_back(edges.at(i));
+			}
+			route_edges(todo);
+			return todo;
+		}
+
+		/*
+		* \brief replace the segments of edge in route_index
+		*/
+		void index_route(const DrawioArrow& edge)
+		{
+			auto id = edge_of.find(&edge);
+			if (id == edge_of.end()) return;
+
+			std::vector<BoundingBox>& boxes = route_boxes.at(id->second);
+			for (const BoundingBox& box : boxes) route_index.remove(id->second, box);
+			boxes.clear();
+
+			const Bounds* source = absolute_bounds(edge.source);
+			const Bounds* target = absolute_bounds(edge.target);
+			if (source == nullptr || target == nullptr) return;
+
+			Point previous{ source->pos.x + source->dim.width / 2, source->pos.y + source->dim.height / 2 };
+			auto add = [&](const Point& p)
+			{
+				BoundingBox box;
+				box.add(previous);
+				box.add(p);
+				boxes.push_back(box);
+				route_index.insert(id->second, box);
+				previous = p;
+			};
+			for (const Point& p : edge.waypoints) add(p);
+			add(Point{ target->pos.x + target->dim.width / 2, target->pos.y + target->dim.height / 2 });
+		}
+
+		void route_edge(DrawioArrow& edge, Search& search) const
+		{
+			auto source = obstacle_of.find(edge.source), target = obstacle_of.find(edge.target);
+			if (source == obstacle_of.end() || target == obstacle_of.end() || source->second == target->second) return;
+
+			const BoundingBox& s = obstacles.at(source->second).box;
+			const BoundingBox& t = obstacles.at(target->second).box;
+
+			BoundingBox ends = s;
+			ends.add(t);
+
+			BoundingBox whole = extent;
+			whole.add(ends);
+			whole.inflate(2 * MARGIN);
+
+			// start close to the endpoints and widen the search area until a route exists
+			double padding = typical_size;
+			for (;;)
+			{
+				BoundingBox region = ends;
+				region.inflate(padding);
+				region = region.intersection(whole);
+
+				if (search_region(s, t, source->second, target->second, region, search))
+				{
+					edge.waypoints = search.route;
+					return;
+				}
+				if (region.contains(whole)) break;
+				padding *= 4;
+			}
+			edge.waypoints.clear();
+		}
+
+		/*
+		* \brief A* from the sides of s to the sides of t, restricted to region. The waypoints are left in search.route
+		*/
+		bool search_region(const BoundingBox& s, const BoundingBox& t, size_t source, size_t target, const BoundingBox& region, Search& search) const
+		{
+			BoundingBox s_margin = s, t_margin = t;
+			s_margin.inflate(MARGIN);
+			t_margin.inflate(MARGIN);
+
+			const Point sc{ (s.x0 + s.x1) / 2, (s.y0 + s.y1) / 2 }, tc{ (t.x0 + t.x1) / 2, (t.y0 + t.y1) / 2 };
+
+			// the endpoints are obstacles too, routes leave and enter them through the middle of a side
+			search.blockers.clear();
+			search.blockers.push_back(s_margin);
+			search.blockers.push_back(t_margin);
+
+			grid.query(region, search.candidates);
+			for (size_t id : search.candidates)
+			{
+				if (id == source || id == target) continue;
+
+				// containers of the endpoints can't be avoided
+				const BoundingBox& box = obstacles.at(id).box;
+				if (box.contains(s) || box.contains(t)) continue;
+
+				BoundingBox blocker = box;
+				blocker.inflate(MARGIN);
+				if (blocker.intersects(region)) search.blockers.push_back(blocker);
+			}
+
+			// Hanan grid: every border of an obstacle inside region and the lines through the endpoint centers
+			std::vector<double>& xs = search.xs;
+			std::vector<double>& ys = search.ys;
+			xs = { region.x0, region.x1, sc.x, tc.x };
+			ys = { region.y0, region.y1, sc.y, tc.y };
+			for (const BoundingBox& b : search.blockers)
+			{
+				for (double x : { b.x0, b.x1 }) if (x > region.x0 && x < region.x1) xs.push_back(x);
+				for (double y : { b.y0, b.y1 }) if (y > region.y0 && y < region.y1) ys.push_back(y);
+			}
+			std::sort(xs.begin(), xs.end());
+			xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+			std::sort(ys.begin(), ys.end());
+			ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+			const size_t nx = xs.size(), ny = ys.size(), nodes = nx * ny;
+			if (nodes > MAX_NODES) return false;
+
+			// nodes strictly inside a blocker and grid segments running through one are unusable
+			search.flags.assign(nodes, 0);
+			for (const BoundingBox& b : search.blockers)
+			{
+				const size_t i0 = std::upper_bound(xs.begin(), xs.end(), b.x0) - xs.begin(), i1 = std::lower_bound(xs.begin(), xs.end(), b.x1) - xs.begin();
+				const size_t j0 = std::upper_bound(ys.begin(), ys.end(), b.y0) - ys.begin(), j1 = std::lower_bound(ys.begin(), ys.end(), b.y1) - ys.begin();
+
+				// segments from the first grid line at or after the border to the last one before the opposite border
+				const size_t si0 = std::lower_bound(xs.begin(), xs.end(), b.x0) - xs.begin(), si1 = std::upper_bound(xs.begin(), xs.end(), b.x1) - xs.begin();
+				const size_t sj0 = std::lower_bound(ys.begin(), ys.end(), b.y0) - ys.begin(), sj1 = std::upper_bound(ys.begin(), ys.end(), b.y1) - ys.begin();
+
+				for (size_t j = j0; j < j1; j++)
+				{
+					for (size_t i = i0; i < i1; i++) search.flags[j * nx + i] |= BLOCKED;
+					for (size_t i = si0; i + 1 < si1; i++) search.flags[j * nx + i] |= NO_RIGHT;
+				}
+				for (size_t i = i0; i < i1; i++)
+				{
+					for (size_t j = sj0; j + 1 < sj1; j++) search.flags[j * nx + i] |= NO_DOWN;
+				}
+			}
+
+			auto node_at = [&](const Point& p)
+			{
+				const size_t i = std::lower_bound(xs.begin(), xs.end(), p.x) - xs.begin(), j = std::lower_bound(ys.begin(), ys.end(), p.y) - ys.begin();
+				return j * nx + i;
+			};
+
+			// sources leave outwards, targets are entered inwards
+			Port starts[4] = {
+				{ Point{ s_margin.x1, sc.y }, 0 }, { Point{ sc.x, s_margin.y1 }, 1 }, { Point{ s_margin.x0, sc.y }, 2 }, { Point{ sc.x, s_margin.y0 }, 3 } };
+			Port goals[4] = {
+				{ Point{ t_margin.x0, tc.y }, 0 }, { Point{ tc.x, t_margin.y0 }, 1 }, { Point{ t_margin.x1, tc.y }, 2 }, { Point{ tc.x, t_margin.y1 }, 3 } };
+
+			for (Port& port : starts) port.node = node_at(port.point);
+			for (Port& port : goals) port.node = node_at(port.point);
+
+			auto heuristic = [&](size_t node)
+			{
+				const double x = xs[node % nx], y = ys[node / nx];
+				double h = std::numeric_limits<double>::infinity();
+				for (const Port& goal : goals) h = std::min(h, std::abs(goal.point.x - x) + std::abs(goal.point.y - y));
+				return h;
+			};
+
+			search.cost.assign(nodes * 4, std::numeric_limits<double>::infinity());
+			search.previous.assign(nodes * 4, UINT32_MAX);
+			search.open.clear();
+
+			auto greater = [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) { return a.first > b.first; };
+			auto push = [&](uint32_t state, double cost, uint32_t previous)
+			{
+				search.cost[state] = cost;
+				search.previous[state] = previous;
+				search.open.push_back({ cost + heuristic(state / 4), state });
+				std::push_heap(search.open.begin(), search.open.end(), greater);
+			};
+
+			for (const Port& start : starts)
+			{
+				if (region.contains(start.point) && !(search.flags[start.node] & BLOCKED)) push(static_cast<uint32_t>(start.node * 4 + start.direction), 0, UINT32_MAX);
+			}
+
+			double best = std::numeric_limits<double>::infinity();
+			uint32_t best_state = UINT32_MAX;
+
+			while (!search.open.empty())
+			{
+				std::pop_heap(search.open.begin(), search.open.end(), greater);
+				const auto [estimate, state] = search.open.back();
+				search.open.pop_back();
+
+				if (estimate >= best) break;
+
+				const size_t node = state / 4;
+				const int direction = state % 4;
+				const double cost = search.cost[state];
+
+				// stale heap entry
+				if (estimate > cost + heuristic(node)) continue;
+
+				for (const Port& goal : goals)
+				{
+					if (goal.node != node) continue;
+
+					const double total = cost + (goal.direction != direction ? BEND_PENALTY : 0);
+					if (total < best)
+					{
+						best = total;
+						best_state = state;
+					}
+				}
+
+				const size_t i = node % nx, j = node / nx;
+				for (int d = 0; d < 4; d++)
+				{
+					// no turning back
+					if (d == (direction + 2) % 4) continue;
+
+					const long long ni = static_cast<long long>(i) + DX[d], nj = static_cast<long long>(j) + DY[d];
+					if (ni < 0 || nj < 0 || ni >= static_cast<long long>(nx) || nj >= static_cast<long long>(ny)) continue;
+
+					const size_t neighbor = static_cast<size_t>(nj) * nx + static_cast<size_t>(ni);
+					if (search.flags[neighbor] & BLOCKED) continue;
+
+					const bool blocked_segment =
+						d == 0 ? (search.flags[node] & NO_RIGHT) != 0 :
+						d == 2 ? (search.flags[neighbor] & NO_RIGHT) != 0 :
+						d == 1 ? (search.flags[node] & NO_DOWN) != 0 :
+						(search.flags[neighbor] & NO_DOWN) != 0;
+					if (blocked_segment) continue;
+
+					const double next_cost = cost + std::abs(xs[ni] - xs[i]) + std::abs(ys[nj] - ys[j]) + (d != direction ? BEND_PENALTY : 0);
+					const uint32_t next_state = static_cast<uint32_t>(neighbor * 4 + d);
+					if (next_cost < search.cost[next_state]) push(next_state, next_cost, state);
+				}
+			}
+
+			if (best_state == UINT32_MAX) return false;
+
+			// nodes of the route from target to source, then only the corners are kept
+			std::vector<Point>& route = search.route;
+			route.clear();
+			route.push_back(tc);
+			for (uint32_t state = best_state; state != UINT32_MAX; state = search.previous[state])
+			{
+				route.push_back(Point{ xs[state / 4 % nx], ys[state / 4 / nx] });
+			}
+			route.push_back(sc);
+			std::reverse(route.begin(), route.end());
+
+			size_t kept = 1;
+			for (size_t k = 1; k + 1 < route.size(); k++)
+			{
+				const Point& a = route[kept - 1];
+				const Point& b = route[k];
+				const Point& c = route[k + 1];
+				const bool straight = (a.x == b.x && b.x == c.x) || (a.y == b.y && b.y == c.y);
+				if (!straight) route[kept++] = b;
+			}
+
+			// the centers are not part of the waypoints
+			route.resize(kept);
+			route.erase(route.begin());
+			return true;
+		}
+	};
+}
@@ -1,6 +1,36 @@
 #pragma once
 #include "DiagramCommons.hpp"
 #include <vector>
+#include <string>
+#include <cmath>
+#include <variant>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/*
+* SIMD kernels are used if the compiler targets the instruction set (/arch:AVX, -mavx, x64 implies SSE2)
+*/
+#if defined(__AVX__)
+#define DG_SIMD_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DG_SIMD_SSE2
+#endif
+
+#if defined(DG_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(DG_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
 
 /*
 * needed forward declarations
@@ -10,10 +40,23 @@ namespace DG
 	namespace abstracts
 	{
 		struct GraphicalElement;
+		struct Fill;
 	}
 	struct Canvas;
 	struct Group;
 	struct ClipPath;
+
+	namespace detail
+	{
+		/*
+		* \brief unique, increasing revision. Unique across all elements and fills, so a recycled address never repeats a revision
+		*/
+		inline uint64_t next_revision()
+		{
+			static std::atomic<uint64_t> counter{ 0 };
+			return ++counter;
+		}
+	}
 }
 
 
@@ -22,37 +65,308 @@ namespace DG
 */
 namespace DG
 {
+	/*
+	* \brief process wide table of unique values, values are referenced by a 16 bit id
+	*        References returned by get stay valid for the lifetime of the program. Thread safe
+	*
+	* - intern locks, get is lock free: values live in fixed blocks which are never moved or changed,
+	*   a value is published by storing the new count with release semantics
+	*/
+	template<typename T>
+	class InternTable
+	{
+	public:
+		static InternTable& instance()
+		{
+			static InternTable table;
+			return table;
+		}
+
+		uint16_t intern(const T& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto it = ids.find(value);
+			if (it != ids.end()) return it->second;
+
+			const size_t id = count.load(std::memory_order_relaxed);
+			if (id > UINT16_MAX) throw std::length_error("InternTable is full");
+
+			std::unique_ptr<T[]>& block = blocks[id / BLOCK_SIZE];
+			if (block == nullptr) block.reset(new T[BLOCK_SIZE]);
+			block[id % BLOCK_SIZE] = value;
+			ids.insert({ value, static_cast<uint16_t>(id) });
+
+			count.store(id + 1, std::memory_order_release);
+			return static_cast<uint16_t>(id);
+		}
+
+		const T& get(uint16_t id) const
+		{
+			if (id >= count.load(std::memory_order_acquire)) throw std::out_of_range("InternTable: unknown id");
+			return blocks[id / BLOCK_SIZE][id % BLOCK_SIZE];
+		}
+
+	private:
+		static constexpr size_t BLOCK_SIZE = 256;
+
+		std::mutex mutex;
+		std::atomic<size_t> count{ 0 };
+		std::unique_ptr<T[]> blocks[(UINT16_MAX + 1) / BLOCK_SIZE];
+
+		// lookup for intern, guarded by mutex
+		std::map<T, uint16_t> ids;
+	};
+
 	/*
 	* \brief See 10.3.32 (V1.1)
+	*
+	* Packed layout: a presence bitmask, colors as 0xRRGGBB, floats for scalars and interned ids for font names and dash arrays.
+	* Unset properties must not be read, they hold zeros so styles can be compared and hashed member-wise
 	*/
 	struct Style
 	{
+		enum class Key : uint8_t
+		{
+			fill,
+			fillColor,
+			fillOpacity, // >= 0 && <= 1
+			strokeWidth, // >= 0
+			strokeOpacity,
+			strokeColor,
+			strokeDashLength, //size must be even
+			fontSize, // >= 0
+			fontName,
+			fontColor,
+			fontItalic,
+			fontBold,
+			fontUnderline,
+			fontStrikeThrough
+		};
+
+		bool has(Key key) const
+		{
+			return (present & bit(key)) != 0;
+		}
+
+		bool empty() const
+		{
+			return present == 0;
+		}
+
 		/*
-		* \brief Properties may be not set. In this case value must not be accessed
+		* \brief remove a property
 		*/
-		// TODO: make this std::optionals 
-		template <typename T>
-		struct Property
+		void unset(Key key)
 		{
-			bool set = false;
-			T value;
-		};
+			present &= ~bit(key);
+
+			switch (key)
+			{
+			case Key::fill: fill_ = nullptr; break;
+			case Key::fillColor: fill_color_ = 0; break;
+			case Key::fillOpacity: fill_opacity_ = 0; break;
+			case Key::strokeWidth: stroke_width_ = 0; break;
+			case Key::strokeOpacity: stroke_opacity_ = 0; break;
+			case Key::strokeColor: stroke_color_ = 0; break;
+			case Key::strokeDashLength: dash_id = 0; break;
+			case Key::fontSize: font_size_ = 0; break;
+			case Key::fontName: font_id = 0; break;
+			case Key::fontColor: font_color_ = 0; break;
+			default: font_flags &= ~font_bit(key); break;
+			}
+		}
+
+		// exclusive with fillColor, if both are set fill is used
+		abstracts::Fill* fill() const { return fill_; }
+		Color fill_color() const { return unpack(fill_color_); }
+		float fill_opacity() const { return fill_opacity_; }
+
+		float stroke_width() const { return stroke_width_; }
+		float stroke_opacity() const { return stroke_opacity_; }
+		Color stroke_color() const { return unpack(stroke_color_); }
+		const std::vector<double>& stroke_dash_length() const { return InternTable<std::vector<double>>::instance().get(dash_id); }
+
+		float font_size() const { return font_size_; }
+		const std::string& font_name() const { return InternTable<std::string>::instance().get(font_id); }
+		Color font_color() const { return unpack(font_color_); }
+		bool font_italic() const { return (font_flags & font_bit(Key::fontItalic)) != 0; }
+		bool font_bold() const { return (font_flags & font_bit(Key::fontBold)) != 0; }
+		bool font_underline() const { return (font_flags & font_bit(Key::fontUnderline)) != 0; }
+		bool font_strike_through() const { return (font_flags & font_bit(Key::fontStrikeThrough)) != 0; }
+
+		Style& set_fill(abstracts::Fill* value) { fill_ = value; return mark(Key::fill); }
+		Style& set_fill_color(const Color& value) { fill_color_ = pack(value); return mark(Key::fillColor); }
+		Style& set_fill_opacity(double value) { fill_opacity_ = static_cast<float>(value); return mark(Key::fillOpacity); }
+
+		Style& set_stroke_width(double value) { stroke_width_ = static_cast<float>(value); return mark(Key::strokeWidth); }
+		Style& set_stroke_opacity(double value) { stroke_opacity_ = static_cast<float>(value); return mark(Key::strokeOpacity); }
+		Style& set_stroke_color(const Color& value) { stroke_color_ = pack(value); return mark(Key::strokeColor); }
+		Style& set_stroke_dash_length(const std::vector<double>& value)
+		{
+			if (value.size() % 2 != 0) throw std::invalid_argument("strokeDashLength must contain an even number of lengths");
+			dash_id = InternTable<std::vector<double>>::instance().intern(value);
+			return mark(Key::strokeDashLength);
+		}
 
-		Property<Color> fillColor;
-		Property<double> fillOpacity; // >= 0 && <= 1
-		
-		Property<double> strokeWidth; // >= 0
-		Property<double> strokeOPacity;
-		Property<Color> strokeColor;
-		Property<std::vector<double>> strokeDashLength; //size must be even
-		
-		Property<double> fontSize; // >= 0
-		Property<std::string> fontName;
-		Property<Color> fontColor;
-		Property<bool> fontItalic;
-		Property<bool> fontBold;
-		Property<bool> fontUnderline;
-		Property<bool> fontStrikeThrough;
+		Style& set_font_size(double value) { font_size_ = static_cast<float>(value); return mark(Key::fontSize); }
+		Style& set_font_name(const std::string& value) { font_id = InternTable<std::string>::instance().intern(value); return mark(Key::fontName); }
+		Style& set_font_color(const Color& value) { font_color_ = pack(value); return mark(Key::fontColor); }
+		Style& set_font_italic(bool value) { return set_font_flag(Key::fontItalic, value); }
+		Style& set_font_bold(bool value) { return set_font_flag(Key::fontBold, value); }
+		Style& set_font_underline(bool value) { return set_font_flag(Key::fontUnderline, value); }
+		Style& set_font_strike_through(bool value) { return set_font_flag(Key::fontStrikeThrough, value); }
+
+		bool operator==(const Style& other) const
+		{
+			return present == other.present && font_flags == other.font_flags && font_id == other.font_id && dash_id == other.dash_id
+				&& fill_color_ == other.fill_color_ && stroke_color_ == other.stroke_color_ && font_color_ == other.font_color_
+				&& fill_opacity_ == other.fill_opacity_ && stroke_width_ == other.stroke_width_ && stroke_opacity_ == other.stroke_opacity_
+				&& font_size_ == other.font_size_ && fill_ == other.fill_;
+		}
+
+		bool operator!=(const Style& other) const
+		{
+			return !(*this == other);
+		}
+
+		size_t hash() const
+		{
+			// FNV-1a over the fields
+			uint64_t h = 14695981039346656037ull;
+			auto mix = [&h](uint64_t value)
+			{
+				h ^= value;
+				h *= 1099511628211ull;
+			};
+
+			mix(present | (static_cast<uint64_t>(font_flags) << 16) | (static_cast<uint64_t>(font_id) << 24) | (static_cast<uint64_t>(dash_id) << 40));
+			mix(fill_color_ | (static_cast<uint64_t>(stroke_color_) << 32));
+			mix(font_color_ | (static_cast<uint64_t>(float_bits(font_size_)) << 32));
+			mix(float_bits(fill_opacity_) | (static_cast<uint64_t>(float_bits(stroke_width_)) << 32));
+			mix(float_bits(stroke_opacity_));
+			mix(reinterpret_cast<uintptr_t>(fill_));
+			return static_cast<size_t>(h);
+		}
+
+	private:
+		uint16_t present = 0;
+		uint8_t font_flags = 0;
+
+		uint16_t font_id = 0, dash_id = 0;
+
+		uint32_t fill_color_ = 0, stroke_color_ = 0, font_color_ = 0;
+		float fill_opacity_ = 0, stroke_width_ = 0, stroke_opacity_ = 0, font_size_ = 0;
+
+		abstracts::Fill* fill_ = nullptr;
+
+		static uint16_t bit(Key key)
+		{
+			return static_cast<uint16_t>(1u << static_cast<unsigned>(key));
+		}
+
+		static uint8_t font_bit(Key key)
+		{
+			return static_cast<uint8_t>(1u << (static_cast<unsigned>(key) - static_cast<unsigned>(Key::fontItalic)));
+		}
+
+		static uint32_t pack(const Color& c)
+		{
+			return (static_cast<uint32_t>(c.red) << 16) | (static_cast<uint32_t>(c.green) << 8) | static_cast<uint32_t>(c.blue);
+		}
+
+		static Color unpack(uint32_t rgb)
+		{
+			return Color((rgb >> 16) & 0xff, (rgb >> 8) & 0xff, rgb & 0xff);
+		}
+
+		static uint32_t float_bits(float value)
+		{
+			// +0 and -0 compare equal and must hash equal
+			if (value == 0) return 0;
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		Style& mark(Key key)
+		{
+			present |= bit(key);
+			return *this;
+		}
+
+		Style& set_font_flag(Key key, bool value)
+		{
+			if (value) font_flags |= font_bit(key);
+			else font_flags &= ~font_bit(key);
+			return mark(key);
+		}
+	};
+
+	// styles are copied into every element and compared in the cascade, keep them within one cache line
+	static_assert(sizeof(Style) <= 64, "DG::Style must fit into a cache line");
+
+	// joins longer than STROKE_MITER_LIMIT * strokeWidth / 2 are beveled, svg default
+	constexpr double STROKE_MITER_LIMIT = 4;
+
+	/*
+	* \brief effective style of an element after the cascade (local styles, shared styles, owner chain) was applied
+	*        Unset properties hold the defaults. Pointers refer to interned values
+	*/
+	struct ResolvedStyle
+	{
+		// fill wins over fill_color, like in Style
+		abstracts::Fill* fill = nullptr;
+		Color fill_color = KnownColor::black;
+		double fill_opacity = 1;
+
+		Color stroke_color = KnownColor::black;
+		double stroke_width = 1;
+		double stroke_opacity = 1;
+		const std::vector<double>* dashes = nullptr;
+
+		Color font_color = KnownColor::black;
+		double font_size = 12;
+		const std::string* font_name = nullptr;
+
+		bool has_fill_color : 1;
+		bool has_stroke : 1;
+		bool italic : 1;
+		bool bold : 1;
+		bool underline : 1;
+		bool strike_through : 1;
+
+		ResolvedStyle()
+			: has_fill_color(false), has_stroke(false), italic(false), bold(false), underline(false), strike_through(false)
+		{}
+
+		bool has_fill() const
+		{
+			return fill != nullptr || has_fill_color;
+		}
+
+		/*
+		* \brief half the stroke width, 0 without stroke
+		*/
+		double stroke_extent() const
+		{
+			return has_stroke ? std::max(stroke_width, 0.0) / 2 : 0;
+		}
+	};
+}
+
+/*
+* allows Styles as keys in unordered containers
+*/
+namespace std
+{
+	template<>
+	struct hash<DG::Style>
+	{
+		size_t operator()(const DG::Style& style) const noexcept
+		{
+			return style.hash();
+		}
 	};
 }
 
@@ -74,7 +388,7 @@ namespace DG
 	namespace abstracts
 	{
 		/*
-		* Abstract Draw-Command
+		* Abstract Draw-Command. Commands are stored by value in a PathSegment
 		*/
 		struct PathCommand
 		{
@@ -112,72 +426,549 @@ namespace DG
 	*/
 	struct ClosePath : public abstracts::PathCommand {};
 
-	struct EllipticalArcTo
+	struct EllipticalArcTo : public abstracts::PathCommand
 	{
 		Point point;
 		Dimension radii;
-		double rotation;
-		bool large_arc;
-		bool sweep;
+		double rotation = 0;
+		bool large_arc = false;
+		bool sweep = false;
+	};
+
+	/*
+	* \brief one command of a Path. Paths store their commands contiguously, the active alternative is the command type
+	*/
+	using PathSegment = std::variant<MoveTo, LineTo, CubicCurveTo, QuadraticCurveTo, EllipticalArcTo, ClosePath>;
+
+	inline bool is_relative(const PathSegment& segment)
+	{
+		return std::visit([](const abstracts::PathCommand& command) { return command.relative; }, segment);
+	}
+
+	/*
+	* \brief center parameterization of an elliptical arc
+	*/
+	struct ArcCenter
+	{
+		Point center;
+		double rx = 0, ry = 0;
+
+		// rotation of the x-axis in radians
+		double phi = 0;
+		double start_angle = 0, sweep_angle = 0;
+
+		/*
+		* \brief point on the ellipse at the given parameter angle
+		*/
+		Point at(double angle) const
+		{
+			const double cos_phi = std::cos(phi), sin_phi = std::sin(phi);
+			const double x = rx * std::cos(angle), y = ry * std::sin(angle);
+			return Point{ center.x + cos_phi * x - sin_phi * y, center.y + sin_phi * x + cos_phi * y };
+		}
+
+		/*
+		* \brief derivative by angle, the direction of the arc at angle if sweep_angle > 0
+		*/
+		Point tangent(double angle) const
+		{
+			const double cos_phi = std::cos(phi), sin_phi = std::sin(phi);
+			const double x = -rx * std::sin(angle), y = ry * std::cos(angle);
+			return Point{ cos_phi * x - sin_phi * y, sin_phi * x + cos_phi * y };
+		}
+
+		/*
+		* \brief true if angle lies on the arc
+		*/
+		bool covers(double angle) const
+		{
+			constexpr double TAU = 2 * 3.14159265358979323846;
+			const double delta = sweep_angle >= 0 ? angle - start_angle : start_angle - angle;
+			return delta - TAU * std::floor(delta / TAU) <= std::abs(sweep_angle);
+		}
 	};
 
+	/*
+	* \brief endpoint to center conversion, see svg spec F.6.5 and F.6.6 (out-of-range radii)
+	*        Returns false if the arc degenerates into a line (zero radius or equal endpoints)
+	*/
+	inline bool arc_to_center(const Point& from, const EllipticalArcTo& arc, const Point& to, ArcCenter& out)
+	{
+		constexpr double PI = 3.14159265358979323846;
+
+		double rx = std::abs(arc.radii.width), ry = std::abs(arc.radii.height);
+		if (rx == 0 || ry == 0 || (from.x == to.x && from.y == to.y)) return false;
+
+		const double phi = arc.rotation * PI / 180;
+		const double cos_phi = std::cos(phi), sin_phi = std::sin(phi);
+
+		// step 1: (x1', y1')
+		const double hx = (from.x - to.x) / 2, hy = (from.y - to.y) / 2;
+		const double x1 = cos_phi * hx + sin_phi * hy;
+		const double y1 = -sin_phi * hx + cos_phi * hy;
+
+		// F.6.6: scale radii up if no ellipse fits
+		const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+		if (lambda > 1)
+		{
+			const double s = std::sqrt(lambda);
+			rx *= s;
+			ry *= s;
+		}
+
+		// step 2: (cx', cy')
+		const double rx2 = rx * rx, ry2 = ry * ry;
+		const double num = rx2 * ry2 - rx2 * y1 * y1 - ry2 * x1 * x1;
+		const double den = rx2 * y1 * y1 + ry2 * x1 * x1;
+		double coef = std::sqrt(std::max(0.0, num / den));
+		if (arc.large_arc == arc.sweep) coef = -coef;
+
+		const double cx1 = coef * rx * y1 / ry;
+		const double cy1 = -coef * ry * x1 / rx;
+
+		// step 3: (cx, cy)
+		out.center = Point{ cos_phi * cx1 - sin_phi * cy1 + (from.x + to.x) / 2, sin_phi * cx1 + cos_phi * cy1 + (from.y + to.y) / 2 };
+		out.rx = rx;
+		out.ry = ry;
+		out.phi = phi;
+
+		// step 4: angles
+		const double ux = (x1 - cx1) / rx, uy = (y1 - cy1) / ry;
+		const double vx = (-x1 - cx1) / rx, vy = (-y1 - cy1) / ry;
+
+		out.start_angle = std::atan2(uy, ux);
+		double sweep = std::atan2(vy, vx) - out.start_angle;
+
+		if (arc.sweep && sweep < 0) sweep += 2 * PI;
+		else if (!arc.sweep && sweep > 0) sweep -= 2 * PI;
+		out.sweep_angle = sweep;
+
+		return true;
+	}
+
 	/*
 	*****************
 	* Transform Types
 	*****************
 	*/
+	struct Matrix;
+
 	namespace abstracts
 	{
 		/*
 		* \brief change the geometry of a graphical element in some way
 		*/
-		struct Transform {}; // may be hit by empty basestruct optimization?
+		struct Transform
+		{
+			virtual ~Transform() = default;
+
+			/*
+			* \brief this transformation expressed as matrix
+			*/
+			virtual Matrix to_matrix() const = 0;
+		};
 	}
 
 	/*
 	* \brief A matrix with a fixed dimension (3x3), only values in the first 2 rows are accessible. (row3 = 0,0,1)
-	* The following implementation layout is defined by the spec :D
+	* The following implementation layout is defined by the spec (diagram 10.14, V1.1) and matches svg:
+	* | a c e |
+	* | b d f |
+	* | 0 0 1 |
+	* Default constructed matrices are the identity
 	*/
 	struct Matrix : public abstracts::Transform
 	{
-		union
+		double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+		Matrix() = default;
+
+		Matrix(double a, double b, double c, double d, double e, double f)
+			: a(a), b(b), c(c), d(d), e(e), f(f)
+		{}
+
+		Matrix to_matrix() const override
 		{
-			double _array[6];
-			double a, b, c, d, e, f;
-		};
+			return *this;
+		}
 
-		// As defined in diagram 10.14 (V1.1)
 		Point operator*(const Point& coordinates) const noexcept
 		{
 			Point p;
-			p.x = (coordinates.x * a) + (coordinates.x * b) + (coordinates.x * c);
-			p.y = (coordinates.y * d) + (coordinates.y * e) + (coordinates.y * f);
+			p.x = (coordinates.x * a) + (coordinates.y * c) + e;
+			p.y = (coordinates.x * b) + (coordinates.y * d) + f;
 
 			return p;
 		}
+
+		/*
+		* \brief compose two matrices. The result applies other first, then this
+		*/
+		Matrix operator*(const Matrix& other) const noexcept
+		{
+			return Matrix(
+				a * other.a + c * other.b,
+				b * other.a + d * other.b,
+				a * other.c + c * other.d,
+				b * other.c + d * other.d,
+				a * other.e + c * other.f + e,
+				b * other.e + d * other.f + f);
+		}
+
+		Matrix& operator*=(const Matrix& other) noexcept
+		{
+			return *this = *this * other;
+		}
+
+		bool operator==(const Matrix& other) const noexcept
+		{
+			return a == other.a && b == other.b && c == other.c && d == other.d && e == other.e && f == other.f;
+		}
+
+		bool operator!=(const Matrix& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		double determinant() const noexcept
+		{
+			return a * d - b * c;
+		}
+
+		bool is_identity() const noexcept
+		{
+			return *this == Matrix();
+		}
+
+		/*
+		* \brief inverse transformation. Throws if the matrix is singular
+		*/
+		Matrix inverse() const
+		{
+			const double det = determinant();
+			if (det == 0 || !std::isfinite(det)) throw std::logic_error("Matrix is singular and can't be inverted");
+
+			const double inv = 1.0 / det;
+			return Matrix(
+				d * inv,
+				-b * inv,
+				-c * inv,
+				a * inv,
+				(c * f - d * e) * inv,
+				(b * e - a * f) * inv);
+		}
+
+		/*
+		* \brief transform count points in place
+		*/
+		void transform(Point* points, size_t count) const noexcept
+		{
+			static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+			double* data = reinterpret_cast<double*>(points);
+			size_t i = 0;
+
+#if defined(DG_SIMD_AVX)
+			// two points per iteration: [x0 y0 x1 y1]
+			const __m256d col_x = _mm256_setr_pd(a, b, a, b);
+			const __m256d col_y = _mm256_setr_pd(c, d, c, d);
+			const __m256d col_t = _mm256_setr_pd(e, f, e, f);
+
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m256d p = _mm256_loadu_pd(data + i * 2);
+				const __m256d xx = _mm256_movedup_pd(p);       // x0 x0 x1 x1
+				const __m256d yy = _mm256_permute_pd(p, 0xf);  // y0 y0 y1 y1
+				const __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(xx, col_x), _mm256_mul_pd(yy, col_y)), col_t);
+				_mm256_storeu_pd(data + i * 2, r);
+			}
+#endif
+#if defined(DG_SIMD_SSE2)
+			// one point per iteration: [x y]
+			const __m128d col_x2 = _mm_setr_pd(a, b);
+			const __m128d col_y2 = _mm_setr_pd(c, d);
+			const __m128d col_t2 = _mm_setr_pd(e, f);
+
+			for (; i < count; i++)
+			{
+				const __m128d p = _mm_loadu_pd(data + i * 2);
+				const __m128d xx = _mm_unpacklo_pd(p, p);
+				const __m128d yy = _mm_unpackhi_pd(p, p);
+				const __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(xx, col_x2), _mm_mul_pd(yy, col_y2)), col_t2);
+				_mm_storeu_pd(data + i * 2, r);
+			}
+#endif
+			for (; i < count; i++) points[i] = *this * points[i];
+		}
+
+		void transform(std::vector<Point>& points) const noexcept
+		{
+			transform(points.data(), points.size());
+		}
+
+		/*
+		* Factories for the elementary transformations. Angles are in degrees
+		*/
+		static Matrix translation(double x_delta, double y_delta) noexcept
+		{
+			return Matrix(1, 0, 0, 1, x_delta, y_delta);
+		}
+
+		static Matrix scaling(double x_factor, double y_factor) noexcept
+		{
+			return Matrix(x_factor, 0, 0, y_factor, 0, 0);
+		}
+
+		static Matrix rotation(double angle, const Point& center = Point()) noexcept
+		{
+			const double rad = angle * 3.14159265358979323846 / 180.0;
+			const double cos_a = std::cos(rad), sin_a = std::sin(rad);
+
+			return translation(center.x, center.y) * Matrix(cos_a, sin_a, -sin_a, cos_a, 0, 0) * translation(-center.x, -center.y);
+		}
+
+		static Matrix skewing(double x_angle, double y_angle) noexcept
+		{
+			const double deg = 3.14159265358979323846 / 180.0;
+			return Matrix(1, std::tan(y_angle * deg), std::tan(x_angle * deg), 1, 0, 0);
+		}
 	};
 
 	struct Translate : public abstracts::Transform
 	{
 		double x_delta, y_delta;
+
+		Matrix to_matrix() const override
+		{
+			return Matrix::translation(x_delta, y_delta);
+		}
 	};
 
 	struct Scale : public abstracts::Transform
 	{
 		double x_factor, y_factor;
+
+		Matrix to_matrix() const override
+		{
+			return Matrix::scaling(x_factor, y_factor);
+		}
 	};
 
+	/*
+	* \brief angle in degrees
+	*/
 	struct Rotate : public abstracts::Transform
 	{
 		double angle;
 		Point center;
+
+		Matrix to_matrix() const override
+		{
+			return Matrix::rotation(angle, center);
+		}
 	};
 
+	/*
+	* \brief angles in degrees
+	*/
 	struct Skew : public abstracts::Transform
 	{
 		double x_angle, y_angle;
+
+		Matrix to_matrix() const override
+		{
+			return Matrix::skewing(x_angle, y_angle);
+		}
 	};
 
+	/*
+	* \brief compose a list of transforms into one matrix. Like in svg the first transform is the outermost one
+	*/
+	inline Matrix compose(const std::vector<abstracts::Transform*>& transforms)
+	{
+		Matrix m;
+		for (const abstracts::Transform* t : transforms)
+		{
+			if (t != nullptr) m *= t->to_matrix();
+		}
+		return m;
+	}
+
+	/*
+	* Helpers for the bounds of graphical elements
+	*/
+	namespace detail
+	{
+		/*
+		* \brief add an extremum along one axis, the stroke reaches half_width further along that axis
+		*/
+		inline void add_extremum(const Point& p, bool x_axis, double half_width, BoundingBox& box)
+		{
+			if (x_axis)
+			{
+				box.add(Point{ p.x - half_width, p.y });
+				box.add(Point{ p.x + half_width, p.y });
+			}
+			else
+			{
+				box.add(Point{ p.x, p.y - half_width });
+				box.add(Point{ p.x, p.y + half_width });
+			}
+		}
+
+		/*
+		* \brief box around the transformed corners of box
+		*/
+		inline BoundingBox transform_box(const Matrix& m, const BoundingBox& box)
+		{
+			if (box.empty() || m.is_identity()) return box;
+
+			BoundingBox out;
+			out.add(m * Point{ box.x0, box.y0 });
+			out.add(m * Point{ box.x1, box.y0 });
+			out.add(m * Point{ box.x1, box.y1 });
+			out.add(m * Point{ box.x0, box.y1 });
+			return out;
+		}
+
+		/*
+		* \brief add the extrema of a quadratic curve, end points included
+		* \param half_width: stroke reach at the extrema, the stroke at the end points is added by add_join
+		*/
+		inline void add_quadratic(const Point& p0, const Point& p1, const Point& p2, BoundingBox& box, double half_width = 0)
+		{
+			box.add(p0);
+			box.add(p2);
+
+			// B'(t) = 0 per axis
+			const double dx = p0.x - 2 * p1.x + p2.x, dy = p0.y - 2 * p1.y + p2.y;
+			const double roots[2] = { dx != 0 ? (p0.x - p1.x) / dx : -1.0, dy != 0 ? (p0.y - p1.y) / dy : -1.0 };
+			for (int axis = 0; axis < 2; axis++)
+			{
+				const double t = roots[axis];
+				if (!(t > 0 && t < 1)) continue;
+				const double mt = 1 - t;
+				add_extremum(Point{ mt * mt * p0.x + 2 * mt * t * p1.x + t * t * p2.x, mt * mt * p0.y + 2 * mt * t * p1.y + t * t * p2.y }, axis == 0, half_width, box);
+			}
+		}
+
+		/*
+		* \brief add the extrema of a cubic curve, end points included
+		*/
+		inline void add_cubic(const Point& p0, const Point& p1, const Point& p2, const Point& p3, BoundingBox& box, double half_width = 0)
+		{
+			box.add(p0);
+			box.add(p3);
+
+			auto at = [&](double t)
+			{
+				const double mt = 1 - t;
+				const double w0 = mt * mt * mt, w1 = 3 * mt * mt * t, w2 = 3 * mt * t * t, w3 = t * t * t;
+				return Point{ w0 * p0.x + w1 * p1.x + w2 * p2.x + w3 * p3.x, w0 * p0.y + w1 * p1.y + w2 * p2.y + w3 * p3.y };
+			};
+
+			// B'(t) / 3 = a * t^2 + b * t + c per axis
+			const double coefficients[2][3] = {
+				{ -p0.x + 3 * p1.x - 3 * p2.x + p3.x, 2 * (p0.x - 2 * p1.x + p2.x), p1.x - p0.x },
+				{ -p0.y + 3 * p1.y - 3 * p2.y + p3.y, 2 * (p0.y - 2 * p1.y + p2.y), p1.y - p0.y }
+			};
+
+			for (int axis = 0; axis < 2; axis++)
+			{
+				const double a = coefficients[axis][0], b = coefficients[axis][1], c = coefficients[axis][2];
+				if (std::abs(a) < 1e-12)
+				{
+					if (b != 0 && -c / b > 0 && -c / b < 1) add_extremum(at(-c / b), axis == 0, half_width, box);
+					continue;
+				}
+
+				const double disc = b * b - 4 * a * c;
+				if (disc < 0) continue;
+
+				const double root = std::sqrt(disc);
+				for (const double t : { (-b + root) / (2 * a), (-b - root) / (2 * a) })
+				{
+					if (t > 0 && t < 1) add_extremum(at(t), axis == 0, half_width, box);
+				}
+			}
+		}
+
+		/*
+		* \brief add the extrema of an arc, end points included
+		*/
+		inline void add_arc(const Point& from, const EllipticalArcTo& arc, const Point& to, BoundingBox& box, double half_width = 0)
+		{
+			box.add(from);
+			box.add(to);
+
+			ArcCenter c;
+			if (!arc_to_center(from, arc, to, c)) return;
+
+			// angles where dx/dangle = 0 and dy/dangle = 0, each repeats after pi
+			const double cos_phi = std::cos(c.phi), sin_phi = std::sin(c.phi);
+			const double x_extremum = std::atan2(-c.ry * sin_phi, c.rx * cos_phi);
+			const double y_extremum = std::atan2(c.ry * cos_phi, c.rx * sin_phi);
+
+			const double angles[4] = { x_extremum, x_extremum + 3.14159265358979323846, y_extremum, y_extremum + 3.14159265358979323846 };
+			for (int i = 0; i < 4; i++)
+			{
+				if (c.covers(angles[i])) add_extremum(c.at(angles[i]), i < 2, half_width, box);
+			}
+		}
+
+		/*
+		* \brief add the outline of a stroke join at v. in and out are the directions of the adjacent segments
+		*        Mirrors the miter/bevel decision of the rasterizer
+		*/
+		inline void add_join(const Point& v, Point in, Point out, double half_width, BoundingBox& box)
+		{
+			auto normalize = [](Point& p)
+			{
+				const double length = std::hypot(p.x, p.y);
+				if (length == 0) return false;
+				p.x /= length;
+				p.y /= length;
+				return true;
+			};
+
+			const bool has_in = normalize(in), has_out = normalize(out);
+
+			// ends of the adjacent segment quads
+			for (const Point& d : { in, out })
+			{
+				box.add(Point{ v.x - d.y * half_width, v.y + d.x * half_width });
+				box.add(Point{ v.x + d.y * half_width, v.y - d.x * half_width });
+			}
+			if (!has_in || !has_out) return;
+
+			// sum of the normals, both sides are added because the outer side depends on the turn direction
+			const Point mid{ -in.y - out.y, in.x + out.x };
+			const double mid_length = std::hypot(mid.x, mid.y);
+			if (mid_length > 2 / STROKE_MITER_LIMIT)
+			{
+				const double miter = 2 * half_width / (mid_length * mid_length);
+				box.add(Point{ v.x + mid.x * miter, v.y + mid.y * miter });
+				box.add(Point{ v.x - mid.x * miter, v.y - mid.y * miter });
+			}
+		}
+
+		/*
+		* \brief add the stroke outline of a polyline
+		*/
+		inline void add_stroked_polyline(const Point* points, size_t count, bool closed, double half_width, BoundingBox& box)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const Point& v = points[i];
+				const Point* prev = i > 0 ? &points[i - 1] : (closed && count > 2 ? &points[count - 1] : nullptr);
+				const Point* next = i + 1 < count ? &points[i + 1] : (closed && count > 2 ? &points[0] : nullptr);
+
+				const Point in = prev != nullptr ? Point{ v.x - prev->x, v.y - prev->y } : Point();
+				const Point out = next != nullptr ? Point{ next->x - v.x, next->y - v.y } : Point();
+				add_join(v, in, out, half_width, box);
+			}
+		}
+	}
+
 	/*
 	***********
 	* Gradients
@@ -212,6 +1003,35 @@ namespace DG
 			std::vector<Transform*> transforms;
 
 			Canvas* owner = nullptr;
+
+			virtual ~Fill() = default;
+
+			/*
+			* \brief composition of transforms, maps fill coordinates to the coordinates of the painted element
+			*/
+			Matrix matrix() const
+			{
+				return compose(transforms);
+			}
+
+			/*
+			* \brief must be called after stops, tile, bounds or transforms changed. Renderers rebuild what they cached for this fill
+			*/
+			void invalidate()
+			{
+				_revision = detail::next_revision();
+			}
+
+			/*
+			* \brief changes with every invalidate. Renderers key their gradient tables and pattern tiles by it
+			*/
+			uint64_t revision() const
+			{
+				return _revision;
+			}
+
+		protected:
+			uint64_t _revision = detail::next_revision();
 		};
 
 
@@ -260,6 +1080,146 @@ namespace DG
 }
 
 
+/*
+* This segment contains the memory arena used by canvases
+*/
+namespace DG
+{
+	/*
+	* \brief bump allocator which owns every object created in it
+	*
+	* - objects are placed into large blocks, creating an object is a pointer increment
+	* - destructors run in reverse creation order on release, trivially destructible objects cost nothing
+	* - release() keeps the first block, so rebuilding a canvas of similar size does not allocate again
+	* - not thread safe, one arena is filled by one thread
+	*/
+	class Arena
+	{
+	public:
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+		Arena() = default;
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		~Arena()
+		{
+			release();
+			if (head != nullptr) ::operator delete(head);
+		}
+
+		/*
+		* \brief construct an object in the arena. It lives until release() or the destruction of the arena
+		*/
+		template<typename T, typename... T_args>
+		T* create(T_args&&... args)
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+			void* memory = allocate(sizeof(T), alignof(T));
+			T* object = new (memory) T(std::forward<T_args>(args)...);
+
+			if (!std::is_trivially_destructible<T>::value)
+			{
+				Destructor* entry = static_cast<Destructor*>(allocate(sizeof(Destructor), alignof(Destructor)));
+				entry->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+				entry->object = object;
+				entry->next = destructors;
+				destructors = entry;
+			}
+			return object;
+		}
+
+		/*
+		* \brief destroy all objects. The first block is kept for reuse
+		*/
+		void release()
+		{
+			// newest first, objects may reference older ones
+			for (Destructor* entry = destructors; entry != nullptr; entry = entry->next) entry->destroy(entry->object);
+			destructors = nullptr;
+
+			if (head == nullptr) return;
+
+			Block* block = head->next;
+			while (block != nullptr)
+			{
+				Block* next = block->next;
+				::operator delete(block);
+				block = next;
+			}
+			head->next = nullptr;
+			current = head;
+			used = sizeof(Block);
+		}
+
+		/*
+		* \brief bytes reserved from the system
+		*/
+		size_t capacity() const
+		{
+			size_t bytes = 0;
+			for (const Block* block = head; block != nullptr; block = block->next) bytes += block->size;
+			return bytes;
+		}
+
+	private:
+		struct alignas(std::max_align_t) Block
+		{
+			Block* next;
+			size_t size;
+		};
+
+		// intrusive list of pending destructor calls, stored in the arena itself
+		struct Destructor
+		{
+			void (*destroy)(void*);
+			void* object;
+			Destructor* next;
+		};
+
+		Block* head = nullptr;
+		Block* current = nullptr;
+
+		// bytes used in current, including the header
+		size_t used = 0;
+
+		Destructor* destructors = nullptr;
+
+		void* allocate(size_t size, size_t alignment)
+		{
+			size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+			if (current == nullptr || offset + size > current->size)
+			{
+				// oversized objects get a block of their own
+				const size_t block_size = std::max(BLOCK_SIZE, sizeof(Block) + size);
+
+				// reuse the blocks kept by release
+				if (current != nullptr && current->next != nullptr && current->next->size >= sizeof(Block) + size)
+				{
+					current = current->next;
+				}
+				else
+				{
+					Block* block = static_cast<Block*>(::operator new(block_size));
+					block->size = block_size;
+					block->next = current != nullptr ? current->next : nullptr;
+
+					if (current != nullptr) current->next = block;
+					else head = block;
+					current = block;
+				}
+				offset = sizeof(Block);
+			}
+
+			used = offset + size;
+			return reinterpret_cast<char*>(current) + offset;
+		}
+	};
+}
+
+
 /*
 * This segment contains Group and Graphical Element structes
 */
@@ -275,7 +1235,8 @@ namespace DG
 		struct GraphicalElementVirtualizer
 		{
 		public:
-			virtual void foo();
+			virtual ~GraphicalElementVirtualizer() = default;
+			virtual void foo() {};
 		};
 
 
@@ -292,6 +1253,139 @@ namespace DG
 			ClipPath* mask = nullptr;
 
 			void foo() {};
+
+			/*
+			* \brief composition of transforms. Cached, call invalidate_transform after changing transforms
+			*/
+			const Matrix& local_matrix() const
+			{
+				if (_local_dirty)
+				{
+					_local_matrix = compose(transforms);
+					_local_dirty = false;
+				}
+				return _local_matrix;
+			}
+
+			/*
+			* \brief maps local coordinates to canvas coordinates: owner chain and local_matrix. Cached
+			*/
+			const Matrix& world_matrix() const;
+
+			/*
+			* \brief must be called after transforms changed. Invalidates this element, all owned elements and the bounds of the owner chain
+			*/
+			void invalidate_transform();
+
+			/*
+			* \brief must be called after owner (or any transform of the owner chain) changed
+			*/
+			virtual void invalidate_world()
+			{
+				_revision = detail::next_revision();
+				_world_dirty = true;
+				_world_bounds_dirty = true;
+			}
+
+			/*
+			* \brief bounds in local coordinates (before transforms), stroke and markers included. Cached
+			*/
+			const BoundingBox& local_bounds() const
+			{
+				if (_bounds_dirty)
+				{
+					_local_bounds = compute_local_bounds();
+					_bounds_dirty = false;
+				}
+				return _local_bounds;
+			}
+
+			/*
+			* \brief bounds in canvas coordinates. Cached
+			*/
+			const BoundingBox& world_bounds() const
+			{
+				if (_world_bounds_dirty)
+				{
+					_world_bounds = compute_world_bounds();
+					_world_bounds_dirty = false;
+				}
+				return _world_bounds;
+			}
+
+			/*
+			* \brief must be called after the geometry or the stroke style of this element changed. Invalidates the owner chain
+			*/
+			void invalidate_bounds();
+
+			/*
+			* \brief style after the cascade. Cached, call invalidate_style after changing styles
+			*/
+			const ResolvedStyle& resolved_style() const
+			{
+				if (_style_dirty)
+				{
+					resolve_style(_resolved_style);
+					_style_dirty = false;
+				}
+				return _resolved_style;
+			}
+
+			/*
+			* \brief must be called after s_local, s_shared or a referenced style changed. Invalidates all owned elements
+			*/
+			virtual void invalidate_style()
+			{
+				_style_dirty = true;
+
+				// stroke width and markers are part of the bounds
+				invalidate_bounds();
+			}
+
+			/*
+			* \brief false for elements which are only drawn where they are referenced (markers, clip paths)
+			*/
+			virtual bool is_drawn() const
+			{
+				return true;
+			}
+
+			/*
+			* \brief changes with every invalidation of this element. Renderers compare it to detect changed elements
+			*/
+			uint64_t revision() const
+			{
+				return _revision;
+			}
+
+		protected:
+			uint64_t _revision = detail::next_revision();
+
+			mutable Matrix _local_matrix, _world_matrix;
+			mutable bool _local_dirty = true, _world_dirty = true;
+
+			mutable BoundingBox _local_bounds, _world_bounds;
+			mutable bool _bounds_dirty = true, _world_bounds_dirty = true;
+
+			mutable ResolvedStyle _resolved_style;
+			mutable bool _style_dirty = true;
+
+			void resolve_style(ResolvedStyle& out) const;
+
+			virtual BoundingBox compute_local_bounds() const
+			{
+				return BoundingBox();
+			}
+
+			virtual BoundingBox compute_world_bounds() const;
+
+			/*
+			* \brief half the stroke width, 0 if the element has no stroke
+			*/
+			double stroke_extent() const
+			{
+				return resolved_style().stroke_extent();
+			}
 		};
 	}
 
@@ -304,8 +1398,158 @@ namespace DG
 	struct Group : public abstracts::GraphicalElement
 	{
 		std::vector<abstracts::GraphicalElement*> members;
+
+		/*
+		* \brief append a member and set this group as its owner
+		*/
+		void add_member(abstracts::GraphicalElement* member)
+		{
+			members.push_back(member);
+			member->owner = this;
+			member->invalidate_world();
+			member->invalidate_style();
+			invalidate_bounds();
+		}
+
+		void invalidate_world() override
+		{
+			_revision = detail::next_revision();
+
+			// members can't be clean if this group is dirty, see world_matrix
+			if (_world_dirty) return;
+
+			_world_dirty = true;
+			_world_bounds_dirty = true;
+			for (abstracts::GraphicalElement* member : members) member->invalidate_world();
+		}
+
+		void invalidate_style() override
+		{
+			// members can't be clean if this group is dirty, see resolve_style
+			if (_style_dirty) return;
+
+			abstracts::GraphicalElement::invalidate_style();
+			for (abstracts::GraphicalElement* member : members)
+			{
+				if (member != nullptr) member->invalidate_style();
+			}
+		}
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			BoundingBox box;
+			for (const abstracts::GraphicalElement* member : members)
+			{
+				if (member != nullptr && member->is_drawn()) box.add(detail::transform_box(member->local_matrix(), member->local_bounds()));
+			}
+			return box;
+		}
+
+		// tighter than the transformed local bounds if members are rotated
+		BoundingBox compute_world_bounds() const override
+		{
+			BoundingBox box;
+			for (const abstracts::GraphicalElement* member : members)
+			{
+				if (member != nullptr && member->is_drawn()) box.add(member->world_bounds());
+			}
+			return box;
+		}
 	};
 
+	inline const Matrix& abstracts::GraphicalElement::world_matrix() const
+	{
+		if (_world_dirty)
+		{
+			_world_matrix = owner != nullptr ? owner->world_matrix() * local_matrix() : local_matrix();
+			_world_dirty = false;
+		}
+		return _world_matrix;
+	}
+
+	inline void abstracts::GraphicalElement::invalidate_transform()
+	{
+		_local_dirty = true;
+		invalidate_world();
+
+		// the bounds of the owner contain the transformed bounds of this element
+		if (owner != nullptr) owner->invalidate_bounds();
+	}
+
+	inline void abstracts::GraphicalElement::invalidate_bounds()
+	{
+		_revision = detail::next_revision();
+
+		// owners can't be clean if this element is dirty, see Group::compute_local_bounds and Group::compute_world_bounds
+		// both flags count, groups compute their world bounds without their local bounds
+		if (_bounds_dirty && _world_bounds_dirty) return;
+
+		_bounds_dirty = true;
+		_world_bounds_dirty = true;
+		if (owner != nullptr) owner->invalidate_bounds();
+	}
+
+	inline BoundingBox abstracts::GraphicalElement::compute_world_bounds() const
+	{
+		return detail::transform_box(world_matrix(), local_bounds());
+	}
+
+	inline void abstracts::GraphicalElement::resolve_style(ResolvedStyle& out) const
+	{
+		// inherit everything, then override with the first set property of this element
+		out = owner != nullptr ? owner->resolved_style() : ResolvedStyle();
+
+		// first style of this element which sets key
+		auto own = [this](Style::Key key) -> const Style*
+		{
+			for (const Style& style : s_local)
+			{
+				if (style.has(key)) return &style;
+			}
+			for (const Style* style : s_shared)
+			{
+				if (style != nullptr && style->has(key)) return style;
+			}
+			return nullptr;
+		};
+
+		const Style* fill = own(Style::Key::fill);
+		const Style* fill_color = own(Style::Key::fillColor);
+		if (fill != nullptr)
+		{
+			out.fill = fill->fill();
+		}
+		else if (fill_color != nullptr)
+		{
+			// a local color replaces an inherited fill
+			out.fill = nullptr;
+		}
+		if (fill_color != nullptr)
+		{
+			out.fill_color = fill_color->fill_color();
+			out.has_fill_color = true;
+		}
+		if (const Style* p = own(Style::Key::fillOpacity)) out.fill_opacity = p->fill_opacity();
+
+		if (const Style* p = own(Style::Key::strokeColor))
+		{
+			out.stroke_color = p->stroke_color();
+			out.has_stroke = true;
+		}
+		if (const Style* p = own(Style::Key::strokeWidth)) out.stroke_width = p->stroke_width();
+		if (const Style* p = own(Style::Key::strokeOpacity)) out.stroke_opacity = p->stroke_opacity();
+		if (const Style* p = own(Style::Key::strokeDashLength)) out.dashes = &p->stroke_dash_length();
+
+		if (const Style* p = own(Style::Key::fontColor)) out.font_color = p->font_color();
+		if (const Style* p = own(Style::Key::fontSize)) out.font_size = p->font_size();
+		if (const Style* p = own(Style::Key::fontName)) out.font_name = &p->font_name();
+		if (const Style* p = own(Style::Key::fontItalic)) out.italic = p->font_italic();
+		if (const Style* p = own(Style::Key::fontBold)) out.bold = p->font_bold();
+		if (const Style* p = own(Style::Key::fontUnderline)) out.underline = p->font_underline();
+		if (const Style* p = own(Style::Key::fontStrikeThrough)) out.strike_through = p->font_strike_through();
+	}
+
 	/*
 	* \brief Defines an arrowhead
 	*/
@@ -316,6 +1560,11 @@ namespace DG
 	{
 		// TODO: what does it do?
 		abstracts::GraphicalElement* owner;
+
+		bool is_drawn() const override
+		{
+			return false;
+		}
 	};
 
 
@@ -326,14 +1575,53 @@ namespace DG
 	{
 		// exclusive, if c_background and f_background are set f_background is used
 		// no valid value evaluates to transparent
-		Color c_background;
+		Color c_background = KnownColor::white;
 		abstracts::Fill* f_background = nullptr;
 
 		// All fills this canvas ownes
 		// new Fill-Subtypes are stored here
 		std::vector<abstracts::Fill*> package_fills;
 
-		std::vector<Style> package_styles;
+		// shared styles, call invalidate_style on the canvas after changing them
+		// a deque keeps pointers to the styles valid while new ones are appended
+		std::deque<Style> package_styles;
+
+		Canvas() = default;
+		// elements reference each other by pointer, a copy would still point into this canvas
+		Canvas(const Canvas&) = delete;
+		Canvas& operator=(const Canvas&) = delete;
+
+		/*
+		* \brief create an element, fill, transform or marker owned by this canvas
+		*        The object is destroyed with the canvas or by clear()
+		*/
+		template<typename T, typename... T_args>
+		T* create(T_args&&... args)
+		{
+			return pool.create<T>(std::forward<T_args>(args)...);
+		}
+
+		/*
+		* \brief remove all content and destroy every object created by this canvas
+		*/
+		void clear()
+		{
+			members.clear();
+			package_fills.clear();
+			package_styles.clear();
+			f_background = nullptr;
+			pool.release();
+			invalidate_bounds();
+		}
+
+		const Arena& arena() const
+		{
+			return pool;
+		}
+
+	private:
+		// declared last, objects are destroyed before the containers referencing them
+		Arena pool;
 	};
 
 
@@ -344,6 +1632,15 @@ namespace DG
 		Bounds bounds;
 
 		double corner_radius = 0;
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			// right angled miters reach exactly half the stroke width in both directions
+			BoundingBox box = BoundingBox::from(bounds);
+			box.inflate(stroke_extent());
+			return box;
+		}
 	};
 
 
@@ -353,6 +1650,17 @@ namespace DG
 		Point center;
 
 		double radius;
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			const double r = std::abs(radius) + stroke_extent();
+
+			BoundingBox box;
+			box.add(Point{ center.x - r, center.y - r });
+			box.add(Point{ center.x + r, center.y + r });
+			return box;
+		}
 	};
 
 	struct Ellipse
@@ -367,6 +1675,15 @@ namespace DG
 		std::string data;
 		Bounds bounds;
 		AlignmentKind alignment;
+
+		// break lines between words to fit into bounds, see DG::text::layout
+		bool wrap = false;
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			return BoundingBox::from(bounds);
+		}
 	};
 
 	struct Image
@@ -391,6 +1708,27 @@ namespace DG
 		Point reference;
 
 		Canvas* owner;
+
+		bool is_drawn() const override
+		{
+			return false;
+		}
+
+		/*
+		* \brief distance from reference to the farthest point of the marker, markers may be rotated around reference
+		*/
+		double reach() const
+		{
+			BoundingBox box = local_bounds();
+			if (box.empty()) box = BoundingBox::from(Bounds{ Point(), size });
+
+			double reach = 0;
+			for (const Point& corner : { Point{ box.x0, box.y0 }, Point{ box.x1, box.y0 }, Point{ box.x1, box.y1 }, Point{ box.x0, box.y1 } })
+			{
+				reach = std::max(reach, std::hypot(corner.x - reference.x, corner.y - reference.y));
+			}
+			return reach;
+		}
 	};
 
 	namespace abstracts
@@ -402,6 +1740,46 @@ namespace DG
 		struct MarkedElement : public GraphicalElement
 		{
 			Marker* start = nullptr, * end = nullptr, * mid = nullptr;
+
+		protected:
+			/*
+			* \brief add the markers placed on the vertices of the element
+			* \param vertices: first and last vertex get start and end, all others mid
+			*/
+			void add_marker_bounds(const Point* vertices, size_t count, BoundingBox& box) const
+			{
+				if (count == 0) return;
+
+				auto place = [&](const Marker* marker, const Point& p)
+				{
+					if (marker == nullptr) return;
+					const double r = marker->reach();
+					box.add(Point{ p.x - r, p.y - r });
+					box.add(Point{ p.x + r, p.y + r });
+				};
+
+				place(start, vertices[0]);
+				place(end, vertices[count - 1]);
+				if (mid != nullptr)
+				{
+					for (size_t i = 1; i + 1 < count; i++) place(mid, vertices[i]);
+				}
+			}
+
+			/*
+			* \brief bounds of a polyline with stroke and markers
+			*/
+			BoundingBox polyline_bounds(const Point* points, size_t count, bool closed) const
+			{
+				BoundingBox box;
+				const double half_width = stroke_extent();
+
+				if (half_width > 0) detail::add_stroked_polyline(points, count, closed, half_width, box);
+				else for (size_t i = 0; i < count; i++) box.add(points[i]);
+
+				add_marker_bounds(points, count, box);
+				return box;
+			}
 		};
 	}
 
@@ -411,6 +1789,13 @@ namespace DG
 	struct Line : public abstracts::MarkedElement
 	{
 		Point start, end;
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			const Point points[2] = { start, end };
+			return polyline_bounds(points, 2, false);
+		}
 	};
 
 	/*
@@ -418,7 +1803,132 @@ namespace DG
 	*/
 	struct Path : public abstracts::MarkedElement
 	{
-		std::vector<abstracts::PathCommand*> commands;
+		// reserve before adding many commands, the whole path is one allocation
+		std::vector<PathSegment> commands;
+
+	protected:
+		/*
+		* \brief curve extrema, stroke joins at the command vertices and markers
+		*/
+		BoundingBox compute_local_bounds() const override
+		{
+			const double half_width = stroke_extent();
+
+			BoundingBox box;
+			std::vector<Point> vertices;
+
+			Point current, start_point;
+			// directions at the current vertex and at the start of the subpath
+			Point in, first_out;
+			bool open = false;
+
+			auto join = [&](const Point& out)
+			{
+				if (half_width <= 0) return;
+				if (!open) first_out = out;
+				detail::add_join(current, open ? in : Point(), out, half_width, box);
+			};
+			// first non-degenerate direction out of candidates
+			auto direction = [](const Point& from, std::initializer_list<Point> candidates)
+			{
+				for (const Point& p : candidates)
+				{
+					if (p.x != from.x || p.y != from.y) return Point{ p.x - from.x, p.y - from.y };
+				}
+				return Point();
+			};
+
+			for (const PathSegment& command : commands)
+			{
+				const Point origin = is_relative(command) ? current : Point();
+				auto resolve = [&](const Point& p) { return Point{ p.x + origin.x, p.y + origin.y }; };
+
+				// direction at the start and at the end of the command
+				Point next, out, end_in;
+				if (const MoveTo* move = std::get_if<MoveTo>(&command))
+				{
+					// cap of the previous subpath
+					if (open && half_width > 0) detail::add_join(current, in, Point(), half_width, box);
+					current = start_point = resolve(move->point);
+					open = false;
+					continue;
+				}
+				else if (const LineTo* line = std::get_if<LineTo>(&command))
+				{
+					next = resolve(line->point);
+					out = end_in = Point{ next.x - current.x, next.y - current.y };
+				}
+				else if (const CubicCurveTo* cubic = std::get_if<CubicCurveTo>(&command))
+				{
+					const Point p1 = resolve(cubic->control_start), p2 = resolve(cubic->control_end);
+					next = resolve(cubic->point);
+					detail::add_cubic(current, p1, p2, next, box, half_width);
+					out = direction(current, { p1, p2, next });
+					end_in = direction(next, { p2, p1, current });
+					end_in = Point{ -end_in.x, -end_in.y };
+				}
+				else if (const QuadraticCurveTo* quadratic = std::get_if<QuadraticCurveTo>(&command))
+				{
+					const Point p1 = resolve(quadratic->control);
+					next = resolve(quadratic->point);
+					detail::add_quadratic(current, p1, next, box, half_width);
+					out = direction(current, { p1, next });
+					end_in = direction(next, { p1, current });
+					end_in = Point{ -end_in.x, -end_in.y };
+				}
+				else if (const EllipticalArcTo* arc = std::get_if<EllipticalArcTo>(&command))
+				{
+					next = resolve(arc->point);
+					detail::add_arc(current, *arc, next, box, half_width);
+
+					ArcCenter c;
+					if (arc_to_center(current, *arc, next, c))
+					{
+						// the tangent points along increasing angles, flip it for negative sweeps
+						const double sign = c.sweep_angle >= 0 ? 1 : -1;
+						const Point t0 = c.tangent(c.start_angle), t1 = c.tangent(c.start_angle + c.sweep_angle);
+						out = Point{ t0.x * sign, t0.y * sign };
+						end_in = Point{ t1.x * sign, t1.y * sign };
+					}
+					else
+					{
+						out = end_in = Point{ next.x - current.x, next.y - current.y };
+					}
+				}
+				else if (std::holds_alternative<ClosePath>(command))
+				{
+					if (open)
+					{
+						// closing segment and the join at the start of the subpath
+						const Point closing{ start_point.x - current.x, start_point.y - current.y };
+						join(closing);
+						box.add(start_point);
+						if (half_width > 0) detail::add_join(start_point, closing.x != 0 || closing.y != 0 ? closing : in, first_out, half_width, box);
+					}
+					current = start_point;
+					open = false;
+					continue;
+				}
+				else
+				{
+					continue;
+				}
+
+				if (!open) vertices.push_back(current);
+				join(out);
+				box.add(current);
+				box.add(next);
+				vertices.push_back(next);
+
+				current = next;
+				in = end_in;
+				open = true;
+			}
+			if (open && half_width > 0) detail::add_join(current, in, Point(), half_width, box);
+
+			add_marker_bounds(vertices.data(), vertices.size(), box);
+			return box;
+		}
 	};
 
 	/*
@@ -427,6 +1937,12 @@ namespace DG
 	struct Polygon : public abstracts::MarkedElement
 	{
 		std::vector<Point> points; // TODO. must be >= 3 Points
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			return polyline_bounds(points.data(), points.size(), true);
+		}
 	};
 
 	/*
@@ -435,5 +1951,11 @@ namespace DG
 	struct PolyLine : public abstracts::MarkedElement
 	{
 		std::vector<Point> points; //TODO: must be >= 2 Points
+
+	protected:
+		BoundingBox compute_local_bounds() const override
+		{
+			return polyline_bounds(points.data(), points.size(), false);
+		}
 	};
 }
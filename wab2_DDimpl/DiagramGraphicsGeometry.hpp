@@ -0,0 +1,634 @@
+#pragma once
+#include "DiagramGraphics.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+* Flattening of DG geometry into polylines
+* -> curves are subdivided adaptively, the number of segments follows from the tolerance (Wang's formula)
+* -> elliptical arcs are converted to center parameterization (arc_to_center) and sampled by angle
+* -> results are written into a FlatPath which can be reused between calls to avoid allocations
+*
+* All consumers (rasterizer, bounds, hit-testing) work on the flattened segments
+*
+* Clipping of flattened polygons
+* -> clip_rectangle: Sutherland-Hodgman against an axis aligned rectangle
+* -> Clipper: intersection of two arbitrary polygon sets (nonzero rule) by decomposition into scanbeams
+*/
+namespace DG
+{
+	namespace geometry
+	{
+		constexpr double PI = 3.14159265358979323846;
+
+		// upper limit of segments per curve, protects against absurd tolerances
+		constexpr int MAX_SEGMENTS = 4096;
+
+		/*
+		* \brief flattened path: all points in one array, contours are separated by end indices
+		*/
+		struct FlatPath
+		{
+			std::vector<Point> points;
+
+			// exclusive end index into points for every contour
+			std::vector<size_t> ends;
+			std::vector<bool> closed;
+
+			void clear()
+			{
+				points.clear();
+				ends.clear();
+				closed.clear();
+			}
+
+			bool empty() const
+			{
+				return ends.empty();
+			}
+
+			size_t contour_count() const
+			{
+				return ends.size();
+			}
+
+			size_t contour_begin(size_t contour) const
+			{
+				return contour == 0 ? 0 : ends.at(contour - 1);
+			}
+
+			size_t contour_size(size_t contour) const
+			{
+				return ends.at(contour) - contour_begin(contour);
+			}
+
+			const Point* contour_data(size_t contour) const
+			{
+				return points.data() + contour_begin(contour);
+			}
+
+			/*
+			* \brief start a new contour at p
+			*/
+			void move_to(const Point& p)
+			{
+				points.push_back(p);
+				ends.push_back(points.size());
+				closed.push_back(false);
+			}
+
+			/*
+			* \brief append p to the last contour
+			*/
+			void line_to(const Point& p)
+			{
+				points.push_back(p);
+				ends.back() = points.size();
+			}
+
+			void close()
+			{
+				if (!closed.empty()) closed.back() = true;
+			}
+		};
+
+		/*
+		* \brief number of segments needed to keep a quadratic curve within tolerance
+		*/
+		inline int quadratic_segments(const Point& p0, const Point& p1, const Point& p2, double tolerance)
+		{
+			// Wang's formula: n = sqrt(d * (d - 1) / 8 * max|second difference| / tolerance) with degree d = 2
+			const double dx = p0.x - 2 * p1.x + p2.x, dy = p0.y - 2 * p1.y + p2.y;
+			const double n = std::ceil(std::sqrt(std::sqrt(dx * dx + dy * dy) / (4 * tolerance)));
+			return std::clamp(static_cast<int>(n), 1, MAX_SEGMENTS);
+		}
+
+		/*
+		* \brief number of segments needed to keep a cubic curve within tolerance
+		*/
+		inline int cubic_segments(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double tolerance)
+		{
+			// Wang's formula with degree d = 3: n = sqrt(3 / 4 * max|second difference| / tolerance)
+			const double ax = p0.x - 2 * p1.x + p2.x, ay = p0.y - 2 * p1.y + p2.y;
+			const double bx = p1.x - 2 * p2.x + p3.x, by = p1.y - 2 * p2.y + p3.y;
+			const double dd = std::sqrt(std::max(ax * ax + ay * ay, bx * bx + by * by));
+			const double n = std::ceil(std::sqrt(0.75 * dd / tolerance));
+			return std::clamp(static_cast<int>(n), 1, MAX_SEGMENTS);
+		}
+
+		/*
+		* \brief append the points of a quadratic curve (without p0) to out
+		*/
+		inline void flatten_quadratic(const Point& p0, const Point& p1, const Point& p2, double tolerance, std::vector<Point>& out)
+		{
+			const int segments = quadratic_segments(p0, p1, p2, tolerance);
+
+			// power basis: B(t) = (a * t + b) * t + p0
+			const double ax = p0.x - 2 * p1.x + p2.x, ay = p0.y - 2 * p1.y + p2.y;
+			const double bx = 2 * (p1.x - p0.x), by = 2 * (p1.y - p0.y);
+
+			const size_t first = out.size();
+			out.resize(first + segments);
+			Point* dst = out.data() + first;
+
+			// iterations are independent, the compiler can vectorize this loop
+			const double step = 1.0 / segments;
+			for (int i = 0; i < segments - 1; i++)
+			{
+				const double t = (i + 1) * step;
+				dst[i].x = (ax * t + bx) * t + p0.x;
+				dst[i].y = (ay * t + by) * t + p0.y;
+			}
+			// exact end point, no rounding drift
+			dst[segments - 1] = p2;
+		}
+
+		/*
+		* \brief append the points of a cubic curve (without p0) to out
+		*/
+		inline void flatten_cubic(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double tolerance, std::vector<Point>& out)
+		{
+			const int segments = cubic_segments(p0, p1, p2, p3, tolerance);
+
+			// power basis: B(t) = ((a * t + b) * t + c) * t + p0
+			const double ax = p3.x - p0.x + 3 * (p1.x - p2.x), ay = p3.y - p0.y + 3 * (p1.y - p2.y);
+			const double bx = 3 * (p0.x - 2 * p1.x + p2.x), by = 3 * (p0.y - 2 * p1.y + p2.y);
+			const double cx = 3 * (p1.x - p0.x), cy = 3 * (p1.y - p0.y);
+
+			const size_t first = out.size();
+			out.resize(first + segments);
+			Point* dst = out.data() + first;
+
+			// iterations are independent, the compiler can vectorize this loop
+			const double step = 1.0 / segments;
+			for (int i = 0; i < segments - 1; i++)
+			{
+				const double t = (i + 1) * step;
+				dst[i].x = ((ax * t + bx) * t + cx) * t + p0.x;
+				dst[i].y = ((ay * t + by) * t + cy) * t + p0.y;
+			}
+			dst[segments - 1] = p3;
+		}
+
+		/*
+		* \brief append the points of an elliptical arc (without from) to out
+		*/
+		inline void flatten_arc(const Point& from, const EllipticalArcTo& arc, const Point& to, double tolerance, std::vector<Point>& out)
+		{
+			ArcCenter c;
+			if (!arc_to_center(from, arc, to, c))
+			{
+				out.push_back(to);
+				return;
+			}
+
+			// maximum angle step which keeps the chord error of the larger radius within tolerance
+			const double radius = std::max(c.rx, c.ry);
+			const double max_step = radius > tolerance ? 2 * std::acos(1 - tolerance / radius) : PI / 2;
+			const int segments = std::clamp(static_cast<int>(std::ceil(std::abs(c.sweep_angle) / max_step)), 1, MAX_SEGMENTS);
+
+			const double cos_phi = std::cos(c.phi), sin_phi = std::sin(c.phi);
+			const double step = c.sweep_angle / segments;
+
+			for (int i = 1; i < segments; i++)
+			{
+				const double angle = c.start_angle + step * i;
+				const double x = c.rx * std::cos(angle), y = c.ry * std::sin(angle);
+				out.push_back(Point{ c.center.x + cos_phi * x - sin_phi * y, c.center.y + sin_phi * x + cos_phi * y });
+			}
+			out.push_back(to);
+		}
+
+		/*
+		* \brief flatten the commands of a path. out is cleared first
+		* \param tolerance: maximum distance between curve and polyline in path coordinates
+		*/
+		inline void flatten(const Path& path, double tolerance, FlatPath& out)
+		{
+			out.clear();
+			tolerance = std::max(tolerance, 1e-9);
+
+			Point current, start;
+			bool open = false;
+
+			auto ensure_open = [&]()
+			{
+				if (open) return;
+				out.move_to(current);
+				open = true;
+			};
+
+			for (const PathSegment& command : path.commands)
+			{
+				const Point origin = is_relative(command) ? current : Point();
+				auto resolve = [&](const Point& p) { return Point{ p.x + origin.x, p.y + origin.y }; };
+
+				if (const MoveTo* move = std::get_if<MoveTo>(&command))
+				{
+					current = start = resolve(move->point);
+					open = false;
+				}
+				else if (const LineTo* line = std::get_if<LineTo>(&command))
+				{
+					ensure_open();
+					current = resolve(line->point);
+					out.line_to(current);
+				}
+				else if (const CubicCurveTo* cubic = std::get_if<CubicCurveTo>(&command))
+				{
+					ensure_open();
+					const Point end = resolve(cubic->point);
+					flatten_cubic(current, resolve(cubic->control_start), resolve(cubic->control_end), end, tolerance, out.points);
+					out.ends.back() = out.points.size();
+					current = end;
+				}
+				else if (const QuadraticCurveTo* quadratic = std::get_if<QuadraticCurveTo>(&command))
+				{
+					ensure_open();
+					const Point end = resolve(quadratic->point);
+					flatten_quadratic(current, resolve(quadratic->control), end, tolerance, out.points);
+					out.ends.back() = out.points.size();
+					current = end;
+				}
+				else if (const EllipticalArcTo* arc = std::get_if<EllipticalArcTo>(&command))
+				{
+					ensure_open();
+					const Point end = resolve(arc->point);
+					flatten_arc(current, *arc, end, tolerance, out.points);
+					out.ends.back() = out.points.size();
+					current = end;
+				}
+				else if (std::holds_alternative<ClosePath>(command))
+				{
+					if (open) out.close();
+					current = start;
+					open = false;
+				}
+			}
+		}
+
+		/*
+		* \brief vertex of a path or polyline where markers are placed
+		*        in and out are the directions of the adjacent segments, zero if there is none
+		*/
+		struct MarkerVertex
+		{
+			Point point;
+			Point in, out;
+
+			/*
+			* \brief orientation of a marker with orient="auto": average of the in and out angle in radians
+			*/
+			double angle() const
+			{
+				const bool has_in = in.x != 0 || in.y != 0, has_out = out.x != 0 || out.y != 0;
+				if (!has_in && !has_out) return 0;
+				if (!has_in) return std::atan2(out.y, out.x);
+				if (!has_out) return std::atan2(in.y, in.x);
+
+				const double a = std::atan2(in.y, in.x), b = std::atan2(out.y, out.x);
+				return a + std::remainder(b - a, 2 * PI) / 2;
+			}
+		};
+
+		/*
+		* \brief marker vertices of a polyline. Closed polylines end with the closing vertex on the first point, like svg polygons
+		*/
+		inline void polyline_vertices(const Point* points, size_t count, bool closed, std::vector<MarkerVertex>& out)
+		{
+			out.clear();
+			for (size_t i = 0; i < count; i++)
+			{
+				MarkerVertex v;
+				v.point = points[i];
+				if (i > 0) v.in = Point{ points[i].x - points[i - 1].x, points[i].y - points[i - 1].y };
+				if (i + 1 < count) v.out = Point{ points[i + 1].x - points[i].x, points[i + 1].y - points[i].y };
+				else if (closed && count > 1) v.out = Point{ points[0].x - points[i].x, points[0].y - points[i].y };
+				out.push_back(v);
+			}
+			if (closed && count > 1) out.push_back(MarkerVertex{ points[0], out.back().out, Point() });
+		}
+
+		/*
+		* \brief marker vertices of a path: every command end point, curves contribute their end tangents
+		*/
+		inline void path_vertices(const Path& path, std::vector<MarkerVertex>& out)
+		{
+			out.clear();
+			Point current, start;
+
+			// first point different from from, curves with coinciding control points still get a direction
+			auto direction = [](const Point& from, std::initializer_list<Point> candidates)
+			{
+				for (const Point& p : candidates)
+				{
+					if (p.x != from.x || p.y != from.y) return Point{ p.x - from.x, p.y - from.y };
+				}
+				return Point();
+			};
+			auto add_segment = [&](const Point& next, const Point& start_direction, const Point& end_direction)
+			{
+				if (out.empty()) out.push_back(MarkerVertex{ current, Point(), Point() });
+				out.back().out = start_direction;
+				out.push_back(MarkerVertex{ next, end_direction, Point() });
+				current = next;
+			};
+
+			for (const PathSegment& command : path.commands)
+			{
+				const Point origin = is_relative(command) ? current : Point();
+				auto resolve = [&](const Point& p) { return Point{ p.x + origin.x, p.y + origin.y }; };
+
+				if (const MoveTo* move = std::get_if<MoveTo>(&command))
+				{
+					current = start = resolve(move->point);
+					out.push_back(MarkerVertex{ current, Point(), Point() });
+				}
+				else if (const LineTo* line = std::get_if<LineTo>(&command))
+				{
+					const Point next = resolve(line->point);
+					const Point d{ next.x - current.x, next.y - current.y };
+					add_segment(next, d, d);
+				}
+				else if (const CubicCurveTo* cubic = std::get_if<CubicCurveTo>(&command))
+				{
+					const Point p1 = resolve(cubic->control_start), p2 = resolve(cubic->control_end), next = resolve(cubic->point);
+					const Point end_out = direction(next, { p2, p1, current });
+					add_segment(next, direction(current, { p1, p2, next }), Point{ -end_out.x, -end_out.y });
+				}
+				else if (const QuadraticCurveTo* quadratic = std::get_if<QuadraticCurveTo>(&command))
+				{
+					const Point p1 = resolve(quadratic->control), next = resolve(quadratic->point);
+					const Point end_out = direction(next, { p1, current });
+					add_segment(next, direction(current, { p1, next }), Point{ -end_out.x, -end_out.y });
+				}
+				else if (const EllipticalArcTo* arc = std::get_if<EllipticalArcTo>(&command))
+				{
+					const Point next = resolve(arc->point);
+					Point d0{ next.x - current.x, next.y - current.y }, d1 = d0;
+
+					ArcCenter c;
+					if (arc_to_center(current, *arc, next, c))
+					{
+						// the tangent points along increasing angles, flip it for negative sweeps
+						const double sign = c.sweep_angle >= 0 ? 1 : -1;
+						const Point t0 = c.tangent(c.start_angle), t1 = c.tangent(c.start_angle + c.sweep_angle);
+						d0 = Point{ t0.x * sign, t0.y * sign };
+						d1 = Point{ t1.x * sign, t1.y * sign };
+					}
+					add_segment(next, d0, d1);
+				}
+				else if (std::holds_alternative<ClosePath>(command))
+				{
+					const Point closing{ start.x - current.x, start.y - current.y };
+					if (closing.x != 0 || closing.y != 0) add_segment(start, closing, closing);
+					current = start;
+				}
+			}
+		}
+
+		/*
+		* \brief clip closed polygons against an axis aligned rectangle (Sutherland-Hodgman)
+		*        Concave polygons may produce zero area bridges along the rectangle border, they don't change the nonzero fill
+		* \param ends: exclusive end index into points for every polygon, same for out_ends
+		*/
+		inline void clip_rectangle(const std::vector<Point>& points, const std::vector<size_t>& ends, const BoundingBox& rect, std::vector<Point>& out, std::vector<size_t>& out_ends)
+		{
+			out.clear();
+			out_ends.clear();
+			if (rect.empty()) return;
+
+			std::vector<Point> current, next;
+			size_t begin = 0;
+			for (size_t end : ends)
+			{
+				current.assign(points.begin() + begin, points.begin() + end);
+				begin = end;
+
+				// one pass per border: left, right, top, bottom
+				for (int border = 0; border < 4 && !current.empty(); border++)
+				{
+					auto inside = [&](const Point& p)
+					{
+						switch (border)
+						{
+						case 0: return p.x >= rect.x0;
+						case 1: return p.x <= rect.x1;
+						case 2: return p.y >= rect.y0;
+						default: return p.y <= rect.y1;
+						}
+					};
+					auto cut = [&](const Point& p, const Point& q)
+					{
+						const bool vertical = border < 2;
+						const double limit = border == 0 ? rect.x0 : border == 1 ? rect.x1 : border == 2 ? rect.y0 : rect.y1;
+						const double t = vertical ? (limit - p.x) / (q.x - p.x) : (limit - p.y) / (q.y - p.y);
+						return vertical ? Point{ limit, p.y + (q.y - p.y) * t } : Point{ p.x + (q.x - p.x) * t, limit };
+					};
+
+					next.clear();
+					for (size_t i = 0; i < current.size(); i++)
+					{
+						const Point& p = current[i];
+						const Point& q = current[(i + 1) % current.size()];
+						const bool p_in = inside(p), q_in = inside(q);
+
+						if (p_in) next.push_back(p);
+						if (p_in != q_in) next.push_back(cut(p, q));
+					}
+					current.swap(next);
+				}
+
+				if (current.size() < 3) continue;
+				out.insert(out.end(), current.begin(), current.end());
+				out_ends.push_back(out.size());
+			}
+		}
+
+		/*
+		* \brief intersection of two polygon sets, both interpreted with the nonzero rule
+		*
+		* - the plane is cut into horizontal scanbeams at every vertex and at every edge crossing, inside a beam no edges cross
+		* - in every beam the spans inside both sets become trapezoids, trapezoids between the same pair of edges are merged across beams
+		* - the result consists of equally oriented trapezoids, it must be filled with the nonzero rule
+		* - buffers are kept between calls
+		*/
+		class Clipper
+		{
+		public:
+			/*
+			* \param ends: exclusive end index into points for every polygon, same for out_ends
+			*/
+			void intersect(const std::vector<Point>& subject, const std::vector<size_t>& subject_ends,
+				const std::vector<Point>& clip, const std::vector<size_t>& clip_ends,
+				std::vector<Point>& out, std::vector<size_t>& out_ends)
+			{
+				out.clear();
+				out_ends.clear();
+
+				edges.clear();
+				add_edges(subject, subject_ends, false);
+				add_edges(clip, clip_ends, true);
+				if (edges.empty()) return;
+
+				// beam borders at all vertices
+				ys.clear();
+				for (const Edge& edge : edges)
+				{
+					ys.push_back(edge.y0);
+					ys.push_back(edge.y1);
+				}
+				std::sort(ys.begin(), ys.end());
+				ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+				std::sort(edges.begin(), edges.end(), [](const Edge& l, const Edge& r) { return l.y0 < r.y0; });
+
+				active.clear();
+				open.clear();
+				size_t next_edge = 0;
+
+				for (size_t k = 0; k + 1 < ys.size(); k++)
+				{
+					double top = ys[k];
+					const double bottom = ys[k + 1];
+
+					// edges ending at top leave, edges starting at top enter
+					active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t i) { return edges[i].y1 <= top; }), active.end());
+					while (next_edge < edges.size() && edges[next_edge].y0 <= top) active.push_back(static_cast<uint32_t>(next_edge++));
+
+					// split the beam at crossings until no edges cross inside the remaining part
+					while (top < bottom)
+					{
+						std::sort(active.begin(), active.end(), [&](uint32_t l, uint32_t r)
+						{
+							const double xl = edges[l].x_at(top), xr = edges[r].x_at(top);
+							return xl != xr ? xl < xr : edges[l].dxdy < edges[r].dxdy;
+						});
+
+						double end = bottom;
+						for (size_t i = 0; i + 1 < active.size(); i++)
+						{
+							const Edge& l = edges[active[i]];
+							const Edge& r = edges[active[i + 1]];
+							if (!(l.x_at(end) > r.x_at(end))) continue;
+
+							// l and r cross between top and end
+							const double crossing = top + (r.x_at(top) - l.x_at(top)) / (l.dxdy - r.dxdy);
+							end = std::clamp(crossing, top + MIN_BEAM, end);
+						}
+
+						emit_beam(top, end, out, out_ends);
+						top = end;
+					}
+				}
+
+				// close the trapezoids reaching the last beam
+				for (const Span& span : open) close_span(span, out, out_ends);
+				open.clear();
+			}
+
+		private:
+			// smallest beam height, guarantees progress for crossings close to the beam top
+			static constexpr double MIN_BEAM = 1e-9;
+
+			struct Edge
+			{
+				double x0, y0, y1;
+				double dxdy;
+				int winding;
+				bool clip;
+
+				double x_at(double y) const
+				{
+					return x0 + (y - y0) * dxdy;
+				}
+			};
+
+			// trapezoid under construction
+			struct Span
+			{
+				uint32_t left, right;
+				double top, bottom;
+			};
+
+			std::vector<Edge> edges;
+			std::vector<double> ys;
+			std::vector<uint32_t> active;
+			std::vector<Span> open, continued;
+
+			void add_edges(const std::vector<Point>& points, const std::vector<size_t>& ends, bool clip)
+			{
+				size_t begin = 0;
+				for (size_t end : ends)
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						const Point& p = points[i];
+						const Point& q = points[i + 1 < end ? i + 1 : begin];
+						if (p.y == q.y || !std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(q.x) || !std::isfinite(q.y)) continue;
+
+						const Point& upper = p.y < q.y ? p : q;
+						const Point& lower = p.y < q.y ? q : p;
+						edges.push_back(Edge{ upper.x, upper.y, lower.y, (lower.x - upper.x) / (lower.y - upper.y), p.y < q.y ? 1 : -1, clip });
+					}
+					begin = end;
+				}
+			}
+
+			/*
+			* \brief spans inside both sets for the beam [top, bottom], active is sorted and doesn't cross
+			*/
+			void emit_beam(double top, double bottom, std::vector<Point>& out, std::vector<size_t>& out_ends)
+			{
+				continued.clear();
+				size_t previous = 0;
+
+				int subject_winding = 0, clip_winding = 0;
+				uint32_t left = 0;
+				for (uint32_t index : active)
+				{
+					const Edge& edge = edges[index];
+					const bool was_inside = subject_winding != 0 && clip_winding != 0;
+					(edge.clip ? clip_winding : subject_winding) += edge.winding;
+					const bool is_inside = subject_winding != 0 && clip_winding != 0;
+
+					if (!was_inside && is_inside) left = index;
+					else if (was_inside && !is_inside)
+					{
+						// spans of both beams are ordered by x, a continued span is found by scanning forward
+						Span span{ left, index, top, bottom };
+						for (size_t i = previous; i < open.size(); i++)
+						{
+							if (open[i].left == left && open[i].right == index && open[i].bottom == top)
+							{
+								span.top = open[i].top;
+								open[i].bottom = -INFINITY;
+								previous = i + 1;
+								break;
+							}
+						}
+						continued.push_back(span);
+					}
+				}
+
+				for (const Span& span : open)
+				{
+					if (span.bottom != -INFINITY) close_span(span, out, out_ends);
+				}
+				open.swap(continued);
+			}
+
+			void close_span(const Span& span, std::vector<Point>& out, std::vector<size_t>& out_ends)
+			{
+				const Edge& l = edges[span.left];
+				const Edge& r = edges[span.right];
+
+				const Point corners[4] = { { l.x_at(span.top), span.top }, { r.x_at(span.top), span.top }, { r.x_at(span.bottom), span.bottom }, { l.x_at(span.bottom), span.bottom } };
+				if (corners[0].x >= corners[1].x && corners[3].x >= corners[2].x) return;
+
+				out.insert(out.end(), corners, corners + 4);
+				out_ends.push_back(out.size());
+			}
+		};
+	}
+}
@@ -0,0 +1,2444 @@
+#pragma once
+#include "DiagramGraphics.hpp"
+#include "DiagramGraphicsGeometry.hpp"
+#include "DiagramGraphicsText.hpp"
+#include "DiagramThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <tuple>
+#include <unordered_map>
+
+/*
+* CPU rasterizer for DG canvases
+* -> every drawable element is converted into DrawItems (flattened contours in pixel coordinates + paint)
+* -> the image is split into tiles, each tile composites all DrawItems touching it
+* -> tiles are distributed across the threads of ThreadPool::shared(), no GPU is needed
+* -> IncrementalRenderer caches the DrawItems and redraws only tiles whose content changed
+* -> the result can be written as PPM or PNG
+*
+* Anti-aliasing: every pixel row is sampled at SUBSAMPLES sub-scanlines, coverage along a sub-scanline is exact
+*/
+namespace DG
+{
+	namespace raster
+	{
+		enum class FillRule
+		{
+			nonzero,
+			evenodd
+		};
+
+		/*
+		* \brief color with premultiplied alpha, channels between [0 and 1]
+		*/
+		struct Rgba
+		{
+			float r = 0, g = 0, b = 0, a = 0;
+
+			static Rgba from(const Color& color, double opacity)
+			{
+				const float alpha = static_cast<float>(std::clamp(opacity, 0.0, 1.0));
+				return Rgba{ color.red / 255.f * alpha, color.green / 255.f * alpha, color.blue / 255.f * alpha, alpha };
+			}
+		};
+
+		/*
+		* \brief RGBA image, 8 bit per channel, premultiplied alpha, rows from top to bottom
+		*/
+		struct Image
+		{
+			int width = 0, height = 0;
+			std::vector<uint8_t> pixels;
+
+			Image() = default;
+
+			Image(int width, int height)
+				: width(width),
+				  height(height),
+				  pixels(static_cast<size_t>(width) * height * 4, 0)
+			{}
+
+			uint8_t* row(int y)
+			{
+				return pixels.data() + static_cast<size_t>(y) * width * 4;
+			}
+
+			const uint8_t* row(int y) const
+			{
+				return pixels.data() + static_cast<size_t>(y) * width * 4;
+			}
+		};
+
+		/*
+		* \brief color source of gradient and pattern fills, evaluated for runs of pixels
+		*/
+		class Shader
+		{
+		public:
+			virtual ~Shader() = default;
+
+			/*
+			* \brief premultiplied colors of the pixels [x, x + count) in row y, sampled at pixel centers
+			*/
+			virtual void shade(int x, int y, int count, Rgba* out) const = 0;
+		};
+
+		constexpr int GRADIENT_LUT_SIZE = 256;
+
+		/*
+		* \brief colors of a gradient sampled at GRADIENT_LUT_SIZE equidistant offsets, premultiplied, opacity applied
+		*/
+		struct GradientLut
+		{
+			Rgba colors[GRADIENT_LUT_SIZE];
+
+			const Rgba& at(double t) const
+			{
+				// pad spread: offsets outside [0, 1] use the first or last stop
+				const double index = std::clamp(t, 0.0, 1.0) * (GRADIENT_LUT_SIZE - 1) + 0.5;
+				return colors[static_cast<int>(index)];
+			}
+		};
+
+		/*
+		* \brief sample the stops of gradient. Offsets are clamped to [0, 1] and made ascending like in svg
+		*/
+		inline std::shared_ptr<const GradientLut> make_gradient_lut(const abstracts::Gradient& gradient, double opacity)
+		{
+			auto lut = std::make_shared<GradientLut>();
+			if (gradient.stops.empty()) return lut;
+
+			std::vector<double> offsets(gradient.stops.size());
+			std::vector<Rgba> colors(gradient.stops.size());
+			for (size_t i = 0; i < gradient.stops.size(); i++)
+			{
+				const GradientStop& stop = gradient.stops.at(i);
+				offsets.at(i) = std::clamp(stop.offset, i == 0 ? 0.0 : offsets.at(i - 1), 1.0);
+				colors.at(i) = Rgba::from(stop.color, stop.opacity * opacity);
+			}
+
+			// interpolation of premultiplied colors, transparent stops don't darken their neighbours
+			size_t segment = 0;
+			for (int i = 0; i < GRADIENT_LUT_SIZE; i++)
+			{
+				const double t = static_cast<double>(i) / (GRADIENT_LUT_SIZE - 1);
+				while (segment + 1 < offsets.size() && offsets.at(segment + 1) < t) segment++;
+
+				Rgba& out = lut->colors[i];
+				if (t <= offsets.front()) out = colors.front();
+				else if (segment + 1 >= offsets.size()) out = colors.back();
+				else
+				{
+					const double span = offsets.at(segment + 1) - offsets.at(segment);
+					const float w = span > 0 ? static_cast<float>((t - offsets.at(segment)) / span) : 1.f;
+					const Rgba& l = colors.at(segment);
+					const Rgba& r = colors.at(segment + 1);
+					out = Rgba{ l.r + (r.r - l.r) * w, l.g + (r.g - l.g) * w, l.b + (r.b - l.b) * w, l.a + (r.a - l.a) * w };
+				}
+			}
+			return lut;
+		}
+
+		namespace detail
+		{
+			// pixels per block of lut indices in the gradient shaders
+			constexpr int SHADE_BLOCK = 64;
+
+			/*
+			* \brief out[k] = index of start + step * (first + k), clamped to [0, max]
+			*/
+			inline void ramp_indices(double start, double step, int first, int count, double max, int32_t* out)
+			{
+				int k = 0;
+#if defined(DG_SIMD_AVX)
+				const __m256d start4 = _mm256_set1_pd(start), step4 = _mm256_set1_pd(step), max4 = _mm256_set1_pd(max), zero4 = _mm256_setzero_pd();
+				const __m256d four = _mm256_set1_pd(4);
+				__m256d i4 = _mm256_setr_pd(first, first + 1.0, first + 2.0, first + 3.0);
+
+				for (; k + 4 <= count; k += 4, i4 = _mm256_add_pd(i4, four))
+				{
+					const __m256d index = _mm256_min_pd(_mm256_max_pd(_mm256_add_pd(start4, _mm256_mul_pd(step4, i4)), zero4), max4);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), _mm256_cvttpd_epi32(index));
+				}
+#endif
+#if defined(DG_SIMD_SSE2)
+				const __m128d start2 = _mm_set1_pd(start), step2 = _mm_set1_pd(step), max2 = _mm_set1_pd(max), zero2 = _mm_setzero_pd();
+				const __m128d two = _mm_set1_pd(2);
+				__m128d i2 = _mm_setr_pd(first + static_cast<double>(k), first + k + 1.0);
+
+				for (; k + 2 <= count; k += 2, i2 = _mm_add_pd(i2, two))
+				{
+					const __m128d index = _mm_min_pd(_mm_max_pd(_mm_add_pd(start2, _mm_mul_pd(step2, i2)), zero2), max2);
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out + k), _mm_cvttpd_epi32(index));
+				}
+#endif
+				for (; k < count; k++) out[k] = static_cast<int32_t>(std::min(std::max(0.0, start + step * (first + k)), max));
+			}
+
+			/*
+			* \brief out[k] = lut index of the radial offset at d + (first + k) * dd, d is relative to the focus
+			*        The ray focus -> p hits the circle at focus + d * s, the offset is 1 / s
+			*/
+			inline void radial_indices(const Point& d, const Point& dd, const Point& to_center, double c_term, int first, int count, int32_t* out)
+			{
+				const double scale = GRADIENT_LUT_SIZE - 1;
+				int k = 0;
+#if defined(DG_SIMD_AVX)
+				const __m256d dx4 = _mm256_set1_pd(d.x), dy4 = _mm256_set1_pd(d.y), ddx4 = _mm256_set1_pd(dd.x), ddy4 = _mm256_set1_pd(dd.y);
+				const __m256d cx4 = _mm256_set1_pd(to_center.x), cy4 = _mm256_set1_pd(to_center.y), c4 = _mm256_set1_pd(c_term);
+				const __m256d zero4 = _mm256_setzero_pd(), one4 = _mm256_set1_pd(1), scale4 = _mm256_set1_pd(scale), half4 = _mm256_set1_pd(0.5);
+				const __m256d four = _mm256_set1_pd(4);
+				__m256d i4 = _mm256_setr_pd(first, first + 1.0, first + 2.0, first + 3.0);
+
+				for (; k + 4 <= count; k += 4, i4 = _mm256_add_pd(i4, four))
+				{
+					const __m256d x = _mm256_add_pd(dx4, _mm256_mul_pd(ddx4, i4));
+					const __m256d y = _mm256_add_pd(dy4, _mm256_mul_pd(ddy4, i4));
+					const __m256d length2 = _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+					const __m256d dc = _mm256_add_pd(_mm256_mul_pd(x, cx4), _mm256_mul_pd(y, cy4));
+					const __m256d root = _mm256_sqrt_pd(_mm256_max_pd(_mm256_sub_pd(_mm256_mul_pd(dc, dc), _mm256_mul_pd(length2, c4)), zero4));
+
+					// the focus itself has offset 0
+					const __m256d t = _mm256_and_pd(_mm256_cmp_pd(length2, zero4, _CMP_GT_OQ), _mm256_div_pd(length2, _mm256_add_pd(dc, root)));
+					const __m256d index = _mm256_add_pd(_mm256_mul_pd(_mm256_min_pd(_mm256_max_pd(t, zero4), one4), scale4), half4);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), _mm256_cvttpd_epi32(index));
+				}
+#endif
+#if defined(DG_SIMD_SSE2)
+				const __m128d dx2 = _mm_set1_pd(d.x), dy2 = _mm_set1_pd(d.y), ddx2 = _mm_set1_pd(dd.x), ddy2 = _mm_set1_pd(dd.y);
+				const __m128d cx2 = _mm_set1_pd(to_center.x), cy2 = _mm_set1_pd(to_center.y), c2 = _mm_set1_pd(c_term);
+				const __m128d zero2 = _mm_setzero_pd(), one2 = _mm_set1_pd(1), scale2 = _mm_set1_pd(scale), half2 = _mm_set1_pd(0.5);
+				const __m128d two = _mm_set1_pd(2);
+				__m128d i2 = _mm_setr_pd(first + static_cast<double>(k), first + k + 1.0);
+
+				for (; k + 2 <= count; k += 2, i2 = _mm_add_pd(i2, two))
+				{
+					const __m128d x = _mm_add_pd(dx2, _mm_mul_pd(ddx2, i2));
+					const __m128d y = _mm_add_pd(dy2, _mm_mul_pd(ddy2, i2));
+					const __m128d length2 = _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y));
+					const __m128d dc = _mm_add_pd(_mm_mul_pd(x, cx2), _mm_mul_pd(y, cy2));
+					const __m128d root = _mm_sqrt_pd(_mm_max_pd(_mm_sub_pd(_mm_mul_pd(dc, dc), _mm_mul_pd(length2, c2)), zero2));
+
+					const __m128d t = _mm_and_pd(_mm_cmpgt_pd(length2, zero2), _mm_div_pd(length2, _mm_add_pd(dc, root)));
+					const __m128d index = _mm_add_pd(_mm_mul_pd(_mm_min_pd(_mm_max_pd(t, zero2), one2), scale2), half2);
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out + k), _mm_cvttpd_epi32(index));
+				}
+#endif
+				for (; k < count; k++)
+				{
+					const double x = d.x + dd.x * (first + k), y = d.y + dd.y * (first + k);
+					const double length2 = x * x + y * y;
+					const double dc = x * to_center.x + y * to_center.y;
+					const double root = std::sqrt(std::max(dc * dc - length2 * c_term, 0.0));
+					const double t = length2 > 0 ? length2 / (dc + root) : 0;
+					out[k] = static_cast<int32_t>(std::min(std::max(0.0, t), 1.0) * scale + 0.5);
+				}
+			}
+		}
+
+		/*
+		* \brief linear gradient, the offset is an affine function of the pixel position
+		*        Lut indices are computed for blocks of pixels with SIMD, see detail::ramp_indices
+		*/
+		class LinearGradientShader : public Shader
+		{
+		public:
+			/*
+			* \param inverse: maps pixel coordinates to gradient coordinates
+			*/
+			LinearGradientShader(std::shared_ptr<const GradientLut> lut, const Matrix& inverse, const Point& from, const Point& to)
+				: lut(std::move(lut))
+			{
+				const double dx = to.x - from.x, dy = to.y - from.y;
+				const double length2 = dx * dx + dy * dy;
+
+				// svg: equal end points paint the last stop
+				if (!(length2 > 0))
+				{
+					offset_c = 1;
+					return;
+				}
+
+				// offset(p) = dot(inverse * p - from, to - from) / |to - from|^2
+				offset_x = (inverse.a * dx + inverse.b * dy) / length2;
+				offset_y = (inverse.c * dx + inverse.d * dy) / length2;
+				offset_c = ((inverse.e - from.x) * dx + (inverse.f - from.y) * dy) / length2;
+			}
+
+			void shade(int x, int y, int count, Rgba* out) const override
+			{
+				const GradientLut& table = *lut;
+				const double scale = GRADIENT_LUT_SIZE - 1;
+
+				// lut index as a linear function of i, no per pixel multiplications by the matrix
+				const double start = (offset_x * (x + 0.5) + offset_y * (y + 0.5) + offset_c) * scale + 0.5;
+				const double step = offset_x * scale;
+
+				int32_t indices[detail::SHADE_BLOCK];
+				for (int first = 0; first < count; first += detail::SHADE_BLOCK)
+				{
+					const int block = std::min(detail::SHADE_BLOCK, count - first);
+					detail::ramp_indices(start, step, first, block, scale, indices);
+					for (int k = 0; k < block; k++) out[first + k] = table.colors[indices[k]];
+				}
+			}
+
+		private:
+			std::shared_ptr<const GradientLut> lut;
+			double offset_x = 0, offset_y = 0, offset_c = 0;
+		};
+
+		/*
+		* \brief radial gradient with focal point. Offset 0 is at the focus, offset 1 on the circle
+		*        Lut indices are computed for blocks of pixels with SIMD, see detail::radial_indices
+		*/
+		class RadialGradientShader : public Shader
+		{
+		public:
+			/*
+			* \param inverse: maps pixel coordinates to gradient coordinates
+			*/
+			RadialGradientShader(std::shared_ptr<const GradientLut> lut, const Matrix& inverse, const Point& center, double radius, const Point& focus)
+				: lut(std::move(lut)),
+				  inverse(inverse),
+				  focus(focus),
+				  radius(radius)
+			{
+				// svg 1.1: a focus outside the circle is moved onto it, slightly inside to keep the equation solvable
+				const double fx = focus.x - center.x, fy = focus.y - center.y;
+				const double distance = std::hypot(fx, fy);
+				if (distance > radius * 0.999)
+				{
+					const double k = radius * 0.999 / distance;
+					this->focus = Point{ center.x + fx * k, center.y + fy * k };
+				}
+				to_center = Point{ center.x - this->focus.x, center.y - this->focus.y };
+				c_term = to_center.x * to_center.x + to_center.y * to_center.y - radius * radius;
+			}
+
+			void shade(int x, int y, int count, Rgba* out) const override
+			{
+				const GradientLut& table = *lut;
+				if (!(radius > 0))
+				{
+					std::fill(out, out + count, table.colors[GRADIENT_LUT_SIZE - 1]);
+					return;
+				}
+
+				// position relative to the focus, advanced by the first matrix column per pixel
+				const Point p = inverse * Point{ x + 0.5, y + 0.5 };
+				const Point d{ p.x - focus.x, p.y - focus.y };
+				const Point step{ inverse.a, inverse.b };
+
+				int32_t indices[detail::SHADE_BLOCK];
+				for (int first = 0; first < count; first += detail::SHADE_BLOCK)
+				{
+					const int block = std::min(detail::SHADE_BLOCK, count - first);
+					detail::radial_indices(d, step, to_center, c_term, first, block, indices);
+					for (int k = 0; k < block; k++) out[first + k] = table.colors[indices[k]];
+				}
+			}
+
+		private:
+			std::shared_ptr<const GradientLut> lut;
+			Matrix inverse;
+			Point focus;
+			Point to_center;
+			double radius;
+			double c_term;
+		};
+
+		/*
+		* \brief repeats a pre-rasterized tile, nearest neighbour sampling
+		*/
+		class PatternShader : public Shader
+		{
+		public:
+			/*
+			* \param inverse: maps pixel coordinates to pattern coordinates
+			* \param tile_bounds: area of one tile in pattern coordinates, rendered into tile
+			*/
+			PatternShader(std::shared_ptr<const Image> tile, const Matrix& inverse, const Bounds& tile_bounds, double opacity)
+				: tile(std::move(tile)),
+				  inverse(inverse),
+				  origin(tile_bounds.pos),
+				  size(tile_bounds.dim),
+				  opacity(static_cast<float>(std::clamp(opacity, 0.0, 1.0)))
+			{}
+
+			void shade(int x, int y, int count, Rgba* out) const override
+			{
+				const Image& image = *tile;
+				const double sx = image.width / size.width, sy = image.height / size.height;
+				const float scale = opacity / 255.f;
+
+				// texel position, advanced by the first matrix column per pixel
+				const Point p = inverse * Point{ x + 0.5, y + 0.5 };
+				double u = (p.x - origin.x) * sx, v = (p.y - origin.y) * sy;
+				const double du = inverse.a * sx, dv = inverse.b * sy;
+
+				for (int i = 0; i < count; i++, u += du, v += dv)
+				{
+					int tx = static_cast<int>(std::floor(u)) % image.width;
+					int ty = static_cast<int>(std::floor(v)) % image.height;
+					if (tx < 0) tx += image.width;
+					if (ty < 0) ty += image.height;
+
+					const uint8_t* texel = image.row(ty) + static_cast<size_t>(tx) * 4;
+					out[i] = Rgba{ texel[0] * scale, texel[1] * scale, texel[2] * scale, texel[3] * scale };
+				}
+			}
+
+		private:
+			std::shared_ptr<const Image> tile;
+			Matrix inverse;
+			Point origin;
+			Dimension size;
+			float opacity;
+		};
+
+		/*
+		* \brief how a DrawItem is colored
+		*/
+		struct Paint
+		{
+			Rgba color;
+
+			// replaces color if set (gradients, patterns)
+			std::shared_ptr<const Shader> shader;
+		};
+
+		/*
+		* \brief closed contours, all points are stored in one buffer
+		*/
+		struct Contours
+		{
+			std::vector<Point> points;
+
+			// one past the last point of each contour
+			std::vector<size_t> ends;
+
+			void end_contour()
+			{
+				const size_t begin = ends.empty() ? 0 : ends.back();
+				if (points.size() > begin) ends.push_back(points.size());
+			}
+
+			void append(const Point* contour, size_t count)
+			{
+				points.insert(points.end(), contour, contour + count);
+				end_contour();
+			}
+
+			void clear()
+			{
+				points.clear();
+				ends.clear();
+			}
+
+			bool empty() const
+			{
+				return ends.empty();
+			}
+		};
+
+		/*
+		* \brief non horizontal edge of a contour, y0 < y1
+		*/
+		struct Edge
+		{
+			double x0, y0, x1, y1;
+			double dxdy;
+			int winding;
+		};
+
+		/*
+		* \brief filled geometry in pixel coordinates ready to be rasterized
+		*/
+		struct DrawItem
+		{
+			std::vector<Edge> edges;
+			FillRule rule = FillRule::nonzero;
+			Paint paint;
+
+			// covered pixels, end exclusive
+			int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+			// edge indices per band of tile rows
+			int band_height = 0;
+			int first_band = 0;
+			std::vector<std::vector<uint32_t>> bands;
+
+			// precomputed coverage of [x0, x1) x [y0, y1), used instead of the edges if not empty (text)
+			std::vector<uint8_t> mask;
+		};
+
+		/*
+		* \brief settings of a render call
+		*/
+		struct RenderOptions
+		{
+			// size of the image in pixels
+			int width = 0, height = 0;
+
+			// maps canvas coordinates to pixel coordinates
+			Matrix view;
+
+			int tile_size = 64;
+
+			// upper limit of threads of the shared pool, 0: all of them (one per hardware thread)
+			unsigned threads = 0;
+
+			// maximum distance between curves and their flattened version in pixels
+			double tolerance = 0.25;
+
+			// fill the image with the canvas background first
+			bool draw_background = true;
+		};
+
+		// amount of sub-scanlines per pixel row
+		constexpr int SUBSAMPLES = 4;
+
+		namespace detail
+		{
+			constexpr double PI = 3.14159265358979323846;
+
+			/*
+			* \brief amount of segments needed to approximate a full circle with the given radius in pixels
+			*/
+			inline int circle_segments(double radius, double tolerance)
+			{
+				if (!(radius > tolerance)) return 8;
+
+				const double step = 2 * std::acos(1 - tolerance / radius);
+				return std::clamp(static_cast<int>(std::ceil(2 * PI / step)), 8, 4096);
+			}
+
+			/*
+			* \brief scale factor of a matrix, used to estimate sizes in pixels
+			*/
+			inline double matrix_scale(const Matrix& m)
+			{
+				return std::sqrt(std::abs(m.determinant()));
+			}
+
+			inline double signed_area(const Point* p, size_t count)
+			{
+				double area = 0;
+				for (size_t i = 0, j = count - 1; i < count; j = i++)
+				{
+					area += (p[j].x * p[i].y) - (p[i].x * p[j].y);
+				}
+				return area / 2;
+			}
+
+			/*
+			* \brief append a contour with positive orientation. Used for stroke pieces so they add up with the nonzero rule
+			*/
+			inline void append_oriented(Contours& out, std::initializer_list<Point> contour)
+			{
+				const size_t begin = out.points.size();
+				out.points.insert(out.points.end(), contour.begin(), contour.end());
+
+				if (signed_area(out.points.data() + begin, contour.size()) < 0)
+				{
+					std::reverse(out.points.begin() + begin, out.points.end());
+				}
+				out.end_contour();
+			}
+
+			inline void ellipse_points(const Point& center, double rx, double ry, int segments, std::vector<Point>& out)
+			{
+				for (int i = 0; i < segments; i++)
+				{
+					const double angle = 2 * PI * i / segments;
+					out.push_back(Point{ center.x + rx * std::cos(angle), center.y + ry * std::sin(angle) });
+				}
+			}
+
+			/*
+			* \brief outline of a rectangle, corners are rounded if radius > 0
+			*/
+			inline void rectangle_points(const Bounds& bounds, double radius, double scale, double tolerance, std::vector<Point>& out)
+			{
+				const double x0 = bounds.pos.x, y0 = bounds.pos.y;
+				const double x1 = x0 + bounds.dim.width, y1 = y0 + bounds.dim.height;
+
+				radius = std::min({ radius, bounds.dim.width / 2, bounds.dim.height / 2 });
+				if (!(radius > 0))
+				{
+					out.insert(out.end(), { Point{ x0, y0 }, Point{ x1, y0 }, Point{ x1, y1 }, Point{ x0, y1 } });
+					return;
+				}
+
+				const int quarter = std::max(2, circle_segments(radius * scale, tolerance) / 4);
+				const Point centers[4] = { { x1 - radius, y0 + radius }, { x1 - radius, y1 - radius }, { x0 + radius, y1 - radius }, { x0 + radius, y0 + radius } };
+
+				// clockwise in y-down coordinates, starting at the top right corner
+				for (int corner = 0; corner < 4; corner++)
+				{
+					for (int i = 0; i <= quarter; i++)
+					{
+						const double angle = PI * (corner - 1) / 2 + (PI / 2) * i / quarter;
+						out.push_back(Point{ centers[corner].x + radius * std::cos(angle), centers[corner].y + radius * std::sin(angle) });
+					}
+				}
+			}
+
+			/*
+			* \brief convert a polyline into stroke contours (one quad per segment, miter or bevel joins)
+			*        The contours are positively oriented and must be filled with FillRule::nonzero
+			*/
+			inline void stroke_polyline(const Point* points, size_t count, bool closed, double width, Contours& out)
+			{
+				const double hw = width / 2;
+				if (count < 2 || !(hw > 0)) return;
+
+				// drop repeated points
+				std::vector<Point> pts;
+				pts.reserve(count + 1);
+				for (size_t i = 0; i < count; i++)
+				{
+					if (pts.empty() || pts.back().x != points[i].x || pts.back().y != points[i].y) pts.push_back(points[i]);
+				}
+				if (closed && pts.size() > 2 && pts.front().x == pts.back().x && pts.front().y == pts.back().y) pts.pop_back();
+				if (pts.size() < 2) return;
+
+				const size_t segments = closed ? pts.size() : pts.size() - 1;
+
+				// unit normals of all segments
+				std::vector<Point> normals(segments);
+				for (size_t i = 0; i < segments; i++)
+				{
+					const Point& p = pts.at(i);
+					const Point& q = pts.at((i + 1) % pts.size());
+					const double length = std::hypot(q.x - p.x, q.y - p.y);
+					normals.at(i) = Point{ -(q.y - p.y) / length, (q.x - p.x) / length };
+				}
+
+				for (size_t i = 0; i < segments; i++)
+				{
+					const Point& p = pts.at(i);
+					const Point& q = pts.at((i + 1) % pts.size());
+					const Point n{ normals.at(i).x * hw, normals.at(i).y * hw };
+
+					append_oriented(out, { Point{ p.x + n.x, p.y + n.y }, Point{ q.x + n.x, q.y + n.y }, Point{ q.x - n.x, q.y - n.y }, Point{ p.x - n.x, p.y - n.y } });
+				}
+
+				// joins between segment i and i + 1
+				const size_t joins = closed ? segments : segments - 1;
+				for (size_t i = 0; i < joins; i++)
+				{
+					const Point& v = pts.at((i + 1) % pts.size());
+					const Point& u0 = normals.at(i);
+					const Point& u1 = normals.at((i + 1) % segments);
+
+					const Point mid{ u0.x + u1.x, u0.y + u1.y };
+					const double mid_length = std::hypot(mid.x, mid.y);
+
+					for (double side : { 1.0, -1.0 })
+					{
+						const Point a{ v.x + side * u0.x * hw, v.y + side * u0.y * hw };
+						const Point b{ v.x + side * u1.x * hw, v.y + side * u1.y * hw };
+
+						// miter length relative to the stroke width is 2 / mid_length
+						if (mid_length > 2 / STROKE_MITER_LIMIT)
+						{
+							const double miter = 2 * hw / (mid_length * mid_length);
+							const Point m{ v.x + side * mid.x * miter, v.y + side * mid.y * miter };
+							append_oriented(out, { v, a, m, b });
+						}
+						else
+						{
+							append_oriented(out, { v, a, b });
+						}
+					}
+				}
+			}
+
+			/*
+			* \brief split a polyline into dashes. dashes contains alternating dash and gap lengths
+			*/
+			inline void dash_polyline(const Point* points, size_t count, bool closed, const std::vector<double>& dashes, std::vector<std::vector<Point>>& out)
+			{
+				double total = 0;
+				for (double d : dashes) total += std::max(d, 0.0);
+
+				if (count < 2 || dashes.empty() || !(total > 0))
+				{
+					out.emplace_back(points, points + count);
+					if (closed && count > 0) out.back().push_back(points[0]);
+					return;
+				}
+
+				size_t dash_index = 0;
+				double dash_left = dashes.front();
+				bool drawing = true;
+				std::vector<Point> current{ points[0] };
+
+				const size_t segments = closed ? count : count - 1;
+				for (size_t i = 0; i < segments; i++)
+				{
+					Point p = points[i];
+					const Point& q = points[(i + 1) % count];
+					double length = std::hypot(q.x - p.x, q.y - p.y);
+
+					while (length > 0)
+					{
+						const double step = std::min(length, dash_left);
+						const double t = step / length;
+						p = Point{ p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
+						length -= step;
+						dash_left -= step;
+
+						if (drawing) current.push_back(p);
+
+						if (dash_left <= 0)
+						{
+							if (drawing && current.size() > 1) out.push_back(std::move(current));
+							current.clear();
+
+							drawing = !drawing;
+							dash_index = (dash_index + 1) % dashes.size();
+							dash_left = std::max(dashes.at(dash_index), 0.0);
+
+							if (drawing) current.push_back(p);
+						}
+					}
+				}
+				if (drawing && current.size() > 1) out.push_back(std::move(current));
+			}
+		}
+
+		/*
+		* \brief build a DrawItem from contours in pixel coordinates. Returns false if nothing would be visible
+		* \param band_height: height of the tile rows the item is rendered in
+		*/
+		inline bool make_item(const Contours& contours, FillRule rule, const Paint& paint, int width, int height, int band_height, DrawItem& out)
+		{
+			if (contours.empty() || (paint.shader == nullptr && paint.color.a <= 0)) return false;
+
+			out.edges.clear();
+			out.rule = rule;
+			out.paint = paint;
+
+			double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+			size_t begin = 0;
+			for (size_t end : contours.ends)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					const Point& p = contours.points.at(i);
+					const Point& q = contours.points.at(i + 1 < end ? i + 1 : begin);
+
+					if (!std::isfinite(p.x) || !std::isfinite(p.y)) return false;
+
+					min_x = std::min(min_x, p.x);
+					min_y = std::min(min_y, p.y);
+					max_x = std::max(max_x, p.x);
+					max_y = std::max(max_y, p.y);
+
+					if (p.y == q.y) continue;
+
+					Edge edge;
+					edge.winding = p.y < q.y ? 1 : -1;
+					if (p.y < q.y)
+					{
+						edge.x0 = p.x; edge.y0 = p.y; edge.x1 = q.x; edge.y1 = q.y;
+					}
+					else
+					{
+						edge.x0 = q.x; edge.y0 = q.y; edge.x1 = p.x; edge.y1 = p.y;
+					}
+					edge.dxdy = (edge.x1 - edge.x0) / (edge.y1 - edge.y0);
+					out.edges.push_back(edge);
+				}
+				begin = end;
+			}
+
+			out.x0 = std::max(0, static_cast<int>(std::floor(min_x)));
+			out.y0 = std::max(0, static_cast<int>(std::floor(min_y)));
+			out.x1 = std::min(width, static_cast<int>(std::ceil(max_x)) + 1);
+			out.y1 = std::min(height, static_cast<int>(std::ceil(max_y)) + 1);
+
+			if (out.edges.empty() || out.x0 >= out.x1 || out.y0 >= out.y1) return false;
+
+			// sort edges into bands of tile rows, so a tile only looks at edges crossing its rows
+			out.band_height = band_height;
+			out.first_band = out.y0 / band_height;
+			const int last_band = (out.y1 - 1) / band_height;
+
+			out.bands.assign(last_band - out.first_band + 1, {});
+			for (uint32_t i = 0; i < out.edges.size(); i++)
+			{
+				const Edge& edge = out.edges.at(i);
+				const int from = std::max(out.first_band, static_cast<int>(std::floor(edge.y0)) / band_height);
+				const int to = std::min(last_band, static_cast<int>(std::floor(edge.y1)) / band_height);
+
+				for (int band = from; band <= to; band++) out.bands.at(band - out.first_band).push_back(i);
+			}
+			return true;
+		}
+
+		/*
+		* \brief composites DrawItems into a tile buffer. One instance per thread, buffers are reused
+		*/
+		class TileRasterizer
+		{
+		public:
+			/*
+			* \brief fill item into the tile [tx0, tx1) x [ty0, ty1)
+			* \param tile: premultiplied float RGBA, row major with stride floats per row, origin at (tx0, ty0)
+			*/
+			void fill(const DrawItem& item, int tx0, int ty0, int tx1, int ty1, float* tile, int stride)
+			{
+				const int x0 = std::max(tx0, item.x0), x1 = std::min(tx1, item.x1);
+				const int y0 = std::max(ty0, item.y0), y1 = std::min(ty1, item.y1);
+				if (x0 >= x1 || y0 >= y1) return;
+
+				if (!item.mask.empty())
+				{
+					fill_mask(item, x0, y0, x1, y1, tile + static_cast<size_t>(y0 - ty0) * stride + static_cast<size_t>(x0 - tx0) * 4, stride);
+					return;
+				}
+
+				const int span = x1 - x0;
+				area.assign(span + 1, 0.f);
+				cover.assign(span + 1, 0.f);
+
+				constexpr float weight = 1.f / SUBSAMPLES;
+
+				for (int y = y0; y < y1; y++)
+				{
+					const int band = y / item.band_height - item.first_band;
+					if (band < 0 || band >= static_cast<int>(item.bands.size())) continue;
+					const std::vector<uint32_t>& band_edges = item.bands.at(band);
+
+					std::fill(area.begin(), area.end(), 0.f);
+					std::fill(cover.begin(), cover.end(), 0.f);
+					bool touched = false;
+
+					for (int s = 0; s < SUBSAMPLES; s++)
+					{
+						const double sy = y + (s + 0.5) / SUBSAMPLES;
+
+						crossings.clear();
+						for (uint32_t index : band_edges)
+						{
+							const Edge& edge = item.edges[index];
+							if (sy < edge.y0 || sy >= edge.y1) continue;
+
+							crossings.push_back({ edge.x0 + (sy - edge.y0) * edge.dxdy, edge.winding });
+						}
+						if (crossings.size() < 2) continue;
+
+						std::sort(crossings.begin(), crossings.end(), [](const Crossing& l, const Crossing& r) { return l.x < r.x; });
+
+						int winding = 0;
+						double span_start = 0;
+						for (const Crossing& crossing : crossings)
+						{
+							const bool was_inside = inside(winding, item.rule);
+							winding += crossing.winding;
+							const bool is_inside = inside(winding, item.rule);
+
+							if (!was_inside && is_inside) span_start = crossing.x;
+							else if (was_inside && !is_inside)
+							{
+								add_span(span_start - x0, crossing.x - x0, span, weight);
+								touched = true;
+							}
+						}
+					}
+					if (!touched) continue;
+
+					// composite the row
+					const Shader* shader = item.paint.shader.get();
+					if (shader != nullptr)
+					{
+						shaded.resize(span);
+						shader->shade(x0, y, span, shaded.data());
+					}
+
+					float* out = tile + static_cast<size_t>(y - ty0) * stride + static_cast<size_t>(x0 - tx0) * 4;
+					float accumulated = 0;
+
+					for (int i = 0; i < span; i++, out += 4)
+					{
+						accumulated += cover[i];
+						const float coverage = std::min(1.f, std::abs(accumulated + area[i]));
+						if (coverage <= 0) continue;
+
+						const Rgba& color = shader != nullptr ? shaded[i] : item.paint.color;
+						const float inv = 1.f - color.a * coverage;
+						out[0] = color.r * coverage + out[0] * inv;
+						out[1] = color.g * coverage + out[1] * inv;
+						out[2] = color.b * coverage + out[2] * inv;
+						out[3] = color.a * coverage + out[3] * inv;
+					}
+				}
+			}
+
+		private:
+			struct Crossing
+			{
+				double x;
+				int winding;
+			};
+
+			std::vector<Crossing> crossings;
+
+			// coverage of partially covered pixels
+			std::vector<float> area;
+			// coverage delta which applies to this pixel and all pixels to the right
+			std::vector<float> cover;
+
+			// colors of a shaded row
+			std::vector<Rgba> shaded;
+
+			void fill_mask(const DrawItem& item, int x0, int y0, int x1, int y1, float* out, int stride)
+			{
+				const Rgba& color = item.paint.color;
+				const int mask_stride = item.x1 - item.x0;
+
+				for (int y = y0; y < y1; y++, out += stride)
+				{
+					const uint8_t* coverage = item.mask.data() + static_cast<size_t>(y - item.y0) * mask_stride + (x0 - item.x0);
+					float* pixel = out;
+
+					for (int x = x0; x < x1; x++, pixel += 4)
+					{
+						if (*coverage == 0)
+						{
+							coverage++;
+							continue;
+						}
+						const float c = *coverage++ * (1.f / 255.f);
+
+						const float inv = 1.f - color.a * c;
+						pixel[0] = color.r * c + pixel[0] * inv;
+						pixel[1] = color.g * c + pixel[1] * inv;
+						pixel[2] = color.b * c + pixel[2] * inv;
+						pixel[3] = color.a * c + pixel[3] * inv;
+					}
+				}
+			}
+
+			static bool inside(int winding, FillRule rule)
+			{
+				return rule == FillRule::nonzero ? winding != 0 : (winding & 1) != 0;
+			}
+
+			/*
+			* \brief add the sub-scanline span [from, to) relative to the first pixel of the row
+			*/
+			void add_span(double from, double to, int span, float weight)
+			{
+				from = std::clamp(from, 0.0, static_cast<double>(span));
+				to = std::clamp(to, 0.0, static_cast<double>(span));
+				if (!(to > from)) return;
+
+				const int first = static_cast<int>(from);
+				const int last = static_cast<int>(to);
+
+				if (first == last)
+				{
+					area[first] += weight * static_cast<float>(to - from);
+					return;
+				}
+
+				area[first] += weight * static_cast<float>(first + 1 - from);
+				cover[first + 1] += weight;
+				cover[last] -= weight;
+				if (last < span) area[last] += weight * static_cast<float>(to - last);
+			}
+		};
+
+		/*
+		* \brief combined revision of element and all its members
+		*        Needed for clip paths: their members are never drawn, so their bounds stay dirty and changes don't reach the clip path
+		*/
+		inline uint64_t tree_revision(const abstracts::GraphicalElement& element)
+		{
+			uint64_t revision = element.revision();
+			if (const Group* group = dynamic_cast<const Group*>(&element))
+			{
+				for (const abstracts::GraphicalElement* member : group->members)
+				{
+					if (member != nullptr) revision = (revision ^ tree_revision(*member)) * 0x100000001b3ull;
+				}
+			}
+			return revision;
+		}
+
+		/*
+		* \brief revision of fill and, for patterns, of the tile content
+		*/
+		inline uint64_t fill_revision(const abstracts::Fill& fill)
+		{
+			uint64_t revision = fill.revision();
+			if (const Pattern* pattern = dynamic_cast<const Pattern*>(&fill))
+			{
+				if (pattern->tile != nullptr) revision = (revision ^ tree_revision(*pattern->tile)) * 0x100000001b3ull;
+			}
+			return revision;
+		}
+
+		/*
+		* \brief converts DG elements into DrawItems
+		*/
+		class ItemBuilder
+		{
+		public:
+			ItemBuilder(const RenderOptions& options)
+				: options(options)
+			{}
+
+			/*
+			* \brief append the items of element and its members, in drawing order
+			*/
+			void collect(const abstracts::GraphicalElement& element, std::vector<DrawItem>& out)
+			{
+				if (!visible(element)) return;
+
+				const Group* group = dynamic_cast<const Group*>(&element);
+				if (group != nullptr)
+				{
+					// elements appearing earlier in the container are drawn above elements appearing later
+					for (auto it = group->members.rbegin(); it != group->members.rend(); it++)
+					{
+						if (*it != nullptr) collect(**it, out);
+					}
+					return;
+				}
+
+				build(element, out);
+			}
+
+			/*
+			* \brief append the item painting the whole image with canvas.f_background, if set
+			*/
+			void background(const Canvas& canvas, std::vector<DrawItem>& out)
+			{
+				if (canvas.f_background == nullptr || options.view.determinant() == 0) return;
+
+				const Point corners[4] = { { 0, 0 }, { static_cast<double>(options.width), 0 }, { static_cast<double>(options.width), static_cast<double>(options.height) }, { 0, static_cast<double>(options.height) } };
+
+				// like the 100% rectangle in svg, the bounding box is the visible area in canvas coordinates
+				const Matrix inverse = options.view.inverse();
+				BoundingBox box;
+				for (const Point& corner : corners) box.add(inverse * corner);
+
+				Paint paint;
+				if (!fill_paint(*canvas.f_background, options.view, box, 1.0, paint)) return;
+
+				contours.clear();
+				contours.append(corners, 4);
+				push_item(contours, FillRule::nonzero, paint, out);
+			}
+
+			/*
+			* \brief forget cached gradient tables, pattern tiles, clip regions and marker sprites
+			*/
+			void clear_caches()
+			{
+				gradient_luts.clear();
+				pattern_tiles.clear();
+				clip_regions.clear();
+				marker_sprites.clear();
+			}
+
+			/*
+			* \brief false if element and its members can't produce any pixel
+			*/
+			bool visible(const abstracts::GraphicalElement& element) const
+			{
+				// ClipPaths and Markers are only drawn where they are referenced
+				if (!element.is_drawn()) return false;
+
+				// offscreen content is skipped
+				BoundingBox viewport;
+				viewport.add(Point{ 0, 0 });
+				viewport.add(Point{ static_cast<double>(options.width), static_cast<double>(options.height) });
+				return DG::detail::transform_box(options.view, element.world_bounds()).intersects(viewport);
+			}
+
+			/*
+			* \brief append the items of a single element, members of groups are ignored
+			*/
+			void build(const abstracts::GraphicalElement& element, std::vector<DrawItem>& out)
+			{
+				// clip paths of the element and its owners, before the geometry buffers are filled
+				if (!collect_clips(element)) return;
+
+				const Matrix device = options.view * element.world_matrix();
+				const double scale = detail::matrix_scale(device);
+
+				if (const Text* text = dynamic_cast<const Text*>(&element))
+				{
+					build_text(*text, device, scale, out);
+					return;
+				}
+
+				bool fillable = true;
+				if (!shape_polylines(element, scale, fillable)) return;
+
+				add_shape(element.resolved_style(), device, fillable, out);
+
+				if (const abstracts::MarkedElement* marked = dynamic_cast<const abstracts::MarkedElement*>(&element))
+				{
+					add_markers(*marked, device, scale, out);
+				}
+			}
+
+		private:
+			const RenderOptions& options;
+
+			// geometry of the current element in local coordinates
+			std::vector<std::vector<Point>> polylines;
+			std::vector<bool> closed;
+
+			// reused buffers
+			Contours contours;
+			std::vector<std::vector<Point>> dashed;
+			geometry::FlatPath flat;
+			text::TextLayout text_layout;
+
+			// glyphs are kept between elements and between updates of an IncrementalRenderer
+			text::GlyphCache glyphs;
+
+			struct PlacedGlyph
+			{
+				uint32_t codepoint;
+				int x, y;
+			};
+
+			// underline and strike through, pixel rectangle
+			struct Decoration
+			{
+				int x0, y0, x1, y1;
+			};
+
+			std::vector<PlacedGlyph> placed;
+			std::vector<Decoration> decorations;
+
+			// fills are shared by many elements, their tables and tiles are built once
+			/*
+			* \brief gradient table or pattern tile together with the fill_revision it was built for
+			*/
+			template<typename T>
+			struct FillCache
+			{
+				uint64_t revision = 0;
+				std::shared_ptr<const T> value;
+			};
+
+			// per gradient and opacity, per pattern and tile size in pixels
+			std::map<std::pair<const abstracts::Gradient*, double>, FillCache<GradientLut>> gradient_luts;
+			std::map<std::tuple<const Pattern*, int, int>, FillCache<Image>> pattern_tiles;
+
+			// nesting of pattern tiles, protects against patterns containing themselves
+			int depth = 0;
+			static constexpr int MAX_PATTERN_DEPTH = 4;
+
+			/*
+			* \brief union of the members of a ClipPath in pixel coordinates
+			*/
+			struct ClipRegion
+			{
+				// state the region was built for
+				uint64_t revision = 0;
+				Matrix device;
+				bool valid = false;
+
+				Contours contours;
+				BoundingBox box;
+
+				// single axis aligned rectangle, clipped with Sutherland-Hodgman
+				bool rectangle = false;
+			};
+
+			// per clip path and referencing element, elements sharing a ClipPath usually have different transforms
+			std::map<std::pair<const ClipPath*, const abstracts::GraphicalElement*>, ClipRegion> clip_regions;
+
+			// regions applying to the current element, innermost first
+			std::vector<const ClipRegion*> clips;
+
+			geometry::Clipper clipper;
+			Contours clipped[2];
+
+			/*
+			* \brief flattened and stroked geometry of a marker, placed on every vertex by transforming its points
+			*/
+			struct MarkerPart
+			{
+				Contours contours;
+				FillRule rule;
+				Paint paint;
+			};
+
+			struct MarkerSprite
+			{
+				uint64_t revision = 0;
+				bool valid = false;
+				std::vector<MarkerPart> parts;
+			};
+
+			// per marker and power of two of the scale, the flattening tolerance depends on the size in pixels
+			std::map<std::pair<const Marker*, int>, MarkerSprite> marker_sprites;
+
+			// set while a sprite is built, push_item collects into it
+			std::vector<MarkerPart>* capture = nullptr;
+
+			std::vector<geometry::MarkerVertex> marker_vertices;
+			Contours instance;
+
+			/*
+			* \brief find the clip regions of element and its owners. Returns false if everything is clipped away
+			*/
+			bool collect_clips(const abstracts::GraphicalElement& element)
+			{
+				clips.clear();
+				for (const abstracts::GraphicalElement* e = &element; e != nullptr; e = e->owner)
+				{
+					if (e->mask == nullptr) continue;
+
+					// clip paths are defined in the user space of the referencing element
+					const ClipRegion& region = clip_region(*e->mask, *e, options.view * e->world_matrix());
+					if (region.contours.empty()) return false;
+					clips.push_back(&region);
+				}
+				return true;
+			}
+
+			const ClipRegion& clip_region(const ClipPath& clip, const abstracts::GraphicalElement& user, const Matrix& device)
+			{
+				ClipRegion& region = clip_regions[{ &clip, &user }];
+				const uint64_t revision = tree_revision(clip);
+				if (region.valid && region.revision == revision && region.device == device) return region;
+
+				region.revision = revision;
+				region.device = device;
+				region.valid = true;
+				region.contours.clear();
+				region.box = BoundingBox();
+
+				add_clip_geometry(clip, device * clip.local_matrix(), region.contours);
+				for (const Point& p : region.contours.points) region.box.add(p);
+
+				// axis aligned rectangle: 4 points, edges alternate between horizontal and vertical
+				const std::vector<Point>& p = region.contours.points;
+				region.rectangle = region.contours.ends.size() == 1 && p.size() == 4
+					&& ((p[0].y == p[1].y && p[1].x == p[2].x && p[2].y == p[3].y && p[3].x == p[0].x)
+						|| (p[0].x == p[1].x && p[1].y == p[2].y && p[2].x == p[3].x && p[3].y == p[0].y));
+				return region;
+			}
+
+			/*
+			* \brief append the fill geometry of the members of group, transformed by matrix
+			*/
+			void add_clip_geometry(const Group& group, const Matrix& matrix, Contours& out)
+			{
+				for (const abstracts::GraphicalElement* member : group.members)
+				{
+					if (member == nullptr) continue;
+					const Matrix m = matrix * member->local_matrix();
+
+					if (const Group* nested = dynamic_cast<const Group*>(member))
+					{
+						add_clip_geometry(*nested, m, out);
+						continue;
+					}
+
+					bool fillable = true;
+					if (!shape_polylines(*member, detail::matrix_scale(m), fillable) || !fillable) continue;
+
+					for (const std::vector<Point>& polyline : polylines)
+					{
+						if (polyline.size() < 3) continue;
+
+						const size_t begin = out.points.size();
+						out.append(polyline.data(), polyline.size());
+						m.transform(out.points.data() + begin, out.points.size() - begin);
+					}
+				}
+			}
+
+			/*
+			* \brief clear the coverage of a text item outside the clip regions
+			*/
+			void clip_mask(DrawItem& item)
+			{
+				const int width = item.x1 - item.x0, height = item.y1 - item.y0;
+
+				for (const ClipRegion* region : clips)
+				{
+					std::vector<float> coverage(static_cast<size_t>(width) * height * 4, 0.f);
+
+					DrawItem shape;
+					if (make_item(region->contours, FillRule::nonzero, Paint{ Rgba{ 1, 1, 1, 1 }, nullptr }, options.width, options.height, options.tile_size, shape))
+					{
+						TileRasterizer rasterizer;
+						rasterizer.fill(shape, item.x0, item.y0, item.x1, item.y1, coverage.data(), width * 4);
+					}
+
+					for (size_t i = 0; i < item.mask.size(); i++) item.mask[i] = static_cast<uint8_t>(item.mask[i] * coverage[i * 4 + 3] + 0.5f);
+				}
+			}
+
+			/*
+			* \brief place the markers of element on its vertices, oriented like svg orient="auto"
+			*/
+			void add_markers(const abstracts::MarkedElement& element, const Matrix& device, double scale, std::vector<DrawItem>& out)
+			{
+				if (element.start == nullptr && element.mid == nullptr && element.end == nullptr) return;
+
+				if (const Path* path = dynamic_cast<const Path*>(&element))
+				{
+					geometry::path_vertices(*path, marker_vertices);
+				}
+				else if (const Line* line = dynamic_cast<const Line*>(&element))
+				{
+					const Point points[2] = { line->start, line->end };
+					geometry::polyline_vertices(points, 2, false, marker_vertices);
+				}
+				else if (const Polygon* polygon = dynamic_cast<const Polygon*>(&element))
+				{
+					geometry::polyline_vertices(polygon->points.data(), polygon->points.size(), true, marker_vertices);
+				}
+				else if (const PolyLine* polyline = dynamic_cast<const PolyLine*>(&element))
+				{
+					geometry::polyline_vertices(polyline->points.data(), polyline->points.size(), false, marker_vertices);
+				}
+				else
+				{
+					return;
+				}
+				if (marker_vertices.empty()) return;
+
+				auto place = [&](const Marker* marker, const geometry::MarkerVertex& vertex)
+				{
+					if (marker == nullptr) return;
+
+					// building the sprite reuses the geometry buffers, vertices are kept in their own buffer
+					const MarkerSprite& sprite = marker_sprite(*marker, scale);
+					if (sprite.parts.empty()) return;
+
+					constexpr double DEGREES = 180.0 / 3.14159265358979323846;
+					const Matrix m = device * Matrix::translation(vertex.point.x, vertex.point.y) * Matrix::rotation(vertex.angle() * DEGREES)
+						* Matrix::translation(-marker->reference.x, -marker->reference.y);
+
+					for (const MarkerPart& part : sprite.parts)
+					{
+						instance.points = part.contours.points;
+						instance.ends = part.contours.ends;
+						m.transform(instance.points);
+						push_item(instance, part.rule, part.paint, out);
+					}
+				};
+
+				place(element.start, marker_vertices.front());
+				for (size_t i = 1; i + 1 < marker_vertices.size(); i++) place(element.mid, marker_vertices.at(i));
+				place(element.end, marker_vertices.back());
+			}
+
+			/*
+			* \brief geometry of marker, flattened for scale pixels per unit and cached until the marker or its members change
+			*        The transforms of the marker itself are ignored like in svg, members keep theirs
+			*/
+			const MarkerSprite& marker_sprite(const Marker& marker, double scale)
+			{
+				const int bucket = static_cast<int>(std::ceil(std::log2(std::max(scale, 1e-6))));
+				MarkerSprite& sprite = marker_sprites[{ &marker, bucket }];
+
+				const uint64_t revision = tree_revision(marker);
+				if (sprite.valid && sprite.revision == revision) return sprite;
+
+				sprite.revision = revision;
+				sprite.valid = true;
+				sprite.parts.clear();
+
+				std::vector<DrawItem> unused;
+				capture = &sprite.parts;
+				add_marker_geometry(marker, Matrix(), std::ldexp(1.0, bucket), unused);
+				capture = nullptr;
+				return sprite;
+			}
+
+			void add_marker_geometry(const Group& group, const Matrix& matrix, double scale, std::vector<DrawItem>& out)
+			{
+				for (const abstracts::GraphicalElement* member : group.members)
+				{
+					if (member == nullptr || !member->is_drawn()) continue;
+					const Matrix m = matrix * member->local_matrix();
+
+					if (const Group* nested = dynamic_cast<const Group*>(member))
+					{
+						add_marker_geometry(*nested, m, scale, out);
+						continue;
+					}
+
+					// text has no outline and is not part of sprites
+					bool fillable = true;
+					if (!shape_polylines(*member, scale * detail::matrix_scale(m), fillable)) continue;
+					add_shape(member->resolved_style(), m, fillable, out);
+				}
+			}
+
+			/*
+			* \brief shader of fill for an element drawn with device. Returns false if nothing is painted
+			* \param box: bounding box of the element geometry in local coordinates
+			*/
+			bool fill_paint(const abstracts::Fill& fill, const Matrix& device, const BoundingBox& box, double opacity, Paint& out)
+			{
+				if (const abstracts::Gradient* gradient = dynamic_cast<const abstracts::Gradient*>(&fill))
+				{
+					// svg: gradients relative to an empty bounding box paint nothing
+					if (gradient->stops.empty() || !(box.x1 > box.x0) || !(box.y1 > box.y0)) return false;
+
+					const Matrix to_device = device * Matrix::translation(box.x0, box.y0) * Matrix::scaling(box.x1 - box.x0, box.y1 - box.y0) * fill.matrix();
+					if (to_device.determinant() == 0) return false;
+
+					FillCache<GradientLut>& cached = gradient_luts[{ gradient, opacity }];
+					if (cached.value == nullptr || cached.revision != gradient->revision())
+					{
+						cached.revision = gradient->revision();
+						cached.value = make_gradient_lut(*gradient, opacity);
+					}
+					const std::shared_ptr<const GradientLut>& lut = cached.value;
+
+					if (const LinearGradient* linear = dynamic_cast<const LinearGradient*>(gradient))
+					{
+						out.shader = std::make_shared<LinearGradientShader>(lut, to_device.inverse(), Point{ linear->x1, linear->y1 }, Point{ linear->x2, linear->y2 });
+						return true;
+					}
+					if (const RadialGradient* radial = dynamic_cast<const RadialGradient*>(gradient))
+					{
+						out.shader = std::make_shared<RadialGradientShader>(lut, to_device.inverse(), Point{ radial->x_center, radial->y_center }, radial->radius, Point{ radial->x_focus, radial->y_focus });
+						return true;
+					}
+					return false;
+				}
+
+				if (const Pattern* pattern = dynamic_cast<const Pattern*>(&fill))
+				{
+					// pattern coordinates are the local coordinates of the element
+					const Matrix to_device = device * fill.matrix();
+					if (!(pattern->bounds.dim.width > 0) || !(pattern->bounds.dim.height > 0) || to_device.determinant() == 0) return false;
+
+					std::shared_ptr<const Image> tile = pattern_tile(*pattern, detail::matrix_scale(to_device));
+					if (tile == nullptr) return false;
+
+					out.shader = std::make_shared<PatternShader>(tile, to_device.inverse(), pattern->bounds, opacity);
+					return true;
+				}
+				return false;
+			}
+
+			std::shared_ptr<const Image> pattern_tile(const Pattern& pattern, double scale);
+
+			/*
+			* \brief outline of a shape in local coordinates into polylines. False for elements without outline (Text, Groups)
+			* \param scale: pixels per local unit, controls the flattening
+			* \param fillable: set to false for lines
+			*/
+			bool shape_polylines(const abstracts::GraphicalElement& element, double scale, bool& fillable)
+			{
+				polylines.clear();
+				closed.clear();
+
+				if (const Rectangle* rect = dynamic_cast<const Rectangle*>(&element))
+				{
+					begin_polyline(true);
+					detail::rectangle_points(rect->bounds, rect->corner_radius, scale, options.tolerance, polylines.back());
+				}
+				else if (const Circle* circle = dynamic_cast<const Circle*>(&element))
+				{
+					begin_polyline(true);
+					detail::ellipse_points(circle->center, circle->radius, circle->radius, detail::circle_segments(circle->radius * scale, options.tolerance), polylines.back());
+				}
+				else if (const Line* line = dynamic_cast<const Line*>(&element))
+				{
+					begin_polyline(false);
+					polylines.back() = { line->start, line->end };
+					fillable = false;
+				}
+				else if (const Polygon* polygon = dynamic_cast<const Polygon*>(&element))
+				{
+					begin_polyline(true);
+					polylines.back() = polygon->points;
+				}
+				else if (const PolyLine* polyline = dynamic_cast<const PolyLine*>(&element))
+				{
+					begin_polyline(false);
+					polylines.back() = polyline->points;
+				}
+				else if (const Path* path = dynamic_cast<const Path*>(&element))
+				{
+					path_polylines(*path, options.tolerance / std::max(scale, 1e-12));
+				}
+				else
+				{
+					return false;
+				}
+				return true;
+			}
+
+			/*
+			* \brief append fill and stroke of the polylines, style of the element they belong to
+			*/
+			void add_shape(const ResolvedStyle& style, const Matrix& device, bool fillable, std::vector<DrawItem>& out)
+			{
+				// fill, open polylines are closed implicitly like in svg
+				if (fillable && style.has_fill())
+				{
+					Paint paint{ Rgba::from(style.fill_color, style.fill_opacity), nullptr };
+					bool paintable = true;
+
+					// a Fill wins over the fill color. Marker sprites have no device yet, they keep the fill color
+					if (style.fill != nullptr && capture == nullptr)
+					{
+						// bounding box of the geometry without stroke, gradient coordinates are relative to it
+						BoundingBox box;
+						for (const std::vector<Point>& polyline : polylines)
+						{
+							for (const Point& p : polyline) box.add(p);
+						}
+						paintable = fill_paint(*style.fill, device, box, style.fill_opacity, paint);
+					}
+
+					if (paintable)
+					{
+						contours.clear();
+						for (const std::vector<Point>& polyline : polylines)
+						{
+							if (polyline.size() >= 3) contours.append(polyline.data(), polyline.size());
+						}
+						device.transform(contours.points);
+						push_item(contours, FillRule::nonzero, paint, out);
+					}
+				}
+
+				// stroke
+				const double stroke_width = style.stroke_width;
+				if (style.has_stroke && stroke_width > 0)
+				{
+					const std::vector<double>* dashes = style.dashes;
+
+					contours.clear();
+					for (size_t i = 0; i < polylines.size(); i++)
+					{
+						const std::vector<Point>& polyline = polylines.at(i);
+
+						if (dashes != nullptr && !dashes->empty())
+						{
+							dashed.clear();
+							detail::dash_polyline(polyline.data(), polyline.size(), closed.at(i), *dashes, dashed);
+							for (const std::vector<Point>& dash : dashed) detail::stroke_polyline(dash.data(), dash.size(), false, stroke_width, contours);
+						}
+						else
+						{
+							detail::stroke_polyline(polyline.data(), polyline.size(), closed.at(i), stroke_width, contours);
+						}
+					}
+
+					// stroke outlines are built in local coordinates, so the stroke width scales with the element
+					device.transform(contours.points);
+					push_item(contours, FillRule::nonzero, Paint{ Rgba::from(style.stroke_color, style.stroke_opacity), nullptr }, out);
+				}
+			}
+
+			void begin_polyline(bool is_closed)
+			{
+				polylines.emplace_back();
+				closed.push_back(is_closed);
+			}
+
+			void push_item(const Contours& item_contours, FillRule rule, const Paint& paint, std::vector<DrawItem>& out)
+			{
+				// building a marker sprite, the geometry is kept in marker coordinates
+				if (capture != nullptr)
+				{
+					capture->push_back(MarkerPart{ item_contours, rule, paint });
+					return;
+				}
+
+				const Contours* source = &item_contours;
+
+				// clip the flattened geometry, the rasterizer only sees the visible part
+				for (const ClipRegion* region : clips)
+				{
+					BoundingBox box;
+					for (const Point& p : source->points) box.add(p);
+
+					// inside a rectangle nothing changes
+					if (region->rectangle && region->box.contains(box)) continue;
+
+					Contours& target = source == &clipped[0] ? clipped[1] : clipped[0];
+					if (!region->box.intersects(box))
+					{
+						return;
+					}
+					if (region->rectangle)
+					{
+						geometry::clip_rectangle(source->points, source->ends, region->box, target.points, target.ends);
+					}
+					else
+					{
+						// the trapezoids of the clipper are filled with the nonzero rule
+						clipper.intersect(source->points, source->ends, region->contours.points, region->contours.ends, target.points, target.ends);
+						rule = FillRule::nonzero;
+					}
+					source = &target;
+				}
+
+				DrawItem item;
+				if (make_item(*source, rule, paint, options.width, options.height, options.tile_size, item)) out.push_back(std::move(item));
+			}
+
+			/*
+			* \brief lay out text and composite its glyphs into one coverage mask
+			*        Glyphs are placed on whole pixels and follow translation and scale of device, rotation is ignored
+			*/
+			void build_text(const Text& text, const Matrix& device, double scale, std::vector<DrawItem>& out)
+			{
+				const ResolvedStyle& style = text.resolved_style();
+				text::layout(text.data, text.bounds, text.alignment, style.font_size, text.wrap, text_layout);
+
+				const double pixel_size = style.font_size * scale;
+				if (text_layout.lines.empty() || !(pixel_size > 0)) return;
+
+				// pen positions of all glyphs, the mask covers their union
+				placed.clear();
+				decorations.clear();
+
+				int x0 = options.width, y0 = options.height, x1 = 0, y1 = 0;
+				auto cover = [&](int left, int top, int right, int bottom)
+				{
+					x0 = std::min(x0, left); y0 = std::min(y0, top);
+					x1 = std::max(x1, right); y1 = std::max(y1, bottom);
+				};
+
+				const int line_thickness = std::max(1, static_cast<int>(std::lround(pixel_size * text::UNIT * 0.7)));
+				for (const text::LayoutLine& line : text_layout.lines)
+				{
+					const Point origin = device * line.origin;
+					const int baseline = static_cast<int>(std::lround(origin.y));
+					double pen = origin.x;
+
+					for (size_t i = line.begin; i < line.end;)
+					{
+						const uint32_t codepoint = text::next_codepoint(text.data, i);
+						const text::GlyphBitmap& glyph = glyphs.get(codepoint, pixel_size, style.bold, style.italic);
+
+						const int x = static_cast<int>(std::lround(pen));
+						if (!glyph.coverage.empty())
+						{
+							placed.push_back({ codepoint, x, baseline });
+							cover(x + glyph.left, baseline + glyph.top, x + glyph.left + glyph.width, baseline + glyph.top + glyph.height);
+						}
+						pen += glyph.advance;
+					}
+
+					const int left = static_cast<int>(std::lround(origin.x));
+					const int right = static_cast<int>(std::lround(origin.x + line.width * scale));
+					if (right <= left) continue;
+
+					if (style.underline)
+					{
+						const int y = baseline + static_cast<int>(std::lround(pixel_size * text::UNIT));
+						decorations.push_back({ left, y, right, y + line_thickness });
+					}
+					if (style.strike_through)
+					{
+						const int y = baseline - static_cast<int>(std::lround(pixel_size * text::UNIT * 3.5));
+						decorations.push_back({ left, y, right, y + line_thickness });
+					}
+				}
+				for (const Decoration& d : decorations) cover(d.x0, d.y0, d.x1, d.y1);
+
+				DrawItem item;
+				item.x0 = std::max(0, x0); item.y0 = std::max(0, y0);
+				item.x1 = std::min(options.width, x1); item.y1 = std::min(options.height, y1);
+				if (item.x0 >= item.x1 || item.y0 >= item.y1) return;
+
+				const int stride = item.x1 - item.x0;
+				item.mask.assign(static_cast<size_t>(stride) * (item.y1 - item.y0), 0);
+				item.paint = Paint{ Rgba::from(style.font_color, 1.0), nullptr };
+
+				auto blit = [&](const uint8_t* coverage, int width, int height, int left, int top)
+				{
+					for (int y = std::max(top, item.y0); y < std::min(top + height, item.y1); y++)
+					{
+						uint8_t* dst = item.mask.data() + static_cast<size_t>(y - item.y0) * stride;
+						const uint8_t* src = coverage != nullptr ? coverage + static_cast<size_t>(y - top) * width : nullptr;
+
+						for (int x = std::max(left, item.x0); x < std::min(left + width, item.x1); x++)
+						{
+							// overlapping glyphs of italic text must not add up
+							const uint8_t value = src != nullptr ? src[x - left] : 255;
+							dst[x - item.x0] = std::max(dst[x - item.x0], value);
+						}
+					}
+				};
+
+				for (const PlacedGlyph& p : placed)
+				{
+					const text::GlyphBitmap& glyph = glyphs.get(p.codepoint, pixel_size, style.bold, style.italic);
+					blit(glyph.coverage.data(), glyph.width, glyph.height, p.x + glyph.left, p.y + glyph.top);
+				}
+				for (const Decoration& d : decorations) blit(nullptr, d.x1 - d.x0, d.y1 - d.y0, d.x0, d.y0);
+
+				if (!clips.empty()) clip_mask(item);
+				out.push_back(std::move(item));
+			}
+
+			/*
+			* \brief split the commands of a path into polylines. Curves are flattened within tolerance
+			*/
+			void path_polylines(const Path& path, double tolerance)
+			{
+				geometry::flatten(path, tolerance, flat);
+
+				for (size_t i = 0; i < flat.contour_count(); i++)
+				{
+					const Point* data = flat.contour_data(i);
+					begin_polyline(flat.closed.at(i));
+					polylines.back().assign(data, data + flat.contour_size(i));
+				}
+			}
+		};
+
+		/*
+		* \brief background color of a canvas as premultiplied color
+		*/
+		inline Rgba background_of(const Canvas& canvas)
+		{
+			// f_background is drawn as an item above, see ItemBuilder::background
+			if (canvas.f_background != nullptr) return Rgba();
+			return Rgba::from(canvas.c_background, 1.0);
+		}
+
+		namespace detail
+		{
+			/*
+			* \brief composite the items binned to each tile in todo. Tiles are processed in parallel
+			* \param bins: items per tile in drawing order, row major
+			*/
+			inline void rasterize_tiles(const std::vector<std::vector<const DrawItem*>>& bins, const std::vector<size_t>& todo, const Rgba& background, Image& image, const RenderOptions& options)
+			{
+				const int tile_size = options.tile_size;
+				const int tiles_x = (image.width + tile_size - 1) / tile_size;
+
+				struct Workspace
+				{
+					TileRasterizer rasterizer;
+					std::vector<float> buffer;
+				};
+
+				// one workspace per pool worker, created by the worker using it
+				ThreadPool& pool = ThreadPool::shared();
+				std::vector<std::unique_ptr<Workspace>> workspaces(pool.size());
+
+				// threads finishing cheap tiles take over the remaining ones
+				pool.parallel_for(todo.size(), [&](size_t job, unsigned worker)
+				{
+					std::unique_ptr<Workspace>& workspace = workspaces[worker];
+					if (workspace == nullptr)
+					{
+						workspace = std::make_unique<Workspace>();
+						workspace->buffer.resize(static_cast<size_t>(tile_size) * tile_size * 4);
+					}
+					std::vector<float>& buffer = workspace->buffer;
+
+					const size_t tile = todo.at(job);
+					const int tx0 = static_cast<int>(tile % tiles_x) * tile_size, ty0 = static_cast<int>(tile / tiles_x) * tile_size;
+					const int tx1 = std::min(tx0 + tile_size, image.width), ty1 = std::min(ty0 + tile_size, image.height);
+
+					for (size_t i = 0; i < buffer.size(); i += 4)
+					{
+						buffer[i] = background.r; buffer[i + 1] = background.g; buffer[i + 2] = background.b; buffer[i + 3] = background.a;
+					}
+
+					for (const DrawItem* item : bins.at(tile)) workspace->rasterizer.fill(*item, tx0, ty0, tx1, ty1, buffer.data(), tile_size * 4);
+
+					for (int y = ty0; y < ty1; y++)
+					{
+						const float* src = buffer.data() + static_cast<size_t>(y - ty0) * tile_size * 4;
+						uint8_t* dst = image.row(y) + static_cast<size_t>(tx0) * 4;
+						for (int i = 0; i < (tx1 - tx0) * 4; i++) dst[i] = static_cast<uint8_t>(std::clamp(src[i], 0.f, 1.f) * 255.f + 0.5f);
+					}
+				}, options.threads);
+			}
+		}
+
+		/*
+		* \brief composite items into the tiles of image. Tiles are processed in parallel
+		* \param tiles: indices of the tiles to render, row major. All tiles if empty
+		*/
+		inline void render_items(const std::vector<DrawItem>& items, const Rgba& background, Image& image, const RenderOptions& options, const std::vector<size_t>& tiles = {})
+		{
+			const int tile_size = options.tile_size;
+			const int tiles_x = (image.width + tile_size - 1) / tile_size;
+			const int tiles_y = (image.height + tile_size - 1) / tile_size;
+			const size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+
+			// items per tile, in drawing order
+			std::vector<std::vector<const DrawItem*>> bins(tile_count);
+			for (const DrawItem& item : items)
+			{
+				for (int ty = item.y0 / tile_size; ty <= (item.y1 - 1) / tile_size; ty++)
+				{
+					for (int tx = item.x0 / tile_size; tx <= (item.x1 - 1) / tile_size; tx++)
+					{
+						bins.at(static_cast<size_t>(ty) * tiles_x + tx).push_back(&item);
+					}
+				}
+			}
+
+			std::vector<size_t> todo = tiles;
+			if (todo.empty())
+			{
+				todo.resize(tile_count);
+				for (size_t i = 0; i < tile_count; i++) todo.at(i) = i;
+			}
+
+			detail::rasterize_tiles(bins, todo, background, image, options);
+		}
+
+		/*
+		* \brief tile of pattern rasterized at scale pixels per unit. Cached per pattern and pixel size
+		*/
+		inline std::shared_ptr<const Image> ItemBuilder::pattern_tile(const Pattern& pattern, double scale)
+		{
+			if (depth >= MAX_PATTERN_DEPTH) return nullptr;
+
+			constexpr double MAX_TILE_SIZE = 4096;
+			const int width = static_cast<int>(std::clamp(std::ceil(pattern.bounds.dim.width * scale), 1.0, MAX_TILE_SIZE));
+			const int height = static_cast<int>(std::clamp(std::ceil(pattern.bounds.dim.height * scale), 1.0, MAX_TILE_SIZE));
+
+			FillCache<Image>& cached = pattern_tiles[{ &pattern, width, height }];
+			const uint64_t revision = fill_revision(pattern);
+			if (cached.value != nullptr && cached.revision == revision) return cached.value;
+
+			auto image = std::make_shared<Image>(width, height);
+			if (pattern.tile != nullptr)
+			{
+				// tile contents have their origin in the top left corner of the tile
+				RenderOptions tile_options = options;
+				tile_options.width = width;
+				tile_options.height = height;
+				tile_options.view = Matrix::scaling(width / pattern.bounds.dim.width, height / pattern.bounds.dim.height);
+				tile_options.threads = 1;
+
+				ItemBuilder nested(tile_options);
+				nested.depth = depth + 1;
+
+				std::vector<DrawItem> items;
+				nested.collect(*pattern.tile, items);
+				render_items(items, Rgba(), *image, tile_options);
+			}
+
+			cached.revision = revision;
+			cached.value = image;
+			return image;
+		}
+
+		/*
+		* \brief render a canvas into a new image
+		*/
+		inline Image render(const Canvas& canvas, const RenderOptions& options)
+		{
+			if (options.width <= 0 || options.height <= 0) throw std::invalid_argument("RenderOptions: width and height must be > 0");
+			if (options.tile_size <= 0) throw std::invalid_argument("RenderOptions: tile_size must be > 0");
+
+			std::vector<DrawItem> items;
+			ItemBuilder builder(options);
+			if (options.draw_background) builder.background(canvas, items);
+			builder.collect(canvas, items);
+
+			Image image(options.width, options.height);
+			render_items(items, options.draw_background ? background_of(canvas) : Rgba(), image, options);
+			return image;
+		}
+
+		/*
+		* \brief revision of everything the items of element depend on: the element, its fill, its markers and the clip paths of its owner chain
+		*/
+		inline uint64_t content_revision(const abstracts::GraphicalElement& element)
+		{
+			uint64_t revision = element.revision();
+			if (const abstracts::Fill* fill = element.resolved_style().fill) revision = (revision ^ fill_revision(*fill)) * 0x100000001b3ull;
+			for (const abstracts::GraphicalElement* e = &element; e != nullptr; e = e->owner)
+			{
+				if (e->mask != nullptr) revision = (revision ^ tree_revision(*e->mask)) * 0x100000001b3ull;
+			}
+			if (const abstracts::MarkedElement* marked = dynamic_cast<const abstracts::MarkedElement*>(&element))
+			{
+				for (const Marker* marker : { marked->start, marked->mid, marked->end })
+				{
+					if (marker != nullptr) revision = (revision ^ tree_revision(*marker)) * 0x100000001b3ull;
+				}
+			}
+			return revision;
+		}
+
+		/*
+		* \brief keeps the image of a canvas up to date, only tiles whose content changed are rasterized again
+		*
+		* - the DrawItems of every element are cached together with its content_revision (element, fill, markers and clip paths)
+		* - changed elements are found through the revisions of groups: an invalidated element gives its owner chain a new revision.
+		*   Groups with the same revision and the same members are not entered, only their nested groups are checked
+		* - elements using fills, clip paths or markers are checked on every update, changes of those don't reach the owner chain
+		* - every tile keeps the entries touching it in drawing order. A changed element leaves the tiles of its old items and
+		*   joins the tiles of its new ones, only these tiles are binned again
+		* - added, removed, reordered and hidden elements rebuild the drawing order and all bins
+		* - tiles are redrawn if the signature of their items (element revisions in drawing order) changed
+		* - the canvas must outlive the renderer, view and image size are fixed
+		*/
+		class IncrementalRenderer
+		{
+		public:
+			IncrementalRenderer(const Canvas& canvas, const RenderOptions& options)
+				: canvas(canvas),
+				  options(options),
+				  builder(this->options)
+			{
+				if (options.width <= 0 || options.height <= 0) throw std::invalid_argument("RenderOptions: width and height must be > 0");
+				if (options.tile_size <= 0) throw std::invalid_argument("RenderOptions: tile_size must be > 0");
+
+				image = Image(options.width, options.height);
+				tiles_x = (options.width + options.tile_size - 1) / options.tile_size;
+				tiles_y = (options.height + options.tile_size - 1) / options.tile_size;
+
+				const size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+				tile_entries.resize(tile_count);
+				bins.resize(tile_count);
+				signatures.resize(tile_count);
+				marked.resize(tile_count);
+			}
+
+			// the cache references the canvas elements by address
+			IncrementalRenderer(const IncrementalRenderer&) = delete;
+			IncrementalRenderer& operator=(const IncrementalRenderer&) = delete;
+
+			/*
+			* \brief bring the image up to date with the canvas
+			* \return the tiles which were redrawn, row major
+			*/
+			const std::vector<size_t>& update()
+			{
+				frame++;
+				candidates.clear();
+
+				// after invalidate the bins reference deleted entries, they are rebuilt without looking at them
+				const bool rebuild = full || !scan(canvas);
+
+				const uint64_t background_revision = canvas.f_background != nullptr ? fill_revision(*canvas.f_background) : 0;
+				if (options.draw_background && (background_entry.frame == 0 || background_fill != canvas.f_background || background_fill_revision != background_revision))
+				{
+					background_fill = canvas.f_background;
+					background_fill_revision = background_revision;
+					background_entry.items.clear();
+					builder.background(canvas, background_entry.items);
+					background_entry.revision = DG::detail::next_revision();
+					background_entry.frame = frame;
+					if (rebuild) update_tiles(background_entry);
+					else retile(background_entry);
+				}
+
+				if (rebuild) rebuild_order();
+				else
+				{
+					for (Entry* entry : dependents)
+					{
+						if (entry->revision != content_revision(*entry->element)) refresh(*entry);
+					}
+				}
+
+				const Rgba background = options.draw_background ? background_of(canvas) : Rgba();
+				if (background.r != last_background.r || background.g != last_background.g || background.b != last_background.b || background.a != last_background.a)
+				{
+					last_background = background;
+					full = true;
+				}
+
+				if (rebuild || full)
+				{
+					candidates.resize(tile_entries.size());
+					for (size_t tile = 0; tile < candidates.size(); tile++) candidates[tile] = tile;
+				}
+
+				dirty.clear();
+				for (size_t tile : candidates)
+				{
+					marked[tile] = false;
+					const uint64_t signature = bin(tile);
+					if (full || signature != signatures[tile]) dirty.push_back(tile);
+					signatures[tile] = signature;
+				}
+				std::sort(dirty.begin(), dirty.end());
+				full = false;
+
+				if (!dirty.empty()) detail::rasterize_tiles(bins, dirty, background, image, options);
+				return dirty;
+			}
+
+			/*
+			* \brief rebuild and redraw everything on the next update. Needed after changes which don't invalidate an element or a fill
+			*/
+			void invalidate()
+			{
+				full = true;
+				entries.clear();
+				background_entry = Entry();
+				builder.clear_caches();
+			}
+
+			const Image& result() const
+			{
+				return image;
+			}
+
+		private:
+			static constexpr uint64_t SIGNATURE_BASIS = 0xcbf29ce484222325ull;
+
+			struct Entry
+			{
+				const abstracts::GraphicalElement* element = nullptr;
+				std::vector<DrawItem> items;
+				uint64_t revision = 0;
+				uint64_t frame = 0;
+
+				// position in the drawing order
+				size_t index = 0;
+
+				// tiles touched by the items, ascending
+				std::vector<size_t> tiles;
+
+				// reads fills, clip paths or markers, see dependents
+				bool dependent = false;
+			};
+
+			/*
+			* \brief a group as seen by the last rebuild of the drawing order
+			*/
+			struct GroupState
+			{
+				uint64_t revision = 0;
+				bool visible = false;
+				std::vector<abstracts::GraphicalElement*> members;
+
+				// members which are groups themselves
+				std::vector<const Group*> groups;
+			};
+
+			const Canvas& canvas;
+			const RenderOptions options;
+			ItemBuilder builder;
+
+			Image image;
+			int tiles_x = 0, tiles_y = 0;
+
+			// node based, entries keep their address while the map grows
+			std::unordered_map<const abstracts::GraphicalElement*, Entry> entries;
+			std::unordered_map<const Group*, GroupState> groups;
+
+			// items of Canvas::f_background
+			Entry background_entry;
+			const abstracts::Fill* background_fill = nullptr;
+			uint64_t background_fill_revision = 0;
+
+			// visible elements in drawing order
+			std::vector<Entry*> order;
+
+			// entries whose content_revision is compared on every update
+			std::vector<Entry*> dependents;
+
+			// entries per tile, in drawing order
+			std::vector<std::vector<Entry*>> tile_entries;
+
+			std::vector<std::vector<const DrawItem*>> bins;
+			std::vector<uint64_t> signatures;
+
+			// tiles to bin again
+			std::vector<size_t> candidates;
+			std::vector<bool> marked;
+
+			std::vector<size_t> dirty;
+
+			Rgba last_background;
+			uint64_t frame = 0;
+			bool full = true;
+
+			static bool reads_references(const abstracts::GraphicalElement& element)
+			{
+				if (element.resolved_style().fill != nullptr) return true;
+				for (const abstracts::GraphicalElement* e = &element; e != nullptr; e = e->owner)
+				{
+					if (e->mask != nullptr) return true;
+				}
+				const abstracts::MarkedElement* with_markers = dynamic_cast<const abstracts::MarkedElement*>(&element);
+				return with_markers != nullptr && (with_markers->start != nullptr || with_markers->mid != nullptr || with_markers->end != nullptr);
+			}
+
+			/*
+			* \brief find changed elements below group and refresh their entries
+			* \return false if the drawing order changed
+			*/
+			bool scan(const Group& group)
+			{
+				auto it = groups.find(&group);
+				if (it == groups.end()) return false;
+
+				GroupState& state = it->second;
+				if (state.members != group.members) return false;
+
+				if (state.revision == group.revision())
+				{
+					if (!state.visible) return true;
+
+					// members of nested groups may have been reordered
+					for (const Group* nested : state.groups)
+					{
+						if (!scan(*nested)) return false;
+					}
+					return true;
+				}
+
+				state.revision = group.revision();
+				if (builder.visible(group) != state.visible) return false;
+				if (!state.visible) return true;
+
+				for (const abstracts::GraphicalElement* member : group.members)
+				{
+					if (member == nullptr) continue;
+
+					if (const Group* nested = dynamic_cast<const Group*>(member))
+					{
+						if (!scan(*nested)) return false;
+						continue;
+					}
+
+					auto entry = entries.find(member);
+					if (builder.visible(*member) != (entry != entries.end())) return false;
+					if (entry != entries.end() && entry->second.revision != content_revision(*member)) refresh(entry->second);
+				}
+				return true;
+			}
+
+			/*
+			* \brief convert the element of entry again and move it to the tiles of its new items
+			*/
+			void refresh(Entry& entry)
+			{
+				entry.items.clear();
+				builder.build(*entry.element, entry.items);
+				entry.revision = content_revision(*entry.element);
+
+				if (!entry.dependent && reads_references(*entry.element))
+				{
+					entry.dependent = true;
+					dependents.push_back(&entry);
+				}
+				retile(entry);
+			}
+
+			void retile(Entry& entry)
+			{
+				for (size_t tile : entry.tiles)
+				{
+					std::vector<Entry*>& list = tile_entries[tile];
+					list.erase(std::find(list.begin(), list.end(), &entry));
+					mark(tile);
+				}
+
+				update_tiles(entry);
+
+				for (size_t tile : entry.tiles)
+				{
+					std::vector<Entry*>& list = tile_entries[tile];
+					list.insert(std::lower_bound(list.begin(), list.end(), &entry, [](const Entry* a, const Entry* b) { return a->index < b->index; }), &entry);
+					mark(tile);
+				}
+			}
+
+			void update_tiles(Entry& entry) const
+			{
+				entry.tiles.clear();
+				for (const DrawItem& item : entry.items)
+				{
+					for (int ty = item.y0 / options.tile_size; ty <= (item.y1 - 1) / options.tile_size; ty++)
+					{
+						for (int tx = item.x0 / options.tile_size; tx <= (item.x1 - 1) / options.tile_size; tx++)
+						{
+							entry.tiles.push_back(static_cast<size_t>(ty) * tiles_x + tx);
+						}
+					}
+				}
+				std::sort(entry.tiles.begin(), entry.tiles.end());
+				entry.tiles.erase(std::unique(entry.tiles.begin(), entry.tiles.end()), entry.tiles.end());
+			}
+
+			void mark(size_t tile)
+			{
+				if (marked[tile]) return;
+				marked[tile] = true;
+				candidates.push_back(tile);
+			}
+
+			/*
+			* \brief collect the items of tile in drawing order
+			* \return signature of the items
+			*/
+			uint64_t bin(size_t tile)
+			{
+				const int tx = static_cast<int>(tile % tiles_x), ty = static_cast<int>(tile / tiles_x);
+
+				std::vector<const DrawItem*>& bin = bins[tile];
+				bin.clear();
+				uint64_t signature = SIGNATURE_BASIS;
+				for (const Entry* entry : tile_entries[tile])
+				{
+					for (size_t i = 0; i < entry->items.size(); i++)
+					{
+						const DrawItem& item = entry->items[i];
+						if (item.x0 / options.tile_size > tx || (item.x1 - 1) / options.tile_size < tx) continue;
+						if (item.y0 / options.tile_size > ty || (item.y1 - 1) / options.tile_size < ty) continue;
+
+						bin.push_back(&item);
+						signature = (signature ^ (entry->revision * 0x9e3779b97f4a7c15ull + i)) * 0x100000001b3ull;
+					}
+				}
+				return signature;
+			}
+
+			/*
+			* \brief visit the whole canvas, rebuild drawing order, group states and bins
+			*/
+			void rebuild_order()
+			{
+				order.clear();
+				dependents.clear();
+				groups.clear();
+
+				if (options.draw_background)
+				{
+					background_entry.frame = frame;
+					order.push_back(&background_entry);
+				}
+				visit(canvas);
+
+				// forget elements which were removed or moved offscreen
+				for (auto it = entries.begin(); it != entries.end();)
+				{
+					if (it->second.frame != frame) it = entries.erase(it);
+					else it++;
+				}
+
+				for (std::vector<Entry*>& list : tile_entries) list.clear();
+				for (size_t i = 0; i < order.size(); i++)
+				{
+					order[i]->index = i;
+					for (size_t tile : order[i]->tiles) tile_entries[tile].push_back(order[i]);
+				}
+			}
+
+			void visit(const abstracts::GraphicalElement& element)
+			{
+				const bool visible = builder.visible(element);
+
+				const Group* group = dynamic_cast<const Group*>(&element);
+				if (group != nullptr)
+				{
+					GroupState& state = groups[group];
+					state.revision = group->revision();
+					state.visible = visible;
+					state.members = group->members;
+					if (!visible) return;
+
+					// same order as ItemBuilder::collect
+					for (auto it = group->members.rbegin(); it != group->members.rend(); it++)
+					{
+						if (*it == nullptr) continue;
+						if (const Group* nested = dynamic_cast<const Group*>(*it)) state.groups.push_back(nested);
+						visit(**it);
+					}
+					return;
+				}
+				if (!visible) return;
+
+				Entry& entry = entries[&element];
+				const uint64_t revision = content_revision(element);
+				if (entry.frame == 0 || entry.revision != revision)
+				{
+					entry.element = &element;
+					entry.items.clear();
+					builder.build(element, entry.items);
+					entry.revision = revision;
+					update_tiles(entry);
+				}
+				entry.frame = frame;
+
+				entry.dependent = reads_references(element);
+				if (entry.dependent) dependents.push_back(&entry);
+				order.push_back(&entry);
+			}
+		};
+
+		namespace detail
+		{
+			inline void put_u32_be(std::ostream& out, uint32_t value)
+			{
+				const char bytes[4] = { static_cast<char>(value >> 24), static_cast<char>(value >> 16), static_cast<char>(value >> 8), static_cast<char>(value) };
+				out.write(bytes, 4);
+			}
+
+			inline uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size)
+			{
+				static const std::vector<uint32_t> table = []()
+				{
+					std::vector<uint32_t> t(256);
+					for (uint32_t n = 0; n < 256; n++)
+					{
+						uint32_t c = n;
+						for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+						t[n] = c;
+					}
+					return t;
+				}();
+
+				crc = ~crc;
+				for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+				return ~crc;
+			}
+
+			inline void png_chunk(std::ostream& out, const char* type, const std::vector<uint8_t>& data)
+			{
+				put_u32_be(out, static_cast<uint32_t>(data.size()));
+				out.write(type, 4);
+				out.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+				uint32_t crc = crc32(0, reinterpret_cast<const uint8_t*>(type), 4);
+				crc = crc32(crc, data.data(), data.size());
+				put_u32_be(out, crc);
+			}
+
+			/*
+			* \brief straight alpha from premultiplied alpha
+			*/
+			inline void unpremultiply(const uint8_t* src, uint8_t* dst)
+			{
+				const int a = src[3];
+				dst[3] = static_cast<uint8_t>(a);
+				for (int c = 0; c < 3; c++) dst[c] = a == 0 ? 0 : static_cast<uint8_t>(std::min(255, (src[c] * 255 + a / 2) / a));
+			}
+		}
+
+		/*
+		* \brief write a binary PPM (P6). PPM has no alpha channel, the image is composited over white
+		*/
+		inline void write_ppm(const Image& image, std::ostream& out)
+		{
+			out << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+
+			std::vector<char> row(static_cast<size_t>(image.width) * 3);
+			for (int y = 0; y < image.height; y++)
+			{
+				const uint8_t* src = image.row(y);
+				for (int x = 0; x < image.width; x++)
+				{
+					const int inv = 255 - src[x * 4 + 3];
+					for (int c = 0; c < 3; c++) row[x * 3 + c] = static_cast<char>(src[x * 4 + c] + inv);
+				}
+				out.write(row.data(), row.size());
+			}
+		}
+
+		/*
+		* \brief write an RGBA PNG. The image data is stored without compression, no zlib needed
+		*/
+		inline void write_png(const Image& image, std::ostream& out)
+		{
+			static const char signature[8] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n' };
+			out.write(signature, 8);
+
+			std::vector<uint8_t> header;
+			for (uint32_t value : { static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height) })
+			{
+				for (int shift = 24; shift >= 0; shift -= 8) header.push_back(static_cast<uint8_t>(value >> shift));
+			}
+			header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8 bit RGBA, deflate, adaptive filtering, no interlace
+			detail::png_chunk(out, "IHDR", header);
+
+			// scanlines with filter type 0
+			const size_t row_size = static_cast<size_t>(image.width) * 4 + 1;
+			std::vector<uint8_t> raw(row_size * image.height);
+			for (int y = 0; y < image.height; y++)
+			{
+				uint8_t* dst = raw.data() + row_size * y;
+				dst[0] = 0;
+				const uint8_t* src = image.row(y);
+				for (int x = 0; x < image.width; x++) detail::unpremultiply(src + x * 4, dst + 1 + x * 4);
+			}
+
+			// zlib stream of stored deflate blocks
+			std::vector<uint8_t> zlib = { 0x78, 0x01 };
+			zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+
+			size_t offset = 0;
+			do
+			{
+				const size_t block = std::min<size_t>(65535, raw.size() - offset);
+				const bool last = offset + block == raw.size();
+
+				zlib.push_back(last ? 1 : 0);
+				zlib.push_back(static_cast<uint8_t>(block));
+				zlib.push_back(static_cast<uint8_t>(block >> 8));
+				zlib.push_back(static_cast<uint8_t>(~block));
+				zlib.push_back(static_cast<uint8_t>(~block >> 8));
+				zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+				offset += block;
+			} while (offset < raw.size());
+
+			// adler32, the modulo is only needed every 5552 bytes
+			uint32_t s1 = 1, s2 = 0;
+			for (size_t begin = 0; begin < raw.size(); begin += 5552)
+			{
+				const size_t end = std::min(raw.size(), begin + 5552);
+				for (size_t i = begin; i < end; i++)
+				{
+					s1 += raw[i];
+					s2 += s1;
+				}
+				s1 %= 65521;
+				s2 %= 65521;
+			}
+			const uint32_t adler = (s2 << 16) | s1;
+			for (int shift = 24; shift >= 0; shift -= 8) zlib.push_back(static_cast<uint8_t>(adler >> shift));
+
+			detail::png_chunk(out, "IDAT", zlib);
+			detail::png_chunk(out, "IEND", {});
+		}
+
+		/*
+		* \brief write image to path, the format is chosen by the extension (.png, anything else: ppm)
+		*/
+		inline bool save_image(const Image& image, const std::string& path)
+		{
+			std::ofstream file(path, std::ios::binary);
+			if (!file) return false;
+
+			const bool png = path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+			if (png) write_png(image, file);
+			else write_ppm(image, file);
+
+			return static_cast<bool>(file);
+		}
+	}
+}
@@ -0,0 +1,629 @@
+#pragma once
+#include "DiagramGraphics.hpp"
+#include "DiagramGraphicsText.hpp"
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+/*
+* Streaming SVG export for DG canvases
+* -> one pass collects everything which has to be defined once (fills, markers, clip paths) and assigns ids
+* -> <defs> are written, elements reference them by id
+* -> elements are written straight into a buffer which is flushed to the stream, no DOM is built
+*/
+namespace DG
+{
+	namespace svg
+	{
+		class SvgWriter
+		{
+		public:
+			// buffered bytes before they are written to the stream
+			static constexpr size_t FLUSH_SIZE = 1 << 16;
+
+			SvgWriter(std::ostream& out)
+				: out(out)
+			{
+				buffer.reserve(FLUSH_SIZE + 1024);
+			}
+
+			~SvgWriter()
+			{
+				flush();
+			}
+
+			/*
+			* \brief write canvas as standalone svg document
+			* \param width, height: size of the svg viewport in canvas units
+			*/
+			void write(const Canvas& canvas, double width, double height)
+			{
+				ids.clear();
+				fills.clear();
+				markers.clear();
+				clip_paths.clear();
+
+				collect(canvas);
+				if (canvas.f_background != nullptr) register_fill(canvas.f_background);
+				for (const abstracts::Fill* fill : canvas.package_fills) register_fill(fill);
+
+				put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"");
+				put(width); put("\" height=\""); put(height);
+				// unset fills are not painted, like in the rasterizer. Inherited by defs as well
+				put("\" viewBox=\"0 0 "); put(width); put(' '); put(height); put("\" fill=\"none\">\n");
+
+				write_defs();
+
+				// background, f_background is used if both are set
+				put("<rect width=\"100%\" height=\"100%\" fill=\"");
+				if (canvas.f_background != nullptr) put_reference(canvas.f_background);
+				else put_color(canvas.c_background);
+				put("\"/>\n");
+
+				write_element(canvas);
+				put("</svg>\n");
+
+				flush();
+			}
+
+			void flush()
+			{
+				out.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+
+		private:
+			std::ostream& out;
+			std::string buffer;
+
+			// object -> id, objects are written in order of registration
+			std::unordered_map<const void*, std::string> ids;
+			std::vector<const abstracts::Fill*> fills;
+			std::vector<const Marker*> markers;
+			std::vector<const ClipPath*> clip_paths;
+
+			// reused for multi line text
+			text::TextLayout text_layout;
+
+			/*
+			* Output
+			*/
+			void put(char c)
+			{
+				buffer.push_back(c);
+			}
+
+			void put(const char* text)
+			{
+				buffer.append(text);
+				if (buffer.size() >= FLUSH_SIZE) flush();
+			}
+
+			void put(const std::string& text)
+			{
+				buffer.append(text);
+				if (buffer.size() >= FLUSH_SIZE) flush();
+			}
+
+			// significant digits of coordinates and matrix entries. The shortest exact representation would keep
+			// rounding noise of the geometry code (349.99999999999994)
+			static constexpr int PRECISION = 12;
+
+			void put(double value)
+			{
+				if (!std::isfinite(value)) value = 0;
+
+				char number[32];
+				const std::to_chars_result res = std::to_chars(number, number + sizeof(number), value, std::chars_format::general, PRECISION);
+				buffer.append(number, res.ptr);
+			}
+
+			// shortest representation of the float, style values are stored as float
+			void put(float value)
+			{
+				if (!std::isfinite(value)) value = 0;
+
+				char number[32];
+				const std::to_chars_result res = std::to_chars(number, number + sizeof(number), value);
+				buffer.append(number, res.ptr);
+			}
+
+			void put_point(const Point& p)
+			{
+				put(p.x); put(','); put(p.y);
+			}
+
+			/*
+			* \brief write text with xml entities escaped
+			*/
+			void put_escaped(const std::string& text)
+			{
+				for (char c : text)
+				{
+					switch (c)
+					{
+					case '&': buffer.append("&amp;"); break;
+					case '<': buffer.append("&lt;"); break;
+					case '>': buffer.append("&gt;"); break;
+					case '"': buffer.append("&quot;"); break;
+					case '\'': buffer.append("&apos;"); break;
+					default: buffer.push_back(c);
+					}
+				}
+				if (buffer.size() >= FLUSH_SIZE) flush();
+			}
+
+			void put_color(const Color& color)
+			{
+				static const char digits[] = "0123456789abcdef";
+				put('#');
+				for (int channel : { color.red, color.green, color.blue })
+				{
+					put(digits[(channel >> 4) & 0xf]);
+					put(digits[channel & 0xf]);
+				}
+			}
+
+			void put_reference(const void* object)
+			{
+				put("url(#"); put(ids.at(object)); put(')');
+			}
+
+			template<typename T>
+			void put_attribute(const char* name, T value)
+			{
+				put(' '); put(name); put("=\""); put(value); put('"');
+			}
+
+			void put_matrix_attribute(const char* name, const Matrix& m)
+			{
+				if (m.is_identity()) return;
+
+				put(' '); put(name); put("=\"matrix(");
+				put(m.a); put(' '); put(m.b); put(' '); put(m.c); put(' ');
+				put(m.d); put(' '); put(m.e); put(' '); put(m.f); put(")\"");
+			}
+
+			/*
+			* Collection of referenced objects
+			*/
+			void register_fill(const abstracts::Fill* fill)
+			{
+				if (fill == nullptr || ids.count(fill) != 0) return;
+
+				ids.insert({ fill, "fill" + std::to_string(fills.size()) });
+				fills.push_back(fill);
+
+				// the tile of a pattern may reference further objects
+				if (const Pattern* pattern = dynamic_cast<const Pattern*>(fill))
+				{
+					if (pattern->tile != nullptr) collect(*pattern->tile);
+				}
+			}
+
+			void register_styles(const abstracts::GraphicalElement& element)
+			{
+				for (const Style& style : element.s_local)
+				{
+					if (style.has(Style::Key::fill)) register_fill(style.fill());
+				}
+				for (const Style* style : element.s_shared)
+				{
+					if (style != nullptr && style->has(Style::Key::fill)) register_fill(style->fill());
+				}
+			}
+
+			/*
+			* \brief walk element and everything it references once
+			*/
+			void collect(const abstracts::GraphicalElement& element)
+			{
+				register_styles(element);
+
+				if (element.mask != nullptr && ids.count(element.mask) == 0)
+				{
+					ids.insert({ element.mask, "clip" + std::to_string(clip_paths.size()) });
+					clip_paths.push_back(element.mask);
+					collect(*element.mask);
+				}
+
+				if (const abstracts::MarkedElement* marked = dynamic_cast<const abstracts::MarkedElement*>(&element))
+				{
+					for (const Marker* marker : { marked->start, marked->mid, marked->end })
+					{
+						if (marker == nullptr || ids.count(marker) != 0) continue;
+
+						ids.insert({ marker, "marker" + std::to_string(markers.size()) });
+						markers.push_back(marker);
+						collect(*marker);
+					}
+				}
+
+				if (const Group* group = dynamic_cast<const Group*>(&element))
+				{
+					for (const abstracts::GraphicalElement* member : group->members)
+					{
+						if (member != nullptr) collect(*member);
+					}
+				}
+			}
+
+			/*
+			* <defs>
+			*/
+			void write_defs()
+			{
+				if (fills.empty() && markers.empty() && clip_paths.empty()) return;
+
+				put("<defs>\n");
+
+				for (const abstracts::Fill* fill : fills) write_fill(*fill);
+
+				for (const Marker* marker : markers)
+				{
+					put("<marker id=\""); put(ids.at(marker)); put("\" markerUnits=\"userSpaceOnUse\" orient=\"auto\" overflow=\"visible\"");
+					put_attribute("markerWidth", marker->size.width);
+					put_attribute("markerHeight", marker->size.height);
+					put_attribute("refX", marker->reference.x);
+					put_attribute("refY", marker->reference.y);
+					put(">\n");
+					write_members(*marker);
+					put("</marker>\n");
+				}
+
+				for (const ClipPath* clip : clip_paths)
+				{
+					put("<clipPath id=\""); put(ids.at(clip)); put('"');
+					put_matrix_attribute("transform", clip->local_matrix());
+					put(">\n");
+					write_members(*clip);
+					put("</clipPath>\n");
+				}
+
+				put("</defs>\n");
+			}
+
+			void write_stops(const abstracts::Gradient& gradient)
+			{
+				for (const GradientStop& stop : gradient.stops)
+				{
+					put("<stop");
+					put_attribute("offset", stop.offset);
+					put(" stop-color=\""); put_color(stop.color); put('"');
+					put_attribute("stop-opacity", stop.opacity);
+					put("/>\n");
+				}
+			}
+
+			void write_fill(const abstracts::Fill& fill)
+			{
+				const std::string& id = ids.at(&fill);
+
+				if (const LinearGradient* linear = dynamic_cast<const LinearGradient*>(&fill))
+				{
+					put("<linearGradient id=\""); put(id); put('"');
+					put_attribute("x1", linear->x1);
+					put_attribute("y1", linear->y1);
+					put_attribute("x2", linear->x2);
+					put_attribute("y2", linear->y2);
+					put_matrix_attribute("gradientTransform", fill.matrix());
+					put(">\n");
+					write_stops(*linear);
+					put("</linearGradient>\n");
+				}
+				else if (const RadialGradient* radial = dynamic_cast<const RadialGradient*>(&fill))
+				{
+					put("<radialGradient id=\""); put(id); put('"');
+					put_attribute("cx", radial->x_center);
+					put_attribute("cy", radial->y_center);
+					put_attribute("r", radial->radius);
+					put_attribute("fx", radial->x_focus);
+					put_attribute("fy", radial->y_focus);
+					put_matrix_attribute("gradientTransform", fill.matrix());
+					put(">\n");
+					write_stops(*radial);
+					put("</radialGradient>\n");
+				}
+				else if (const Pattern* pattern = dynamic_cast<const Pattern*>(&fill))
+				{
+					put("<pattern id=\""); put(id); put("\" patternUnits=\"userSpaceOnUse\"");
+					put_attribute("x", pattern->bounds.pos.x);
+					put_attribute("y", pattern->bounds.pos.y);
+					put_attribute("width", pattern->bounds.dim.width);
+					put_attribute("height", pattern->bounds.dim.height);
+					put_matrix_attribute("patternTransform", fill.matrix());
+					put(">\n");
+					if (pattern->tile != nullptr) write_element(*pattern->tile);
+					put("</pattern>\n");
+				}
+			}
+
+			/*
+			* Elements
+			*/
+
+			/*
+			* \brief write the style properties of element as presentation attributes. Local styles are preferred over shared ones,
+			*        inherited properties are resolved by the svg renderer through the <g> hierarchy
+			*/
+			void write_style(const abstracts::GraphicalElement& element)
+			{
+				const bool is_text = dynamic_cast<const Text*>(&element) != nullptr;
+
+				std::vector<const Style*> styles;
+				for (const Style& style : element.s_local) styles.push_back(&style);
+				for (const Style* style : element.s_shared) if (style != nullptr) styles.push_back(style);
+
+				auto find = [&](Style::Key key) -> const Style*
+				{
+					for (const Style* style : styles)
+					{
+						if (style->has(key)) return style;
+					}
+					return nullptr;
+				};
+
+				// svg colors text with fill
+				const Style* font_color = is_text ? find(Style::Key::fontColor) : nullptr;
+				if (font_color != nullptr)
+				{
+					put(" fill=\""); put_color(font_color->font_color()); put('"');
+				}
+				else if (const Style* fill = find(Style::Key::fill))
+				{
+					put(" fill=\""); put_reference(fill->fill()); put('"');
+				}
+				else if (const Style* fill_color = find(Style::Key::fillColor))
+				{
+					put(" fill=\""); put_color(fill_color->fill_color()); put('"');
+				}
+				if (const Style* p = find(Style::Key::fillOpacity)) put_attribute("fill-opacity", p->fill_opacity());
+
+				if (const Style* p = find(Style::Key::strokeColor))
+				{
+					put(" stroke=\""); put_color(p->stroke_color()); put('"');
+				}
+				if (const Style* p = find(Style::Key::strokeWidth)) put_attribute("stroke-width", p->stroke_width());
+				if (const Style* p = find(Style::Key::strokeOpacity)) put_attribute("stroke-opacity", p->stroke_opacity());
+				if (const Style* p = find(Style::Key::strokeDashLength))
+				{
+					const std::vector<double>& dashes = p->stroke_dash_length();
+					if (!dashes.empty())
+					{
+						put(" stroke-dasharray=\"");
+						for (size_t i = 0; i < dashes.size(); i++)
+						{
+							if (i != 0) put(' ');
+							put(dashes.at(i));
+						}
+						put('"');
+					}
+				}
+
+				if (const Style* p = find(Style::Key::fontSize)) put_attribute("font-size", p->font_size());
+				if (const Style* p = find(Style::Key::fontName))
+				{
+					put(" font-family=\""); put_escaped(p->font_name()); put('"');
+				}
+				if (const Style* p = find(Style::Key::fontItalic)) put(p->font_italic() ? " font-style=\"italic\"" : " font-style=\"normal\"");
+				if (const Style* p = find(Style::Key::fontBold)) put(p->font_bold() ? " font-weight=\"bold\"" : " font-weight=\"normal\"");
+
+				const Style* underline = find(Style::Key::fontUnderline);
+				const Style* strike = find(Style::Key::fontStrikeThrough);
+				const bool is_underlined = underline != nullptr && underline->font_underline();
+				const bool is_struck = strike != nullptr && strike->font_strike_through();
+				if (is_underlined || is_struck)
+				{
+					put(" text-decoration=\"");
+					if (is_underlined) put("underline ");
+					if (is_struck) put("line-through");
+					put('"');
+				}
+			}
+
+			/*
+			* \brief attributes every element shares: transform, style, clip path, markers
+			*/
+			void write_common(const abstracts::GraphicalElement& element)
+			{
+				put_matrix_attribute("transform", element.local_matrix());
+				write_style(element);
+
+				if (element.mask != nullptr)
+				{
+					put(" clip-path=\""); put_reference(element.mask); put('"');
+				}
+
+				if (const abstracts::MarkedElement* marked = dynamic_cast<const abstracts::MarkedElement*>(&element))
+				{
+					if (marked->start != nullptr) { put(" marker-start=\""); put_reference(marked->start); put('"'); }
+					if (marked->mid != nullptr) { put(" marker-mid=\""); put_reference(marked->mid); put('"'); }
+					if (marked->end != nullptr) { put(" marker-end=\""); put_reference(marked->end); put('"'); }
+				}
+			}
+
+			/*
+			* \brief write the members of a group. Earlier members are drawn above later ones, so they are written last
+			*/
+			void write_members(const Group& group)
+			{
+				for (auto it = group.members.rbegin(); it != group.members.rend(); it++)
+				{
+					if (*it != nullptr) write_element(**it);
+				}
+			}
+
+			void write_points(const std::vector<Point>& points)
+			{
+				put(" points=\"");
+				for (size_t i = 0; i < points.size(); i++)
+				{
+					if (i != 0) put(' ');
+					put_point(points.at(i));
+				}
+				put('"');
+			}
+
+			void write_path_data(const Path& path)
+			{
+				put(" d=\"");
+				for (const PathSegment& command : path.commands)
+				{
+					const bool rel = is_relative(command);
+
+					if (const MoveTo* move = std::get_if<MoveTo>(&command))
+					{
+						put(rel ? 'm' : 'M'); put_point(move->point);
+					}
+					else if (const LineTo* line = std::get_if<LineTo>(&command))
+					{
+						put(rel ? 'l' : 'L'); put_point(line->point);
+					}
+					else if (const CubicCurveTo* cubic = std::get_if<CubicCurveTo>(&command))
+					{
+						put(rel ? 'c' : 'C'); put_point(cubic->control_start);
+						put(' '); put_point(cubic->control_end);
+						put(' '); put_point(cubic->point);
+					}
+					else if (const QuadraticCurveTo* quadratic = std::get_if<QuadraticCurveTo>(&command))
+					{
+						put(rel ? 'q' : 'Q'); put_point(quadratic->control);
+						put(' '); put_point(quadratic->point);
+					}
+					else if (const EllipticalArcTo* arc = std::get_if<EllipticalArcTo>(&command))
+					{
+						put(rel ? 'a' : 'A'); put(arc->radii.width); put(','); put(arc->radii.height);
+						put(' '); put(arc->rotation);
+						put(' '); put(arc->large_arc ? '1' : '0'); put(','); put(arc->sweep ? '1' : '0');
+						put(' '); put_point(arc->point);
+					}
+					else if (std::holds_alternative<ClosePath>(command))
+					{
+						put('Z');
+					}
+				}
+				put('"');
+			}
+
+			void write_element(const abstracts::GraphicalElement& element)
+			{
+				// defined in <defs>
+				if (dynamic_cast<const ClipPath*>(&element) != nullptr || dynamic_cast<const Marker*>(&element) != nullptr) return;
+
+				if (const Group* group = dynamic_cast<const Group*>(&element))
+				{
+					put("<g");
+					write_common(element);
+					put(">\n");
+					write_members(*group);
+					put("</g>\n");
+				}
+				else if (const Rectangle* rect = dynamic_cast<const Rectangle*>(&element))
+				{
+					put("<rect");
+					write_common(element);
+					put_attribute("x", rect->bounds.pos.x);
+					put_attribute("y", rect->bounds.pos.y);
+					put_attribute("width", rect->bounds.dim.width);
+					put_attribute("height", rect->bounds.dim.height);
+					if (rect->corner_radius > 0) put_attribute("rx", rect->corner_radius);
+					put("/>\n");
+				}
+				else if (const Circle* circle = dynamic_cast<const Circle*>(&element))
+				{
+					put("<circle");
+					write_common(element);
+					put_attribute("cx", circle->center.x);
+					put_attribute("cy", circle->center.y);
+					put_attribute("r", circle->radius);
+					put("/>\n");
+				}
+				else if (const Line* line = dynamic_cast<const Line*>(&element))
+				{
+					put("<line");
+					write_common(element);
+					put_attribute("x1", line->start.x);
+					put_attribute("y1", line->start.y);
+					put_attribute("x2", line->end.x);
+					put_attribute("y2", line->end.y);
+					put("/>\n");
+				}
+				else if (const Polygon* polygon = dynamic_cast<const Polygon*>(&element))
+				{
+					put("<polygon");
+					write_common(element);
+					write_points(polygon->points);
+					put("/>\n");
+				}
+				else if (const PolyLine* polyline = dynamic_cast<const PolyLine*>(&element))
+				{
+					put("<polyline");
+					write_common(element);
+					write_points(polyline->points);
+					put("/>\n");
+				}
+				else if (const Path* path = dynamic_cast<const Path*>(&element))
+				{
+					put("<path");
+					write_common(element);
+					write_path_data(*path);
+					put("/>\n");
+				}
+				else if (const Text* text = dynamic_cast<const Text*>(&element))
+				{
+					const Bounds& b = text->bounds;
+					double x = b.pos.x;
+					const char* anchor = "start";
+					if (text->alignment == AlignmentKind::center)
+					{
+						x += b.dim.width / 2;
+						anchor = "middle";
+					}
+					else if (text->alignment == AlignmentKind::end)
+					{
+						x += b.dim.width;
+						anchor = "end";
+					}
+
+					put("<text");
+					write_common(element);
+					put_attribute("x", x);
+					put_attribute("y", b.pos.y + b.dim.height / 2);
+					put(" text-anchor=\""); put(anchor); put("\" dominant-baseline=\"middle\">");
+
+					if (!text->wrap && text->data.find('\n') == std::string::npos)
+					{
+						put_escaped(text->data);
+					}
+					else
+					{
+						// line breaks are taken from the layout engine, svg viewers place the glyphs with their own fonts
+						text::layout(text->data, b, text->alignment, element.resolved_style().font_size, text->wrap, text_layout);
+						const double middle = (text::ASCENT - text::DESCENT) / 2 * text_layout.font_size;
+
+						for (const text::LayoutLine& line : text_layout.lines)
+						{
+							put("<tspan");
+							put_attribute("x", x);
+							put_attribute("y", line.origin.y - middle);
+							put('>');
+							put_escaped(text->data.substr(line.begin, line.end - line.begin));
+							put("</tspan>");
+						}
+					}
+					put("</text>\n");
+				}
+			}
+		};
+
+		/*
+		* \brief convenience function, see SvgWriter::write
+		*/
+		inline void write_svg(const Canvas& canvas, double width, double height, std::ostream& out)
+		{
+			SvgWriter writer(out);
+			writer.write(canvas, width, height);
+		}
+	}
+}
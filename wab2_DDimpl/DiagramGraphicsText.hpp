@@ -0,0 +1,490 @@
+#pragma once
+#include "DiagramGraphics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Text measurement, layout and glyph rasterization for DG::Text
+* -> glyphs come from an embedded 5x9 bitmap font (ASCII, German umlauts, sharp s and euro sign), no font files are needed
+* -> every font name maps to the embedded font, bold and italic are synthesized
+* -> layout breaks lines at '\n' and, if Text::wrap is set, between words so the text fits into Text::bounds
+* -> rasterized glyphs are kept in an LRU cache keyed on codepoint, pixel size and style
+*
+* Font units: one grid cell of the bitmap font is a tenth of the font size
+*/
+namespace DG
+{
+	namespace text
+	{
+		// grid of the bitmap font, rows 0 to 6 are above the baseline, rows 7 and 8 hold descenders
+		constexpr int GLYPH_COLUMNS = 5;
+		constexpr int GLYPH_ROWS = 9;
+		constexpr int BASELINE_ROW = 7;
+
+		// metrics relative to the font size
+		constexpr double UNIT = 0.1;
+		constexpr double ADVANCE = 0.6;
+		constexpr double ASCENT = 0.8;
+		constexpr double DESCENT = 0.2;
+		constexpr double LINE_HEIGHT = 1.2;
+
+		namespace detail
+		{
+			struct BitmapGlyph
+			{
+				uint32_t codepoint;
+
+				// bit 4 is the leftmost column
+				uint8_t rows[GLYPH_ROWS];
+			};
+
+			// U+0020 to U+007E in order, followed by additional glyphs
+			static const BitmapGlyph FONT[] =
+			{
+			{ 0x0020, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // space
+			{ 0x0021, { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00 } }, // !
+			{ 0x0022, { 0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // "
+			{ 0x0023, { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a, 0x00, 0x00 } }, // #
+			{ 0x0024, { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04, 0x00, 0x00 } }, // $
+			{ 0x0025, { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00 } }, // %
+			{ 0x0026, { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d, 0x00, 0x00 } }, // &
+			{ 0x0027, { 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // '
+			{ 0x0028, { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00 } }, // (
+			{ 0x0029, { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00 } }, // )
+			{ 0x002a, { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00, 0x00, 0x00 } }, // *
+			{ 0x002b, { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00, 0x00 } }, // +
+			{ 0x002c, { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08, 0x00, 0x00 } }, // ,
+			{ 0x002d, { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // -
+			{ 0x002e, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00, 0x00 } }, // .
+			{ 0x002f, { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00 } }, // /
+			{ 0x0030, { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e, 0x00, 0x00 } }, // 0
+			{ 0x0031, { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 } }, // 1
+			{ 0x0032, { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 } }, // 2
+			{ 0x0033, { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e, 0x00, 0x00 } }, // 3
+			{ 0x0034, { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02, 0x00, 0x00 } }, // 4
+			{ 0x0035, { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e, 0x00, 0x00 } }, // 5
+			{ 0x0036, { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // 6
+			{ 0x0037, { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00 } }, // 7
+			{ 0x0038, { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // 8
+			{ 0x0039, { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c, 0x00, 0x00 } }, // 9
+			{ 0x003a, { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x00 } }, // :
+			{ 0x003b, { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08, 0x00, 0x00 } }, // ;
+			{ 0x003c, { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00 } }, // <
+			{ 0x003d, { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00 } }, // =
+			{ 0x003e, { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00 } }, // >
+			{ 0x003f, { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00 } }, // ?
+			{ 0x0040, { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e, 0x00, 0x00 } }, // @
+			{ 0x0041, { 0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x00, 0x00 } }, // A
+			{ 0x0042, { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e, 0x00, 0x00 } }, // B
+			{ 0x0043, { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 } }, // C
+			{ 0x0044, { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c, 0x00, 0x00 } }, // D
+			{ 0x0045, { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f, 0x00, 0x00 } }, // E
+			{ 0x0046, { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 } }, // F
+			{ 0x0047, { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f, 0x00, 0x00 } }, // G
+			{ 0x0048, { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00 } }, // H
+			{ 0x0049, { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 } }, // I
+			{ 0x004a, { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c, 0x00, 0x00 } }, // J
+			{ 0x004b, { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00 } }, // K
+			{ 0x004c, { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00, 0x00 } }, // L
+			{ 0x004d, { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00 } }, // M
+			{ 0x004e, { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00 } }, // N
+			{ 0x004f, { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // O
+			{ 0x0050, { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 } }, // P
+			{ 0x0051, { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d, 0x00, 0x00 } }, // Q
+			{ 0x0052, { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11, 0x00, 0x00 } }, // R
+			{ 0x0053, { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e, 0x00, 0x00 } }, // S
+			{ 0x0054, { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 } }, // T
+			{ 0x0055, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // U
+			{ 0x0056, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 } }, // V
+			{ 0x0057, { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00, 0x00 } }, // W
+			{ 0x0058, { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00, 0x00 } }, // X
+			{ 0x0059, { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x00, 0x00 } }, // Y
+			{ 0x005a, { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f, 0x00, 0x00 } }, // Z
+			{ 0x005b, { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e, 0x00, 0x00 } }, // [
+			{ 0x005c, { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00 } }, // backslash
+			{ 0x005d, { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e, 0x00, 0x00 } }, // ]
+			{ 0x005e, { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // ^
+			{ 0x005f, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00 } }, // _
+			{ 0x0060, { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } }, // `
+			{ 0x0061, { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00, 0x00 } }, // a
+			{ 0x0062, { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e, 0x00, 0x00 } }, // b
+			{ 0x0063, { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 } }, // c
+			{ 0x0064, { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f, 0x00, 0x00 } }, // d
+			{ 0x0065, { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00, 0x00 } }, // e
+			{ 0x0066, { 0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08, 0x00, 0x00 } }, // f
+			{ 0x0067, { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x11, 0x0e } }, // g
+			{ 0x0068, { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 } }, // h
+			{ 0x0069, { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 } }, // i
+			{ 0x006a, { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c } }, // j
+			{ 0x006b, { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00 } }, // k
+			{ 0x006c, { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 } }, // l
+			{ 0x006d, { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11, 0x00, 0x00 } }, // m
+			{ 0x006e, { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 } }, // n
+			{ 0x006f, { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // o
+			{ 0x0070, { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 } }, // p
+			{ 0x0071, { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01, 0x01 } }, // q
+			{ 0x0072, { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00 } }, // r
+			{ 0x0073, { 0x00, 0x00, 0x0f, 0x10, 0x0e, 0x01, 0x1e, 0x00, 0x00 } }, // s
+			{ 0x0074, { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00 } }, // t
+			{ 0x0075, { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00, 0x00 } }, // u
+			{ 0x0076, { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 } }, // v
+			{ 0x0077, { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a, 0x00, 0x00 } }, // w
+			{ 0x0078, { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00, 0x00 } }, // x
+			{ 0x0079, { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x11, 0x0e } }, // y
+			{ 0x007a, { 0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 } }, // z
+			{ 0x007b, { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00 } }, // {
+			{ 0x007c, { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 } }, // |
+			{ 0x007d, { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00 } }, // }
+			{ 0x007e, { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00 } }, // ~
+			{ 0x00c4, { 0x11, 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x00, 0x00 } }, // Ä
+			{ 0x00d6, { 0x11, 0x0e, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // Ö
+			{ 0x00dc, { 0x11, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // Ü
+			{ 0x00e4, { 0x0a, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00, 0x00 } }, // ä
+			{ 0x00f6, { 0x0a, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 } }, // ö
+			{ 0x00fc, { 0x0a, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00, 0x00 } }, // ü
+			{ 0x00df, { 0x0c, 0x12, 0x12, 0x14, 0x12, 0x11, 0x16, 0x10, 0x00 } }, // ß
+			{ 0x20ac, { 0x07, 0x08, 0x1e, 0x08, 0x1e, 0x08, 0x07, 0x00, 0x00 } }, // €
+			};
+
+			constexpr size_t ASCII_GLYPHS = 0x7f - 0x20;
+
+			/*
+			* \brief glyph of codepoint, nullptr if the font has none
+			*/
+			inline const BitmapGlyph* find_glyph(uint32_t codepoint)
+			{
+				if (codepoint >= 0x20 && codepoint < 0x7f) return &FONT[codepoint - 0x20];
+
+				for (size_t i = ASCII_GLYPHS; i < sizeof(FONT) / sizeof(FONT[0]); i++)
+				{
+					if (FONT[i].codepoint == codepoint) return &FONT[i];
+				}
+				return nullptr;
+			}
+		}
+
+		/*
+		* \brief decode the UTF-8 sequence at position and advance position. Invalid sequences yield U+FFFD
+		*/
+		inline uint32_t next_codepoint(const std::string& data, size_t& position)
+		{
+			const uint8_t lead = static_cast<uint8_t>(data[position++]);
+			if (lead < 0x80) return lead;
+
+			int length = 0;
+			uint32_t codepoint = 0;
+			if ((lead & 0xe0) == 0xc0) { length = 1; codepoint = lead & 0x1f; }
+			else if ((lead & 0xf0) == 0xe0) { length = 2; codepoint = lead & 0x0f; }
+			else if ((lead & 0xf8) == 0xf0) { length = 3; codepoint = lead & 0x07; }
+			else return 0xfffd;
+
+			for (int i = 0; i < length; i++)
+			{
+				if (position >= data.size() || (static_cast<uint8_t>(data[position]) & 0xc0) != 0x80) return 0xfffd;
+				codepoint = (codepoint << 6) | (static_cast<uint8_t>(data[position++]) & 0x3f);
+			}
+			return codepoint;
+		}
+
+		/*
+		* \brief horizontal advance of codepoint in font units. The embedded font is monospaced
+		*/
+		inline double advance(uint32_t codepoint)
+		{
+			return codepoint == '\n' ? 0 : ADVANCE;
+		}
+
+		/*
+		* \brief width of data[begin, end) in font units
+		*/
+		inline double measure(const std::string& data, size_t begin, size_t end)
+		{
+			double width = 0;
+			while (begin < end) width += advance(next_codepoint(data, begin));
+			return width;
+		}
+
+		/*
+		* \brief one line of a laid out text
+		*/
+		struct LayoutLine
+		{
+			// byte range in Text::data, trailing spaces of wrapped lines excluded
+			size_t begin = 0, end = 0;
+
+			// start of the baseline in local coordinates
+			Point origin;
+
+			double width = 0;
+		};
+
+		struct TextLayout
+		{
+			std::vector<LayoutLine> lines;
+			double font_size = 0;
+
+			void clear()
+			{
+				lines.clear();
+			}
+		};
+
+		/*
+		* \brief break data into lines and place them inside bounds
+		*        Lines are aligned horizontally by alignment, the block of lines is centered vertically
+		* \param wrap: break between words (or inside words longer than a line) to stay within the bounds width
+		*/
+		inline void layout(const std::string& data, const Bounds& bounds, AlignmentKind alignment, double font_size, bool wrap, TextLayout& out)
+		{
+			out.clear();
+			out.font_size = font_size;
+			if (!(font_size > 0)) return;
+
+			const double max_width = bounds.dim.width / font_size;
+			auto push = [&](size_t begin, size_t end)
+			{
+				LayoutLine line;
+				line.begin = begin;
+				line.end = end;
+				line.width = measure(data, begin, end) * font_size;
+				out.lines.push_back(line);
+			};
+
+			size_t paragraph = 0;
+			while (paragraph <= data.size())
+			{
+				size_t paragraph_end = data.find('\n', paragraph);
+				if (paragraph_end == std::string::npos) paragraph_end = data.size();
+
+				size_t line_begin = paragraph;
+				size_t position = paragraph;
+				double width = 0;
+
+				// end of the text before the last space of the current line and start of the next word
+				size_t break_end = std::string::npos, break_resume = 0;
+
+				while (position < paragraph_end)
+				{
+					size_t next = position;
+					const uint32_t codepoint = next_codepoint(data, next);
+
+					if (codepoint == ' ')
+					{
+						// a wrapped line starts with the next word
+						if (position == line_begin && line_begin != paragraph)
+						{
+							line_begin = position = next;
+							continue;
+						}
+						if (break_end == std::string::npos || break_resume != position) break_end = position;
+						break_resume = next;
+					}
+					else if (wrap && width + advance(codepoint) > max_width && position > line_begin)
+					{
+						if (break_end != std::string::npos && break_end > line_begin)
+						{
+							push(line_begin, break_end);
+							line_begin = break_resume;
+						}
+						else
+						{
+							// the word is wider than the line
+							push(line_begin, position);
+							line_begin = position;
+						}
+
+						// measure the carried over part again
+						position = line_begin;
+						width = 0;
+						break_end = std::string::npos;
+						continue;
+					}
+
+					width += advance(codepoint);
+					position = next;
+				}
+				push(line_begin, paragraph_end);
+
+				paragraph = paragraph_end + 1;
+			}
+
+			// place the lines
+			const double line_height = LINE_HEIGHT * font_size;
+			const double top = bounds.pos.y + (bounds.dim.height - line_height * out.lines.size()) / 2;
+			const double baseline = (line_height - (ASCENT + DESCENT) * font_size) / 2 + ASCENT * font_size;
+
+			for (size_t i = 0; i < out.lines.size(); i++)
+			{
+				LayoutLine& line = out.lines.at(i);
+
+				double x = bounds.pos.x;
+				if (alignment == AlignmentKind::center) x += (bounds.dim.width - line.width) / 2;
+				else if (alignment == AlignmentKind::end) x += bounds.dim.width - line.width;
+
+				line.origin = Point{ x, top + line_height * i + baseline };
+			}
+		}
+
+		/*
+		* \brief anti-aliased coverage of one glyph, pixel origin on the baseline at the pen position
+		*/
+		struct GlyphBitmap
+		{
+			// offset of the top left pixel relative to the pen position
+			int left = 0, top = 0;
+			int width = 0, height = 0;
+
+			// row major, 0 to 255
+			std::vector<uint8_t> coverage;
+
+			// pen advance in pixels
+			double advance = 0;
+		};
+
+		/*
+		* \brief rasterize codepoint at pixel_size pixels per em. Unknown codepoints are drawn as '?'
+		*/
+		inline GlyphBitmap rasterize_glyph(uint32_t codepoint, double pixel_size, bool bold, bool italic)
+		{
+			const detail::BitmapGlyph* glyph = detail::find_glyph(codepoint);
+			if (glyph == nullptr) glyph = detail::find_glyph('?');
+
+			GlyphBitmap out;
+			out.advance = advance(codepoint) * pixel_size;
+
+			const double unit = UNIT * pixel_size;
+			const double embolden = bold ? unit / 2 : 0;
+
+			// italic shears rows above the baseline to the right, rows are shifted as a whole
+			auto shift = [&](int row) { return italic ? (BASELINE_ROW - row - 0.5) * unit * 0.2 : 0.0; };
+
+			const double x0 = shift(GLYPH_ROWS - 1), x1 = GLYPH_COLUMNS * unit + embolden + shift(0);
+			const double y0 = -BASELINE_ROW * unit, y1 = (GLYPH_ROWS - BASELINE_ROW) * unit;
+
+			out.left = static_cast<int>(std::floor(x0));
+			out.top = static_cast<int>(std::floor(y0));
+			out.width = static_cast<int>(std::ceil(x1)) - out.left;
+			out.height = static_cast<int>(std::ceil(y1)) - out.top;
+			if (out.width <= 0 || out.height <= 0) return out;
+
+			std::vector<float> area(static_cast<size_t>(out.width) * out.height, 0.f);
+
+			// exact area of every set cell per pixel
+			for (int row = 0; row < GLYPH_ROWS; row++)
+			{
+				const uint8_t bits = glyph->rows[row];
+				if (bits == 0) continue;
+
+				const double cy0 = (row - BASELINE_ROW) * unit - out.top, cy1 = cy0 + unit;
+				for (int column = 0; column < GLYPH_COLUMNS; column++)
+				{
+					if ((bits & (0x10 >> column)) == 0) continue;
+
+					const double cx0 = column * unit + shift(row) - out.left, cx1 = cx0 + unit + embolden;
+					for (int py = std::max(0, static_cast<int>(cy0)); py < std::min(out.height, static_cast<int>(std::ceil(cy1))); py++)
+					{
+						const double h = std::min(cy1, py + 1.0) - std::max(cy0, static_cast<double>(py));
+						if (h <= 0) continue;
+
+						for (int px = std::max(0, static_cast<int>(cx0)); px < std::min(out.width, static_cast<int>(std::ceil(cx1))); px++)
+						{
+							const double w = std::min(cx1, px + 1.0) - std::max(cx0, static_cast<double>(px));
+							if (w > 0) area[static_cast<size_t>(py) * out.width + px] += static_cast<float>(w * h);
+						}
+					}
+				}
+			}
+
+			out.coverage.resize(area.size());
+			for (size_t i = 0; i < area.size(); i++) out.coverage[i] = static_cast<uint8_t>(std::min(area[i], 1.f) * 255.f + 0.5f);
+			return out;
+		}
+
+		/*
+		* \brief least recently used cache of rasterized glyphs
+		*
+		* - keyed on codepoint, pixel size (quarter pixel steps), bold and italic
+		* - the font name is not part of the key, all names map to the embedded font
+		* - not thread safe, one cache per renderer
+		*/
+		class GlyphCache
+		{
+		public:
+			explicit GlyphCache(size_t capacity = 2048)
+				: capacity(std::max<size_t>(capacity, 1))
+			{}
+
+			/*
+			* \brief cached glyph, rasterized on a miss. The reference is valid until the next call
+			*/
+			const GlyphBitmap& get(uint32_t codepoint, double pixel_size, bool bold, bool italic)
+			{
+				const Key key{ codepoint, static_cast<uint32_t>(std::lround(std::max(pixel_size, 0.0) * 4)), static_cast<uint8_t>((bold ? 1 : 0) | (italic ? 2 : 0)) };
+
+				auto it = index.find(key);
+				if (it != index.end())
+				{
+					// move to the front, iterators stay valid
+					entries.splice(entries.begin(), entries, it->second);
+					hits++;
+					return it->second->second;
+				}
+
+				misses++;
+				if (entries.size() >= capacity)
+				{
+					index.erase(entries.back().first);
+					entries.pop_back();
+				}
+
+				entries.emplace_front(key, rasterize_glyph(codepoint, key.size / 4.0, bold, italic));
+				index.emplace(key, entries.begin());
+				return entries.front().second;
+			}
+
+			size_t size() const
+			{
+				return entries.size();
+			}
+
+			void clear()
+			{
+				entries.clear();
+				index.clear();
+			}
+
+			size_t hits = 0, misses = 0;
+
+		private:
+			struct Key
+			{
+				uint32_t codepoint;
+				uint32_t size;
+				uint8_t flags;
+
+				bool operator==(const Key& other) const
+				{
+					return codepoint == other.codepoint && size == other.size && flags == other.flags;
+				}
+			};
+
+			struct KeyHash
+			{
+				size_t operator()(const Key& key) const
+				{
+					return std::hash<uint64_t>()((static_cast<uint64_t>(key.size) << 34) ^ (static_cast<uint64_t>(key.flags) << 32) ^ key.codepoint);
+				}
+			};
+
+			size_t capacity;
+
+			// most recently used first
+			std::list<std::pair<Key, GlyphBitmap>> entries;
+			std::unordered_map<Key, std::list<std::pair<Key, GlyphBitmap>>::iterator, KeyHash> index;
+		};
+	}
+}
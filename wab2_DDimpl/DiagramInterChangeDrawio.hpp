@@ -8,19 +8,51 @@
 * Drawio-Parent: gets resolved into the actual object and will be stored in owning_element
 */
 
+/*
+* \brief drawio style values count as local style: local_style > drawio_style > shared_style
+*/
+inline const std::string* find_drawio_own_style(
+	const DI::DiagramElement* element,
+	const std::unordered_map<std::string, std::string>& drawio_style,
+	const std::string& key)
+{
+	if (element->local_style != nullptr)
+	{
+		if (const std::string* value = element->local_style->find(key)) return value;
+	}
+
+	auto it = drawio_style.find(key);
+	if (it != drawio_style.end()) return &it->second;
+
+	return element->shared_style != nullptr ? element->shared_style->find(key) : nullptr;
+}
+
 /*
 * Drawio-spezifischer Erweiterung des DI-Frameworks
+* drawio_style is part of the style cascade, call touch_style() after changing it
 */
 class DrawioMxcell : public DI::DiagramElement
 {
 public:
 	std::unordered_map<std::string, std::string> drawio_style;
+
+protected:
+	const std::string* find_own_style(const std::string& key) const override
+	{
+		return find_drawio_own_style(this, drawio_style, key);
+	}
 };
 
 class DrawioArrow : public DI::Edge
 {
 public:
 	std::unordered_map<std::string, std::string> drawio_style;
+
+protected:
+	const std::string* find_own_style(const std::string& key) const override
+	{
+		return find_drawio_own_style(this, drawio_style, key);
+	}
 };
 
 
@@ -36,7 +68,7 @@ namespace
 		if (from->Attribute(what.c_str()) == 0) return false;
 
 		const std::string val = from->Attribute(what.c_str());
-		to->local_style->properties.insert({ what, val});
+		to->local_style->set(what, val);
 		return true;
 	}
 
@@ -57,8 +89,7 @@ namespace
 	*/
 	void set_relation(DI::DiagramElement* parent, DI::DiagramElement* child)
 	{
-		parent->owned_elements.push_back(child);
-		child->owning_element = parent;
+		parent->add_owned_element(child);
 	}
 
 	/*
@@ -242,7 +273,11 @@ namespace
 				copy_attr_or_throw(child, arrow, "edge"); // must map to "1"
 
 				// parse style if it exists
-				if (child->Attribute("style") != 0) arrow->drawio_style = parse_style(child->Attribute("style"));
+				if (child->Attribute("style") != 0)
+				{
+					arrow->drawio_style = parse_style(child->Attribute("style"));
+					arrow->touch_style();
+				}
 
 				// if there is a recursive call: use this element as parent
 				parent_next_iter = arrow;
@@ -259,7 +294,11 @@ namespace
 				copy_attr_if_exists(child, cell, "value"); // default label if drawio-attribute-injecion is false
 				copy_attr_if_exists(child, cell, "vertex");
 				// parse style if it exists
-				if (child->Attribute("style") != 0) cell->drawio_style = parse_style(child->Attribute("style"));
+				if (child->Attribute("style") != 0)
+				{
+					cell->drawio_style = parse_style(child->Attribute("style"));
+					cell->touch_style();
+				}
 
 				// if there is a recursive call: use this element as parent
 				parent_next_iter = cell;
@@ -316,20 +355,21 @@ namespace
 				DI::DiagramElement* source = find_node_with(root, "id", id_source);
 
 				// set values if they exist
-				if (target != nullptr) arrow->target = target;
-				else throw std::logic_error("Arrow sarget could not be resolved");
+				if (target == nullptr) throw std::logic_error("Arrow sarget could not be resolved");
+				if (source == nullptr) throw std::logic_error("Arrow source could not be resolved");
 
-				if (target != nullptr) arrow->source = source;
-				else throw std::logic_error("Arrow source could not be resolved");
+				// registers the arrow at both ends, see DiagramElement::incident_edges
+				arrow->connect(source, target);
 
 				// remove keys to reduce redundancy;
-				arrow->local_style->properties.erase("target");
-				arrow->local_style->properties.erase("source");
+				arrow->local_style->erase("target");
+				arrow->local_style->erase("source");
 			}
 
 			// recursion looking for arrows
 			if (node != nullptr && node->owned_elements.size() > 0) iterate_resolve_arrows(node, root);
 		}
+		return true;
 	}
 }
 
@@ -356,6 +396,46 @@ bool parse_drawio_file(const std::string& path, DI::DiagramElement* d_pollute)
 	return success;
 }
 
+/*
+* \brief geometry child (mxGeometry as="geometry") of a drawio cell. nullptr if there is none
+*/
+inline const DI::DiagramElement* find_drawio_geometry(const DI::DiagramElement* cell)
+{
+	for (const DI::DiagramElement* child : cell->owned_elements)
+	{
+		const auto& props = child->local_style->properties;
+		auto it = props.find("as");
+		if (it != props.end() && it->second == "geometry") return child;
+	}
+	return nullptr;
+}
+
+/*
+* \brief bounds of a drawio cell relative to its parent cell. Missing values are 0
+*        Returns false if the cell has no geometry or the geometry is relative (edges)
+*/
+inline bool get_drawio_bounds(const DI::DiagramElement* cell, Bounds& bounds)
+{
+	const DI::DiagramElement* geometry = find_drawio_geometry(cell);
+	if (geometry == nullptr) return false;
+
+	const auto& props = geometry->local_style->properties;
+	auto relative = props.find("relative");
+	if (relative != props.end() && relative->second == "1") return false;
+
+	auto read = [&](const char* key)
+	{
+		auto it = props.find(key);
+		return it != props.end() ? std::stod(it->second) : 0.0;
+	};
+
+	bounds.pos.x = read("x");
+	bounds.pos.y = read("y");
+	bounds.dim.width = read("width");
+	bounds.dim.height = read("height");
+	return true;
+}
+
 std::string generate_drawio_file(DI::Diagram* root)
 {
 	return "drawio file :D";
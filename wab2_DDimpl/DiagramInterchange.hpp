@@ -1,14 +1,49 @@
 #pragma once
 #include "DiagramCommons.hpp"
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <cstdint>
 
 namespace DI
 {
 	//forwards declarations
 	class Style;
+	class Edge;
+
+	namespace detail
+	{
+		/*
+		* \brief unique, increasing revision. Every change of a style source gets a new one, see DiagramElement::style_revision
+		*/
+		inline uint64_t next_revision()
+		{
+			static std::atomic<uint64_t> counter{ 1 };
+			return counter.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		inline std::atomic<uint64_t>& style_epoch_counter()
+		{
+			static std::atomic<uint64_t> epoch{ 1 };
+			return epoch;
+		}
+
+		/*
+		* \brief advanced by every change of a style source. Memoized style revisions stay valid while it is unchanged
+		*/
+		inline uint64_t style_epoch()
+		{
+			return style_epoch_counter().load(std::memory_order_relaxed);
+		}
+
+		inline uint64_t advance_style_epoch()
+		{
+			return style_epoch_counter().fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+	}
 
 	// Every MOF-Based Element
 	class MOFBASE
@@ -29,16 +64,10 @@ namespace DI
 		void foo() {};
 	public:
 
-		~DiagramElement()
-		{
-			// delete all stored diagramElements
-			for (DiagramElement* p : owned_elements)
-			{
-				delete p;
-			}
-
-			// Style will be deleted by strong-pointers
-		}
+		/*
+		* \brief deletes the owned elements. Edges connected to this element lose it as endpoint
+		*/
+		virtual ~DiagramElement();
 
 
 		MOFBASE* md;//depiced model element TODO: what is this
@@ -49,11 +78,63 @@ namespace DI
 		// Childs of this element
 		std::vector<DiagramElement*> owned_elements = {};
 
+		// Edges whose source or target is this element. Maintained by Edge::connect, Edge::disconnect and both destructors
+		std::vector<Edge*> incident_edges = {};
+
 		// IF there are properties overlapping with shared_style: loca_styles values are used first
 		std::unique_ptr<Style> local_style = std::make_unique<Style>();
 
 		// Optional, styls applied on this element
 		std::shared_ptr<Style> shared_style;
+
+		/*
+		* \brief value of key after the cascade: local style > shared style > nearest parent > default. nullptr if nothing sets key
+		*        Memoized per element, the cache is dropped when a style of this element or of its owner chain changed
+		*/
+		const std::string* resolve_style(const std::string& key) const;
+
+		std::string resolve_style_or(const std::string& key, const std::string& fallback) const
+		{
+			const std::string* value = resolve_style(key);
+			return value != nullptr ? *value : fallback;
+		}
+
+		/*
+		* \brief append child to the owned elements and set this element as its owner
+		*/
+		void add_owned_element(DiagramElement* child);
+
+		/*
+		* \brief must be called after local_style or shared_style were replaced, the owner was changed without
+		*        add_owned_element or style values of a subclass changed
+		*/
+		void touch_style()
+		{
+			style_source_revision = detail::next_revision();
+			detail::advance_style_epoch();
+		}
+
+		/*
+		* \brief newest revision of all style sources the cascade of this element reads from. Changes whenever one of them
+		*        changed, elements outside of the owner chain don't affect it
+		*        Memoized until the next style change anywhere, then recomputed from the memo of the owner in O(1)
+		*/
+		uint64_t style_revision() const;
+
+	protected:
+		/*
+		* \brief value of key set on this element only (local and shared style), the first two steps of the cascade
+		*/
+		virtual const std::string* find_own_style(const std::string& key) const;
+
+	private:
+		uint64_t style_source_revision = detail::next_revision();
+
+		mutable std::unordered_map<std::string, const std::string*> style_cache;
+		mutable uint64_t style_cache_revision = 0;
+
+		mutable uint64_t chain_revision = 0;
+		mutable uint64_t chain_epoch = 0;
 	};
 
 
@@ -65,8 +146,43 @@ namespace DI
 	public:
 		std::vector<Point> waypoints;
 
-		DiagramElement* source;
-		DiagramElement* target;
+		// set via connect, otherwise incident_edges of the endpoints are out of date
+		// reset to nullptr when the endpoint is deleted
+		DiagramElement* source = nullptr;
+		DiagramElement* target = nullptr;
+
+		~Edge() override
+		{
+			disconnect();
+		}
+
+		/*
+		* \brief attach the edge to new endpoints and register it in their incident_edges
+		*/
+		void connect(DiagramElement* new_source, DiagramElement* new_target)
+		{
+			disconnect();
+			source = new_source;
+			target = new_target;
+
+			if (source != nullptr) source->incident_edges.push_back(this);
+			if (target != nullptr && target != source) target->incident_edges.push_back(this);
+		}
+
+		/*
+		* \brief remove the edge from the incident_edges of its endpoints and clear them
+		*/
+		void disconnect()
+		{
+			for (DiagramElement* end : { source, target })
+			{
+				if (end == nullptr) continue;
+				std::vector<Edge*>& edges = end->incident_edges;
+				edges.erase(std::remove(edges.begin(), edges.end(), this), edges.end());
+			}
+			source = nullptr;
+			target = nullptr;
+		}
 	};
 
 	class Shape : public DiagramElement
@@ -89,11 +205,140 @@ namespace DI
 	/*
 	* Usage definition
 	* cascading value on local style > cascading alue on shared style > cascading value in of the nearest DiagramElement (in case of parents) > default property value
+	* see DiagramElement::resolve_style
 	*/
 	class Style
 	{
 	public:
+		// call touch() after changing properties directly, set and erase do it themselves
 		std::unordered_map<std::string, std::string> properties;
+
+		const std::string* find(const std::string& key) const
+		{
+			auto it = properties.find(key);
+			return it != properties.end() ? &it->second : nullptr;
+		}
+
+		void set(const std::string& key, const std::string& value)
+		{
+			properties.insert_or_assign(key, value);
+			touch();
+		}
+
+		bool erase(const std::string& key)
+		{
+			const bool erased = properties.erase(key) != 0;
+			if (erased) touch();
+			return erased;
+		}
+
+		/*
+		* \brief default property values, the last step of the cascade
+		*/
+		static const Style& defaults()
+		{
+			return default_style();
+		}
+
+		static void set_default(const std::string& key, const std::string& value)
+		{
+			default_style().set(key, value);
+		}
+
+		/*
+		* \brief invalidates the memoized cascades reading from this style. Must be called after properties were changed without set/erase
+		*/
+		void touch()
+		{
+			_revision = detail::next_revision();
+			detail::advance_style_epoch();
+		}
+
+		uint64_t revision() const
+		{
+			return _revision;
+		}
+
+	private:
+		uint64_t _revision = detail::next_revision();
+
+		static Style& default_style()
+		{
+			static Style style;
+			return style;
+		}
 	};
+
+	inline DiagramElement::~DiagramElement()
+	{
+		for (Edge* edge : incident_edges)
+		{
+			if (edge->source == this) edge->source = nullptr;
+			if (edge->target == this) edge->target = nullptr;
+		}
+
+		// delete all stored diagramElements
+		for (DiagramElement* p : owned_elements)
+		{
+			delete p;
+		}
+
+		// Style will be deleted by strong-pointers
+	}
+
+	inline const std::string* DiagramElement::find_own_style(const std::string& key) const
+	{
+		if (local_style != nullptr)
+		{
+			if (const std::string* value = local_style->find(key)) return value;
+		}
+		if (shared_style != nullptr) return shared_style->find(key);
+		return nullptr;
+	}
+
+	inline uint64_t DiagramElement::style_revision() const
+	{
+		// no style source changed since the last call
+		const uint64_t epoch = detail::style_epoch();
+		if (chain_epoch == epoch) return chain_revision;
+
+		// revisions are unique and increasing, a change anywhere in the chain raises the maximum
+		uint64_t revision = owning_element != nullptr ? owning_element->style_revision() : Style::defaults().revision();
+		revision = std::max(revision, style_source_revision);
+		if (local_style != nullptr) revision = std::max(revision, local_style->revision());
+		if (shared_style != nullptr) revision = std::max(revision, shared_style->revision());
+
+		chain_revision = revision;
+		chain_epoch = epoch;
+		return revision;
+	}
+
+	inline const std::string* DiagramElement::resolve_style(const std::string& key) const
+	{
+		const uint64_t revision = style_revision();
+		if (style_cache_revision != revision)
+		{
+			style_cache.clear();
+			style_cache_revision = revision;
+		}
+
+		auto it = style_cache.find(key);
+		if (it != style_cache.end()) return it->second;
+
+		const std::string* value = find_own_style(key);
+		if (value == nullptr) value = owning_element != nullptr ? owning_element->resolve_style(key) : Style::defaults().find(key);
+
+		style_cache.insert({ key, value });
+		return value;
+	}
+
+	inline void DiagramElement::add_owned_element(DiagramElement* child)
+	{
+		owned_elements.push_back(child);
+		child->owning_element = this;
+
+		// the child inherits from a new parent now
+		child->touch_style();
+	}
 }
 
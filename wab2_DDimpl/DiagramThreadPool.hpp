@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* \brief persistent worker threads for data parallel loops
+*
+* - threads are started once and sleep between loops, a loop doesn't pay for creating threads
+* - every worker starts on its own contiguous share of the indices and steals from the shares of the others when it is done
+* - the calling thread takes part as worker 0
+* - one loop at a time: a loop started while another one runs (from another thread or from inside body) runs on the caller only
+*/
+class ThreadPool
+{
+public:
+	/*
+	* \param threads: number of workers including the calling thread, 0: one per hardware thread
+	*/
+	explicit ThreadPool(unsigned threads = 0)
+		: thread_count(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+		  shares(new Share[thread_count])
+	{
+		for (unsigned worker = 1; worker < thread_count; worker++) workers.emplace_back([this, worker]() { run(worker); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& t : workers) t.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/*
+	* \brief pool with one worker per hardware thread, shared by the renderers and layouts
+	*/
+	static ThreadPool& shared()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	unsigned size() const
+	{
+		return thread_count;
+	}
+
+	/*
+	* \brief call body(index, worker) for every index in [0, count) and wait for all of them
+	*        worker < size() is unique among the threads running at the same time, e.g. to index per thread buffers
+	*        The first exception thrown by body is rethrown here, the remaining indices are skipped
+	* \param max_workers: upper limit of threads working on this loop, 0: size()
+	*/
+	template<typename F>
+	void parallel_for(size_t count, F&& body, unsigned max_workers = 0)
+	{
+		unsigned participants = max_workers != 0 ? std::min(max_workers, thread_count) : thread_count;
+		participants = static_cast<unsigned>(std::min<size_t>(participants, count));
+
+		std::unique_lock<std::mutex> loop(looping, std::try_to_lock);
+		if (participants <= 1 || !loop.owns_lock())
+		{
+			for (size_t i = 0; i < count; i++) body(i, 0);
+			return;
+		}
+
+		for (unsigned worker = 0; worker < participants; worker++)
+		{
+			shares[worker].next = count * worker / participants;
+			shares[worker].end = count * (worker + 1) / participants;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = [&body](size_t i, unsigned worker) { body(i, worker); };
+			active = participants;
+			running = participants - 1;
+			error = nullptr;
+			generation++;
+		}
+		wake.notify_all();
+
+		work(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() { return running == 0; });
+		job = nullptr;
+		if (error != nullptr) std::rethrow_exception(error);
+	}
+
+private:
+	struct Share
+	{
+		std::atomic<size_t> next{ 0 };
+		size_t end = 0;
+	};
+
+	const unsigned thread_count;
+	std::unique_ptr<Share[]> shares;
+	std::vector<std::thread> workers;
+
+	// held by the thread running a loop
+	std::mutex looping;
+
+	// state of the current loop
+	std::mutex mutex;
+	std::condition_variable wake, finished;
+	std::function<void(size_t, unsigned)> job;
+	std::exception_ptr error;
+	uint64_t generation = 0;
+	unsigned active = 0, running = 0;
+	bool stopping = false;
+
+	void work(unsigned worker)
+	{
+		try
+		{
+			// own share first, then the shares of the others
+			for (unsigned k = 0; k < active; k++)
+			{
+				Share& share = shares[(worker + k) % active];
+				for (size_t i = share.next++; i < share.end; i = share.next++) job(i, worker);
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (error == nullptr) error = std::current_exception();
+			for (unsigned k = 0; k < active; k++) shares[k].next = shares[k].end;
+		}
+	}
+
+	void run(unsigned worker)
+	{
+		uint64_t seen = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]() { return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+				if (worker >= active) continue;
+			}
+
+			work(worker);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--running == 0) finished.notify_one();
+		}
+	}
+};
@@ -0,0 +1,60 @@
+#include "BijectiveAlgorithm.h"
+#include <chrono>
+#include <iostream>
+
+/*
+* 5-stage int -> string chains: chain_with of BijeciveModifiers against the fused chain and its type-erased wrapper
+*/
+struct Node
+{
+	std::vector<Node*> children;
+};
+
+template<typename F>
+double measure_ns(size_t count, F&& run)
+{
+	const auto start = std::chrono::steady_clock::now();
+	run();
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+int main()
+{
+	const size_t COUNT = 2000000;
+
+	auto add = make_fused_modifier<Node, int, int>([](int v) { return v + 1; }, [](int v) { return v - 1; });
+	auto twice = make_fused_modifier<Node, int, int>([](int v) { return v * 2; }, [](int v) { return v / 2; });
+	auto sub = make_fused_modifier<Node, int, int>([](int v) { return v - 7; }, [](int v) { return v + 7; });
+	auto to_string = make_fused_modifier<Node, int, std::string>([](int v) { return std::to_string(v); }, [](const std::string& v) { return std::stoi(v); });
+
+	auto fused = add.chain_with(twice).chain_with(sub).chain_with(add).chain_with(to_string);
+	const BijeciveModifier<Node, int, std::string> wrapped = fused.to_modifier();
+
+	BijeciveModifier<Node, int, int> e_add = add.to_modifier(), e_twice = twice.to_modifier(), e_sub = sub.to_modifier();
+	const BijeciveModifier<Node, int, std::string> nested = e_add.chain_with(e_twice).chain_with(e_sub).chain_with(e_add).chain_with(to_string.to_modifier());
+
+	std::vector<int> values(COUNT);
+	for (size_t i = 0; i < COUNT; i++) values.at(i) = static_cast<int>(i);
+	std::vector<std::string> out(COUNT);
+
+	// results are compared so the loops can't be optimized away
+	bool equal = true;
+	const double ns_nested = measure_ns(COUNT, [&]() { for (size_t i = 0; i < COUNT; i++) out[i] = nested.apply(values[i]); });
+	const std::vector<std::string> reference = out;
+	const double ns_fused = measure_ns(COUNT, [&]() { for (size_t i = 0; i < COUNT; i++) out[i] = fused.apply(values[i]); });
+	equal &= out == reference;
+	const double ns_wrapped = measure_ns(COUNT, [&]() { for (size_t i = 0; i < COUNT; i++) out[i] = wrapped.apply(values[i]); });
+	equal &= out == reference;
+
+	std::vector<int> reverted(COUNT);
+	const double ns_nested_revert = measure_ns(COUNT, [&]() { for (size_t i = 0; i < COUNT; i++) reverted[i] = nested.revert(reference[i]); });
+	equal &= reverted == values;
+	const double ns_fused_revert = measure_ns(COUNT, [&]() { for (size_t i = 0; i < COUNT; i++) reverted[i] = fused.revert(reference[i]); });
+	equal &= reverted == values;
+
+	std::cout << "apply   chain_with " << ns_nested << " ns, fused " << ns_fused << " ns, fused as BijeciveModifier " << ns_wrapped << " ns\n";
+	std::cout << "revert  chain_with " << ns_nested_revert << " ns, fused " << ns_fused_revert << " ns\n";
+	std::cout << "results equal: " << equal << '\n';
+	return equal ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "DiagramDrawioLowering.hpp"
+#include "DiagramGraphicsRaster.hpp"
+#include <chrono>
+#include <iostream>
+
+/*
+* Thumbnail throughput of the rasterizer in diagrams per second
+* -> small: test.drawio.xml lowered once, rendered at 300x225
+* -> large: 400 vertices with 300 arrows, rendered at 1024x768
+*/
+namespace
+{
+	DrawioMxcell* add_vertex(DI::DiagramElement* parent, const std::string& id, double x, double y, const std::string& style)
+	{
+		DrawioMxcell* cell = new DrawioMxcell();
+		cell->local_style->set("id", id);
+		cell->local_style->set("vertex", "1");
+		cell->local_style->set("value", id);
+		cell->drawio_style = { { "fillColor", "#dae8fc" }, { "strokeColor", "#6c8ebf" } };
+		if (!style.empty()) cell->drawio_style.insert({ style, "" });
+		cell->touch_style();
+		parent->add_owned_element(cell);
+
+		DI::DiagramElement* geometry = new DI::DiagramElement();
+		geometry->local_style->set("as", "geometry");
+		geometry->local_style->set("x", std::to_string(x));
+		geometry->local_style->set("y", std::to_string(y));
+		geometry->local_style->set("width", "80");
+		geometry->local_style->set("height", "40");
+		cell->add_owned_element(geometry);
+		return cell;
+	}
+
+	void measure(const char* name, const DG::Canvas& canvas, const DG::raster::RenderOptions& options)
+	{
+		// warm up, then render for about a second
+		DG::raster::render(canvas, options);
+
+		size_t count = 0;
+		const auto start = std::chrono::steady_clock::now();
+		double seconds = 0;
+		while (seconds < 1)
+		{
+			DG::raster::render(canvas, options);
+			count++;
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		const std::string threads = options.threads == 0 ? "all" : std::to_string(options.threads);
+		std::cout << name << " " << options.width << "x" << options.height << ", " << threads << " threads: "
+			<< count / seconds << " diagrams/s\n";
+	}
+}
+
+int main()
+{
+	DI::Diagram small_diagram;
+	if (!parse_drawio_file("test.drawio.xml", &small_diagram)) return 1;
+	DG::Canvas small;
+	drawio::DrawioLowering().lower(&small_diagram, small);
+
+	DI::Diagram large_diagram;
+	std::vector<DrawioMxcell*> cells;
+	for (int i = 0; i < 400; i++)
+	{
+		cells.push_back(add_vertex(&large_diagram, std::to_string(i), (i % 20) * 100.0, (i / 20) * 70.0, i % 3 == 0 ? "ellipse" : ""));
+	}
+	for (int i = 0; i < 300; i++)
+	{
+		DrawioArrow* arrow = new DrawioArrow();
+		large_diagram.add_owned_element(arrow);
+		arrow->connect(cells.at(i), cells.at((i * 7 + 1) % cells.size()));
+	}
+	DG::Canvas large;
+	drawio::DrawioLowering().lower(&large_diagram, large);
+
+	for (unsigned threads : { 1u, 0u })
+	{
+		DG::raster::RenderOptions thumb;
+		thumb.width = 300;
+		thumb.height = 225;
+		thumb.view = DG::Matrix::scaling(0.5, 0.5);
+		thumb.threads = threads;
+		measure("small", small, thumb);
+
+		DG::raster::RenderOptions full;
+		full.width = 1024;
+		full.height = 768;
+		full.view = DG::Matrix::scaling(0.5, 0.5);
+		full.threads = threads;
+		measure("large", large, full);
+	}
+	return 0;
+}
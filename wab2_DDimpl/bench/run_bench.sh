@@ -0,0 +1,18 @@
+#!/bin/sh
+# builds every benchmark in this directory with optimizations and runs it from wab2_DDimpl
+# usage: bench/run_bench.sh [extra compiler flags, e.g. -march=native]
+cd "$(dirname "$0")/.." || exit 1
+CXX=${CXX:-g++}
+OUT=${OUT:-/tmp/wab2_bench}
+mkdir -p "$OUT"
+
+failed=0
+for src in bench/*.cpp; do
+	name=$(basename "$src" .cpp)
+	if ! $CXX -std=c++17 -O2 -DNDEBUG -pthread -I. "$@" "$src" tinyxml2.cpp -o "$OUT/$name"; then
+		echo "BUILD FAILED $name"; failed=1; continue
+	fi
+	echo "== $name"
+	"$OUT/$name" || failed=1
+done
+exit $failed
@@ -1,4 +1,5 @@
 #include "BijectiveAlgorithm.h"
+#include "BijectiveAlgorithmCsv.h"
 
 #include "DiagramGraphics.hpp"
 #include "DiagramInterChangeDrawio.hpp"
@@ -61,12 +62,14 @@ bool fillcolor_set(DI::DiagramElement* node, const std::string& value)
 	{
 		auto& style = node_mxcell->drawio_style;
 		style.insert_or_assign("fillColor", value);
+		node->touch_style();
 		return true;
 	}
 	else if (node_arrow != nullptr)
 	{
 		auto& style = node_arrow->drawio_style;
 		style.insert_or_assign("fillColor", value);
+		node->touch_style();
 		return true;
 	}
 
@@ -75,8 +78,7 @@ bool fillcolor_set(DI::DiagramElement* node, const std::string& value)
 
 bool value_set(DI::DiagramElement* node, const std::string& value )
 {
-	auto& style = node->local_style.get()->properties;
-	style.insert_or_assign("value", value);
+	node->local_style->set("value", value);
 
 	return true;
 }
@@ -205,6 +207,10 @@ int main()
 		std::cout << '\n';
 	}
 
+	// Tabelle zeilenweise als CSV ausgeben
+	std::cout << "CSV dump:\n";
+	write_csv(alg, std::cout);
+
 	// Diese Werte sollen zur Aktualisierung verwendet werden
 	std::vector<std::vector<std::string>> new_vals = {
 		{"ID-Spalte", "3", "4", "6", "7"},
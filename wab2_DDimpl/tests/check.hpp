@@ -0,0 +1,28 @@
+#pragma once
+#include <iostream>
+
+/*
+* Minimal assertion helper for the test drivers in this directory
+* Every driver is a standalone program, a failed CHECK is reported and turns the exit code into 1
+*/
+namespace test
+{
+	inline int& failures()
+	{
+		static int count = 0;
+		return count;
+	}
+
+	inline void fail(const char* expr, const char* file, int line)
+	{
+		std::cerr << file << ":" << line << ": CHECK(" << expr << ") failed\n";
+		failures()++;
+	}
+
+	inline int result()
+	{
+		return failures() == 0 ? 0 : 1;
+	}
+}
+
+#define CHECK(expr) do { if (!(expr)) test::fail(#expr, __FILE__, __LINE__); } while (false)
@@ -0,0 +1,17 @@
+#!/bin/sh
+# builds every test driver in this directory against tinyxml2 and runs it from wab2_DDimpl
+# usage: tests/run_tests.sh [extra compiler flags, e.g. -fsanitize=address]
+cd "$(dirname "$0")/.." || exit 1
+CXX=${CXX:-g++}
+OUT=${OUT:-/tmp/wab2_tests}
+mkdir -p "$OUT"
+
+failed=0
+for src in tests/*.cpp; do
+	name=$(basename "$src" .cpp)
+	if ! $CXX -std=c++17 -Wall -Wextra -O1 -g -pthread -I. "$@" "$src" tinyxml2.cpp -o "$OUT/$name"; then
+		echo "BUILD FAILED $name"; failed=1; continue
+	fi
+	if "$OUT/$name"; then echo "ok     $name"; else echo "FAILED $name"; failed=1; fi
+done
+exit $failed
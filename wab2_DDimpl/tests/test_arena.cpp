@@ -0,0 +1,93 @@
+#include "DiagramGraphics.hpp"
+#include "tests/check.hpp"
+
+/*
+* Arena allocation of DG object graphs
+*/
+using namespace DG;
+
+namespace
+{
+	struct Tracked
+	{
+		std::vector<int>* log;
+		int id;
+
+		Tracked(std::vector<int>* log, int id) : log(log), id(id) {}
+
+		~Tracked()
+		{
+			log->push_back(id);
+		}
+	};
+}
+
+int main()
+{
+	// destructors run newest first, objects are aligned
+	{
+		std::vector<int> log;
+		{
+			Arena arena;
+			for (int i = 0; i < 3; i++) arena.create<Tracked>(&log, i);
+
+			char* c = arena.create<char>('x');
+			double* d = arena.create<double>(1.5);
+			CHECK(*c == 'x' && *d == 1.5);
+			CHECK(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0);
+
+			arena.release();
+			CHECK((log == std::vector<int>{ 2, 1, 0 }));
+
+			log.clear();
+			arena.create<Tracked>(&log, 7);
+		}
+		// the destructor of the arena releases the remaining objects
+		CHECK((log == std::vector<int>{ 7 }));
+	}
+
+	// blocks grow on demand, release keeps one block for reuse
+	{
+		Arena arena;
+		CHECK(arena.capacity() == 0);
+
+		arena.create<int>(1);
+		CHECK(arena.capacity() == Arena::BLOCK_SIZE);
+
+		for (int i = 0; i < 100000; i++) arena.create<int>(i);
+		CHECK(arena.capacity() > Arena::BLOCK_SIZE);
+
+		// oversized objects get their own block
+		struct Large { char data[3 * Arena::BLOCK_SIZE]; };
+		arena.create<Large>();
+		CHECK(arena.capacity() > 4 * Arena::BLOCK_SIZE);
+
+		arena.release();
+		CHECK(arena.capacity() == Arena::BLOCK_SIZE);
+	}
+
+	// rebuilding a canvas reuses its memory
+	{
+		Canvas canvas;
+		const Rectangle* first = nullptr;
+		size_t capacity = 0;
+		for (int round = 0; round < 3; round++)
+		{
+			canvas.clear();
+			for (int i = 0; i < 100; i++)
+			{
+				Rectangle* rect = canvas.create<Rectangle>();
+				rect->bounds = Bounds{ Point{ double(i), 0 }, Dimension{ 1, 1 } };
+				canvas.add_member(rect);
+				if (i == 0 && round == 0) first = rect;
+				if (i == 0) CHECK(rect == first);
+			}
+			if (round == 0) capacity = canvas.arena().capacity();
+			CHECK(canvas.arena().capacity() == capacity);
+			CHECK(canvas.members.size() == 100);
+			CHECK(canvas.world_bounds().x1 == 100);
+		}
+	}
+
+	return test::result();
+}
@@ -0,0 +1,138 @@
+#include "BijectiveAlgorithmCsv.h"
+#include "tests/check.hpp"
+#include <sstream>
+
+/*
+* CSV export and import of a BijectiveAlgorithm table over a flat list of records
+*/
+struct Record
+{
+	int id = 0;
+	std::string name;
+	std::vector<Record*> children;
+};
+
+struct Fixture
+{
+	Record root;
+	std::vector<Record> records;
+
+	SelectiveView<Record> view{ [](const Record* node) { return node->children; } };
+	BijectiveAlgorithm<Record> alg{ view };
+
+	BijeciveModifier<Record, int, std::string> m_int_to_str{ [](int i) { return std::to_string(i); }, [](const std::string& s) { return std::stoi(s); } };
+	BijeciveModifier<Record, std::string, std::string> m_passthrough = BijeciveModifier<Record, std::string, std::string>::passthrough([](const std::string& s) { return s; });
+
+	Column<Record, int>* col_id = nullptr;
+	Column<Record, std::string>* col_name = nullptr;
+
+	Fixture(size_t count)
+		: records(count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			records.at(i).id = static_cast<int>(i);
+			records.at(i).name = "n" + std::to_string(i);
+			root.children.push_back(&records.at(i));
+		}
+		alg.view.apply_filter(&root, {});
+
+		auto p_id = alg.make_path<int>([](const Record* r) { return r->id; }, [](Record* r, const int& v) { r->id = v; return true; });
+		auto p_name = alg.make_path<std::string>([](const Record* r) { return r->name; }, [](Record* r, const std::string& v) { r->name = v; return true; });
+
+		col_id = alg.make_column(p_id, m_int_to_str, "ID");
+		col_name = alg.make_column(p_name, m_passthrough, "Name");
+		alg.register_column(col_id);
+		alg.register_column(col_name);
+	}
+
+	~Fixture()
+	{
+		delete col_id;
+		delete col_name;
+	}
+
+	std::string names() const
+	{
+		std::string ret;
+		for (const Record& r : records) ret += r.name + ";";
+		return ret;
+	}
+};
+
+bool sync(Fixture& f, const std::string& csv, size_t chunk_size = 4096)
+{
+	std::istringstream in(csv);
+	return sync_with_csv(f.alg, in, CsvDialect::csv(), chunk_size);
+}
+
+int main()
+{
+	// quoting round trip
+	{
+		Fixture f(3);
+		f.records.at(1).name = "a,\"b\"\nc";
+
+		std::ostringstream out;
+		write_csv(f.alg, out);
+		CHECK(out.str() == "ID,Name\r\n0,n0\r\n1,\"a,\"\"b\"\"\nc\"\r\n2,n2\r\n");
+
+		Fixture g(3);
+		CHECK(sync(g, out.str(), 2));
+		CHECK(g.names() == f.names());
+	}
+
+	// columns are matched by header, rows by position
+	{
+		Fixture f(4);
+		CHECK(sync(f, "Name,ID\nx,0\ny,1\nz,2\nw,3\n", 3));
+		CHECK(f.names() == "x;y;z;w;");
+	}
+
+	// the header has to be a permutation of the column headers
+	{
+		Fixture f(2);
+		CHECK(!sync(f, "ID,ID\n0,0\n1,1\n"));
+		CHECK(!sync(f, "ID\n0\n1\n"));
+		CHECK(!sync(f, "ID,Name,Name\n0,a,a\n1,b,b\n"));
+		CHECK(!sync(f, "ID,Other\n0,a\n1,b\n"));
+		CHECK(f.names() == "n0;n1;");
+	}
+
+	// wrong row count
+	{
+		Fixture f(3);
+		CHECK(!sync(f, "ID,Name\n0,a\n1,b\n"));
+		CHECK(!sync(f, "ID,Name\n0,a\n1,b\n2,c\n3,d\n"));
+		CHECK(f.names() == "n0;n1;n2;");
+	}
+
+	// a value rejected in a later chunk leaves the rows of earlier chunks untouched
+	{
+		Fixture f(4);
+		CHECK(!sync(f, "ID,Name\n0,a\n1,b\n2,c\n007,d\n", 1));
+		CHECK(f.names() == "n0;n1;n2;n3;");
+	}
+
+	// a row renamed to the existing value of another row breaks bijectivity
+	{
+		Fixture f(4);
+		CHECK(!sync(f, "ID,Name\n0,n0\n1,n3\n2,n2\n3,n3\n", 2));
+		CHECK(!sync(f, "ID,Name\n0,n0\n1,n1\n2,n2\n0,n3\n", 1));
+		CHECK(f.names() == "n0;n1;n2;n3;");
+		CHECK(f.records.at(3).id == 3);
+
+		// renaming both rows at once is fine
+		CHECK(sync(f, "ID,Name\n0,n0\n1,n3\n2,n2\n3,n1\n", 2));
+		CHECK(f.names() == "n0;n3;n2;n1;");
+	}
+
+	// no columns
+	{
+		Fixture f(2);
+		f.alg.columns.clear();
+		CHECK(!sync(f, "\n"));
+	}
+
+	return test::result();
+}
@@ -0,0 +1,52 @@
+#include "BijectiveAlgorithm.h"
+#include "tests/check.hpp"
+
+/*
+* Compile-time modifier chains and their conversion into BijeciveModifier
+*/
+struct Node
+{
+	std::vector<Node*> children;
+};
+
+int main()
+{
+	auto add = make_fused_modifier<Node, int, int>([](int v) { return v + 1; }, [](int v) { return v - 1; });
+	auto twice = make_fused_modifier<Node, int, int>([](int v) { return v * 2; }, [](int v) { return v / 2; });
+	auto to_string = make_fused_modifier<Node, int, std::string>([](int v) { return std::to_string(v); }, [](const std::string& v) { return std::stoi(v); });
+	BijeciveModifier<Node, int, int> erased([](int v) { return v + 3; }, [](int v) { return v - 3; });
+
+	// ((1 + 1) * 2 + 3) + 1 = 8
+	auto chain = add.chain_with(twice).chain_with(erased).chain_with(add).chain_with(to_string);
+	CHECK(chain.apply(1) == "8");
+	CHECK(chain.revert("8") == 1);
+
+	// same pipeline built from type-erased stages
+	BijeciveModifier<Node, int, int> e_add = add.to_modifier();
+	BijeciveModifier<Node, int, int> e_twice = twice.to_modifier();
+	BijeciveModifier<Node, int, std::string> e_to_string = to_string.to_modifier();
+	auto erased_chain = e_add.chain_with(e_twice).chain_with(erased).chain_with(e_add).chain_with(e_to_string);
+
+	const BijeciveModifier<Node, int, std::string> converted = chain;
+	const BijeciveModifier<Node, int, std::string> wrapped = chain.to_modifier();
+
+	std::vector<int> values;
+	for (int i = -50; i <= 50; i++) values.push_back(i);
+
+	const std::vector<std::string> expected = erased_chain.apply_batch(values);
+	CHECK(converted.apply_batch(values) == expected);
+	CHECK(wrapped.apply_batch(values) == expected);
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		CHECK(chain.apply(values.at(i)) == expected.at(i));
+		CHECK(chain.revert(expected.at(i)) == values.at(i));
+	}
+	CHECK(wrapped.revert_batch(expected) == values);
+
+	// chaining a copy leaves the original chain untouched
+	auto longer = chain.chain_with(make_fused_modifier<Node, std::string, std::string>([](const std::string& s) { return s + "!"; }, [](const std::string& s) { return s.substr(0, s.size() - 1); }));
+	CHECK(longer.apply(1) == "8!");
+	CHECK(chain.apply(1) == "8");
+
+	return test::result();
+}
@@ -0,0 +1,216 @@
+#include "DiagramGraphicsGeometry.hpp"
+#include "tests/check.hpp"
+
+/*
+* Flattening of curves, arcs and paths into polylines
+*/
+using namespace DG;
+
+namespace
+{
+	double distance_to_segment(const Point& p, const Point& a, const Point& b)
+	{
+		const double dx = b.x - a.x, dy = b.y - a.y;
+		const double length = dx * dx + dy * dy;
+		const double t = length > 0 ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length, 0.0, 1.0) : 0;
+		return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+	}
+
+	/*
+	* \brief summed absolute area of the polygons
+	*/
+	double area(const std::vector<Point>& points, const std::vector<size_t>& ends)
+	{
+		double total = 0;
+		size_t begin = 0;
+		for (size_t end : ends)
+		{
+			double twice = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				const Point& p = points[i];
+				const Point& q = points[i + 1 < end ? i + 1 : begin];
+				twice += p.x * q.y - q.x * p.y;
+			}
+			total += std::abs(twice) / 2;
+			begin = end;
+		}
+		return total;
+	}
+
+	/*
+	* \brief largest distance between the exact curve and the polyline start + points
+	*/
+	template<typename Curve>
+	double max_deviation(const Point& start, const std::vector<Point>& points, Curve curve)
+	{
+		double deviation = 0;
+		for (int i = 0; i <= 1000; i++)
+		{
+			const Point p = curve(i / 1000.0);
+			double nearest = distance_to_segment(p, start, points.front());
+			for (size_t k = 1; k < points.size(); k++) nearest = std::min(nearest, distance_to_segment(p, points[k - 1], points[k]));
+			deviation = std::max(deviation, nearest);
+		}
+		return deviation;
+	}
+}
+
+int main()
+{
+	// cubic curves stay within tolerance, the segment count follows the tolerance
+	{
+		const Point p0{ 0, 0 }, p1{ 0, 100 }, p2{ 100, 100 }, p3{ 100, 0 };
+		auto cubic = [&](double t)
+		{
+			const double u = 1 - t;
+			return Point{ u * u * u * p0.x + 3 * u * u * t * p1.x + 3 * u * t * t * p2.x + t * t * t * p3.x,
+				u * u * u * p0.y + 3 * u * u * t * p1.y + 3 * u * t * t * p2.y + t * t * t * p3.y };
+		};
+
+		std::vector<Point> coarse, fine;
+		geometry::flatten_cubic(p0, p1, p2, p3, 0.25, coarse);
+		geometry::flatten_cubic(p0, p1, p2, p3, 0.01, fine);
+
+		CHECK(coarse.back().x == p3.x && coarse.back().y == p3.y);
+		CHECK(max_deviation(p0, coarse, cubic) <= 0.25);
+		CHECK(max_deviation(p0, fine, cubic) <= 0.01);
+		CHECK(coarse.size() < fine.size());
+		CHECK(coarse.size() <= 32);
+
+		// straight curves need a single segment
+		std::vector<Point> straight;
+		geometry::flatten_cubic(Point{ 0, 0 }, Point{ 1, 1 }, Point{ 2, 2 }, Point{ 3, 3 }, 0.01, straight);
+		CHECK(straight.size() == 1);
+	}
+
+	// quadratic curves
+	{
+		const Point p0{ 0, 0 }, p1{ 50, 100 }, p2{ 100, 0 };
+		auto quadratic = [&](double t)
+		{
+			const double u = 1 - t;
+			return Point{ u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x, u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y };
+		};
+
+		std::vector<Point> points;
+		geometry::flatten_quadratic(p0, p1, p2, 0.1, points);
+		CHECK(max_deviation(p0, points, quadratic) <= 0.1);
+	}
+
+	// arcs are sampled on the ellipse in sweep direction
+	{
+		EllipticalArcTo arc;
+		arc.point = Point{ 2, 0 };
+		arc.radii = Dimension{ 1, 1 };
+		arc.sweep = true;
+
+		std::vector<Point> points;
+		geometry::flatten_arc(Point{ 0, 0 }, arc, arc.point, 0.01, points);
+		CHECK(points.size() > 4);
+		for (const Point& p : points) CHECK(std::abs(std::hypot(p.x - 1, p.y) - 1) < 1e-9);
+		CHECK(points[points.size() / 2].y < 0);
+
+		points.clear();
+		arc.sweep = false;
+		geometry::flatten_arc(Point{ 0, 0 }, arc, arc.point, 0.01, points);
+		CHECK(points[points.size() / 2].y > 0);
+
+		// degenerate radii become a straight line
+		points.clear();
+		arc.radii = Dimension{ 0, 0 };
+		geometry::flatten_arc(Point{ 0, 0 }, arc, arc.point, 0.01, points);
+		CHECK(points.size() == 1);
+	}
+
+	// paths are flattened into contours, relative commands start at the current point
+	{
+		auto relative = [](auto command)
+		{
+			command.relative = true;
+			return command;
+		};
+
+		Path path;
+		MoveTo first;
+		first.point = Point{ 10, 10 };
+		LineTo right;
+		right.point = Point{ 10, 0 };
+		LineTo down;
+		down.point = Point{ 0, 10 };
+		MoveTo second;
+		second.point = Point{ 50, 50 };
+		QuadraticCurveTo curve;
+		curve.control = Point{ 5, 10 };
+		curve.point = Point{ 10, 0 };
+		path.commands = { first, relative(right), relative(down), ClosePath(), relative(second), relative(curve) };
+
+		CHECK(!is_relative(path.commands[0]) && is_relative(path.commands[1]));
+		CHECK(std::holds_alternative<ClosePath>(path.commands[3]));
+
+		geometry::FlatPath flat;
+		geometry::flatten(path, 0.1, flat);
+		CHECK(flat.contour_count() == 2);
+		CHECK(flat.closed[0] && !flat.closed[1]);
+		CHECK(flat.contour_size(0) == 3);
+
+		const Point* triangle = flat.contour_data(0);
+		CHECK(triangle[1].x == 20 && triangle[1].y == 10);
+		CHECK(triangle[2].x == 20 && triangle[2].y == 20);
+
+		// the second subpath is relative to the start of the closed one
+		const Point* bow = flat.contour_data(1);
+		const size_t bow_size = flat.contour_size(1);
+		CHECK(bow[0].x == 60 && bow[0].y == 60);
+		CHECK(bow[bow_size - 1].x == 70 && bow[bow_size - 1].y == 60);
+		CHECK(bow_size > 2);
+
+		// flattening again reuses the buffers
+		const Point* buffer = flat.points.data();
+		geometry::flatten(path, 0.1, flat);
+		CHECK(flat.points.data() == buffer && flat.contour_count() == 2);
+	}
+
+	// clipping against rectangles and arbitrary polygons
+	{
+		const std::vector<Point> square = { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } };
+		const std::vector<size_t> square_ends = { 4 };
+
+		std::vector<Point> out;
+		std::vector<size_t> out_ends;
+		BoundingBox rect;
+		rect.add(Point{ 5, -5 });
+		rect.add(Point{ 20, 4 });
+		geometry::clip_rectangle(square, square_ends, rect, out, out_ends);
+		CHECK(std::abs(area(out, out_ends) - 20) < 1e-9);
+
+		geometry::Clipper clipper;
+		const std::vector<Point> shifted = { { 5, 5 }, { 15, 5 }, { 15, 15 }, { 5, 15 } };
+		clipper.intersect(square, square_ends, shifted, square_ends, out, out_ends);
+		CHECK(std::abs(area(out, out_ends) - 25) < 1e-9);
+
+		const std::vector<Point> far_away = { { 50, 50 }, { 60, 50 }, { 60, 60 } };
+		clipper.intersect(square, square_ends, far_away, { 3 }, out, out_ends);
+		CHECK(out_ends.empty());
+
+		// self intersecting star, the nonzero rule fills the inner pentagon as well
+		std::vector<Point> star, circle;
+		for (int i = 0; i < 5; i++)
+		{
+			const double t = -geometry::PI / 2 + i * 4 * geometry::PI / 5;
+			star.push_back(Point{ 40 * std::cos(t), 40 * std::sin(t) });
+		}
+		for (int i = 0; i < 256; i++)
+		{
+			const double t = i * 2 * geometry::PI / 256;
+			circle.push_back(Point{ 100 * std::cos(t), 100 * std::sin(t) });
+		}
+		clipper.intersect(star, { 5 }, circle, { 256 }, out, out_ends);
+
+		// star with outer radius R and inner radius r: area = 5 * R * r * sin(36 deg)
+		const double inner = 40 * std::cos(2 * geometry::PI / 5) / std::cos(geometry::PI / 5);
+		CHECK(std::abs(area(out, out_ends) - 5 * 40 * inner * std::sin(geometry::PI / 5)) < 1e-6);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,158 @@
+#include "DiagramGraphics.hpp"
+#include "tests/check.hpp"
+
+/*
+* Cached state of DG elements: matrices, bounds and styles, and their invalidation
+*/
+using namespace DG;
+
+namespace
+{
+	bool near(const Point& p, double x, double y, double tolerance = 1e-9)
+	{
+		return std::abs(p.x - x) <= tolerance && std::abs(p.y - y) <= tolerance;
+	}
+}
+
+int main()
+{
+	// world matrices are cached and follow changes of the owner chain
+	{
+		Canvas canvas;
+		Group* group = canvas.create<Group>();
+		Rectangle* rect = canvas.create<Rectangle>();
+		canvas.add_member(group);
+		group->add_member(rect);
+
+		Translate* move = canvas.create<Translate>();
+		move->x_delta = 10;
+		move->y_delta = 0;
+		Scale* scale = canvas.create<Scale>();
+		scale->x_factor = 2;
+		scale->y_factor = 2;
+
+		canvas.transforms.push_back(move);
+		canvas.invalidate_transform();
+		group->transforms.push_back(scale);
+		group->invalidate_transform();
+		CHECK(near(rect->world_matrix() * Point{ 1, 1 }, 12, 2));
+
+		// a cached matrix is returned by reference and stays put until invalidated
+		const Matrix* cached = &rect->world_matrix();
+		CHECK(cached == &rect->world_matrix());
+
+		const uint64_t revision = rect->revision();
+		move->x_delta = 20;
+		canvas.invalidate_transform();
+		CHECK(rect->revision() != revision);
+		CHECK(near(rect->world_matrix() * Point{ 1, 1 }, 22, 2));
+
+		// moving the element to another owner
+		group->members.clear();
+		canvas.add_member(rect);
+		CHECK(near(rect->world_matrix() * Point{ 1, 1 }, 21, 1));
+	}
+
+	// bounds are tight around curves, include the stroke and follow geometry changes
+	{
+		Canvas canvas;
+		Group* group = canvas.create<Group>();
+		canvas.add_member(group);
+
+		Path* path = canvas.create<Path>();
+		MoveTo move;
+		move.point = Point{ 0, 0 };
+		CubicCurveTo curve;
+		curve.control_start = Point{ 0, 100 };
+		curve.control_end = Point{ 100, 100 };
+		curve.point = Point{ 100, 0 };
+		path->commands = { move, curve };
+		group->add_member(path);
+
+		// the curve reaches 75, not the control points at 100
+		const BoundingBox& curve_box = path->local_bounds();
+		CHECK(curve_box.x0 == 0 && curve_box.x1 == 100);
+		CHECK(std::abs(curve_box.y0) < 1e-9 && std::abs(curve_box.y1 - 75) < 1e-9);
+
+		Rectangle* rect = canvas.create<Rectangle>();
+		rect->bounds = Bounds{ Point{ 200, 10 }, Dimension{ 20, 30 } };
+		rect->s_local.push_back(Style().set_stroke_color(Color(0, 0, 0)).set_stroke_width(4));
+		group->add_member(rect);
+
+		const BoundingBox& rect_box = rect->local_bounds();
+		CHECK(rect_box.x0 == 198 && rect_box.y0 == 8 && rect_box.x1 == 222 && rect_box.y1 == 42);
+
+		Translate* move_group = canvas.create<Translate>();
+		move_group->x_delta = 5;
+		move_group->y_delta = 5;
+		group->transforms.push_back(move_group);
+		group->invalidate_transform();
+
+		const BoundingBox& group_box = group->world_bounds();
+		CHECK(group_box.x0 == 5 && group_box.x1 == 227);
+		CHECK(group_box.y0 == 5 && group_box.y1 == 80);
+
+		// geometry changes propagate to the owner chain
+		rect->bounds.dim.height = 100;
+		rect->invalidate_bounds();
+		CHECK(group->world_bounds().y1 == 117);
+		CHECK(canvas.world_bounds().y1 == 117);
+
+		// only world bounds were computed, the local bounds of the owners are still dirty
+		rect->bounds.dim.height = 30;
+		rect->invalidate_bounds();
+		CHECK(canvas.world_bounds().y1 == 80);
+
+		// elements referenced only by markers or clip paths do not count
+		rect->s_local.clear();
+		rect->invalidate_style();
+		ClipPath* clip = canvas.create<ClipPath>();
+		Rectangle* far_away = canvas.create<Rectangle>();
+		far_away->bounds = Bounds{ Point{ 1000, 1000 }, Dimension{ 1, 1 } };
+		clip->add_member(far_away);
+		group->add_member(clip);
+		CHECK(group->world_bounds().x1 == 225 && group->world_bounds().y1 == 80);
+	}
+
+	// the style cascade is resolved once per element and follows style changes down the owner chain
+	{
+		Canvas canvas;
+		canvas.package_styles.push_back(Style().set_stroke_color(Color(0, 0, 255)).set_stroke_width(2));
+
+		Group* group = canvas.create<Group>();
+		group->s_shared.push_back(&canvas.package_styles.back());
+		group->s_local.push_back(Style().set_fill_color(Color(255, 0, 0)));
+		canvas.add_member(group);
+
+		Rectangle* rect = canvas.create<Rectangle>();
+		rect->s_local.push_back(Style().set_stroke_width(6));
+		group->add_member(rect);
+
+		const ResolvedStyle& style = rect->resolved_style();
+		CHECK(&style == &rect->resolved_style());
+		CHECK(style.has_fill_color && style.fill_color == Color(255, 0, 0));
+		CHECK(style.has_stroke && style.stroke_color == Color(0, 0, 255));
+		CHECK(style.stroke_width == 6);
+
+		// local styles win over shared ones
+		group->s_local.push_back(Style().set_stroke_color(Color(0, 255, 0)));
+		group->invalidate_style();
+		CHECK(rect->resolved_style().stroke_color == Color(0, 255, 0));
+
+		// changed package styles reach every element after invalidating the canvas
+		group->s_local.pop_back();
+		canvas.package_styles.back().set_stroke_color(Color(10, 20, 30));
+		canvas.invalidate_style();
+		CHECK(rect->resolved_style().stroke_color == Color(10, 20, 30));
+
+		// the stroke width is part of the bounds
+		rect->bounds = Bounds{ Point{ 0, 0 }, Dimension{ 10, 10 } };
+		rect->invalidate_bounds();
+		CHECK(canvas.world_bounds().x1 == 13);
+		rect->s_local.clear();
+		rect->invalidate_style();
+		CHECK(canvas.world_bounds().x1 == 11);
+	}
+
+	return test::result();
+}
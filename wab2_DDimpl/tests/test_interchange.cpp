@@ -0,0 +1,113 @@
+#include "DiagramInterChangeDrawio.hpp"
+#include "tests/check.hpp"
+#include <chrono>
+
+/*
+* DI style cascade and its memoization
+*/
+int main()
+{
+	// cascade: local style > drawio style > shared style > owner > defaults
+	{
+		DI::Diagram root;
+		DrawioMxcell* parent = new DrawioMxcell();
+		DrawioMxcell* child = new DrawioMxcell();
+		root.add_owned_element(parent);
+		parent->add_owned_element(child);
+
+		DI::Style::set_default("test.key", "default");
+		CHECK(child->resolve_style_or("test.key", "") == "default");
+
+		parent->local_style->set("test.key", "parent");
+		CHECK(child->resolve_style_or("test.key", "") == "parent");
+
+		child->shared_style = std::make_shared<DI::Style>();
+		child->shared_style->set("test.key", "shared");
+		child->touch_style();
+		CHECK(child->resolve_style_or("test.key", "") == "shared");
+
+		child->drawio_style.insert_or_assign("test.key", "drawio");
+		child->touch_style();
+		CHECK(child->resolve_style_or("test.key", "") == "drawio");
+
+		child->local_style->set("test.key", "local");
+		CHECK(child->resolve_style_or("test.key", "") == "local");
+
+		child->local_style->erase("test.key");
+		CHECK(child->resolve_style_or("test.key", "") == "drawio");
+
+		// changed without set/erase
+		child->shared_style->properties.at("test.key") = "changed";
+		child->shared_style->touch();
+		child->drawio_style.clear();
+		child->touch_style();
+		CHECK(child->resolve_style_or("test.key", "") == "changed");
+
+		CHECK(root.resolve_style("missing.key") == nullptr);
+	}
+
+	// edits only invalidate the memos of their own subtree
+	{
+		DI::Diagram root;
+		DI::Shape* left = new DI::Shape();
+		DI::Shape* right = new DI::Shape();
+		DI::Shape* leaf = new DI::Shape();
+		root.add_owned_element(left);
+		root.add_owned_element(right);
+		left->add_owned_element(leaf);
+
+		right->local_style->set("color", "red");
+		CHECK(right->resolve_style_or("color", "") == "red");
+		CHECK(leaf->resolve_style("color") == nullptr);
+
+		const uint64_t leaf_revision = leaf->style_revision();
+		const uint64_t right_revision = right->style_revision();
+
+		right->local_style->set("color", "blue");
+		CHECK(leaf->style_revision() == leaf_revision);
+		CHECK(right->style_revision() != right_revision);
+		CHECK(right->resolve_style_or("color", "") == "blue");
+
+		left->local_style->set("color", "green");
+		CHECK(leaf->style_revision() != leaf_revision);
+		CHECK(leaf->resolve_style_or("color", "") == "green");
+
+		// moving the leaf changes what it inherits
+		left->owned_elements.clear();
+		right->add_owned_element(leaf);
+		CHECK(leaf->resolve_style_or("color", "") == "blue");
+	}
+
+	// memoized lookups don't walk the owner chain, deep elements are as fast as shallow ones
+	{
+		DI::Diagram root;
+		root.local_style->set("deep.key", "root");
+		DI::DiagramElement* shallow = new DI::Shape();
+		root.add_owned_element(shallow);
+		DI::DiagramElement* leaf = &root;
+		for (int i = 0; i < 2000; i++)
+		{
+			DI::DiagramElement* child = new DI::Shape();
+			leaf->add_owned_element(child);
+			leaf = child;
+		}
+		CHECK(leaf->resolve_style_or("deep.key", "") == "root");
+
+		auto lookups = [](const DI::DiagramElement* element)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < 20000; i++) CHECK(element->resolve_style("deep.key") != nullptr);
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+		lookups(shallow);
+		const double shallow_time = lookups(shallow);
+		const double deep_time = lookups(leaf);
+		CHECK(deep_time < 10 * shallow_time + 0.01);
+
+		// a change at the root still reaches the leaf
+		root.local_style->set("deep.key", "changed");
+		CHECK(leaf->resolve_style_or("deep.key", "") == "changed");
+	}
+
+	return test::result();
+}
@@ -0,0 +1,78 @@
+#include "BijectiveModifiers.h"
+#include "tests/check.hpp"
+
+/*
+* sync_with_key: rows are matched to nodes by a key column instead of their position
+*/
+struct Record
+{
+	int id = 0;
+	std::string name;
+	std::vector<Record*> children;
+};
+
+int main()
+{
+	std::vector<Record> records(5);
+	Record root;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		records.at(i).id = static_cast<int>(i) * 10;
+		records.at(i).name = "n" + std::to_string(i);
+		root.children.push_back(&records.at(i));
+	}
+
+	SelectiveView<Record> view([](const Record* node) { return node->children; }, &root);
+	BijectiveAlgorithm<Record> alg(view);
+
+	// keys are read only
+	auto p_id = alg.make_path<int>([](const Record* r) { return r->id; }, [](Record*, const int&) { return false; });
+	auto p_name = alg.make_path<std::string>([](const Record* r) { return r->name; }, [](Record* r, const std::string& v) { r->name = v; return true; });
+	Column<Record, int>* col_id = alg.make_column(p_id, modifiers::int_to_string<Record>(), "ID");
+	Column<Record, std::string>* col_name = alg.make_column(p_name, BijeciveModifier<Record, std::string, std::string>::passthrough([](const std::string& s) { return s; }), "Name");
+	alg.register_column(col_id);
+	alg.register_column(col_name);
+
+	// reordered and filtered rows, an unknown key and a repeated key
+	const std::vector<std::vector<std::string>> table = {
+		{ "ID", "40", "99", "10", "40" },
+		{ "Name", "four", "unknown", "one", "again" }
+	};
+
+	SyncReport<Record> report = alg.sync_with_key(table, "ID");
+	CHECK(report.success);
+	CHECK(report.unmatched_rows == std::vector<size_t>{ 1 });
+	CHECK(report.duplicate_rows == std::vector<size_t>{ 3 });
+	CHECK(report.unmatched_nodes == (std::vector<Record*>{ &records.at(0), &records.at(2), &records.at(3) }));
+	CHECK(records.at(4).name == "four");
+	CHECK(records.at(1).name == "one");
+	CHECK(records.at(0).name == "n0");
+
+	// same by index, unknown header
+	CHECK(alg.sync_with_key(table, size_t(0)).success);
+	CHECK(!alg.sync_with_key(table, "Other").success);
+
+	// ragged table
+	CHECK(!alg.sync_with_key({ { "ID", "10" }, { "Name" } }, "ID").success);
+
+	// a filtered table must not give a row the value of a node it does not contain
+	const std::vector<std::vector<std::string>> filtered = {
+		{ "ID", "10", "40" },
+		{ "Name", "n2", "four" }
+	};
+	CHECK(!alg.sync_with_key(filtered, "ID").success);
+	CHECK(records.at(1).name == "one" && records.at(2).name == "n2");
+
+	// the value is free again once the unmatched node gave it up
+	records.at(2).name = "two";
+	CHECK(alg.sync_with_key(filtered, "ID").success);
+	CHECK(records.at(1).name == "n2");
+
+	// keys shared by several nodes can't be resolved
+	records.at(3).id = 10;
+	CHECK(!alg.sync_with_key(table, "ID").success);
+
+	delete col_id;
+	delete col_name;
+	return test::result();
+}
@@ -0,0 +1,126 @@
+#include "DiagramDrawioLayout.hpp"
+#include "tests/check.hpp"
+
+/*
+* Hierarchical layout of DI trees built in code
+*/
+namespace
+{
+	DrawioMxcell* add_vertex(DI::DiagramElement* parent)
+	{
+		DrawioMxcell* cell = new DrawioMxcell();
+		cell->local_style->set("vertex", "1");
+		parent->add_owned_element(cell);
+		return cell;
+	}
+
+	DrawioArrow* add_edge(DI::DiagramElement* parent, DI::DiagramElement* source, DI::DiagramElement* target)
+	{
+		DrawioArrow* arrow = new DrawioArrow();
+		parent->add_owned_element(arrow);
+		arrow->connect(source, target);
+		return arrow;
+	}
+
+	Bounds bounds_of(const DI::DiagramElement* cell)
+	{
+		Bounds bounds;
+		get_drawio_bounds(cell, bounds);
+		return bounds;
+	}
+}
+
+int main()
+{
+	// edges point downwards, long edges get waypoints, a single crossing is removed
+	{
+		DI::Diagram root;
+		std::vector<DrawioMxcell*> v;
+		for (int i = 0; i < 6; i++) v.push_back(add_vertex(&root));
+
+		// 0 -> 1 -> 2, 0 -> 2 spans two layers
+		add_edge(&root, v[0], v[1]);
+		add_edge(&root, v[1], v[2]);
+		DrawioArrow* skip = add_edge(&root, v[0], v[2]);
+
+		// a second component in the same layers
+		add_edge(&root, v[3], v[5]);
+		add_edge(&root, v[4], v[5]);
+
+		drawio::HierarchicalLayout layout;
+		layout.layout(&root);
+		CHECK(layout.crossings() == 0);
+
+		CHECK(bounds_of(v[0]).pos.y < bounds_of(v[1]).pos.y);
+		CHECK(bounds_of(v[1]).pos.y < bounds_of(v[2]).pos.y);
+		CHECK(bounds_of(v[3]).pos.y == bounds_of(v[0]).pos.y);
+
+		// one dummy node on the layer of 1
+		CHECK(skip->waypoints.size() == 1);
+		CHECK(skip->waypoints.front().y > bounds_of(v[0]).pos.y && skip->waypoints.front().y < bounds_of(v[2]).pos.y);
+
+		// default size for vertices without geometry
+		CHECK(bounds_of(v[4]).dim.width == drawio::HierarchicalLayout::DEFAULT_WIDTH);
+
+		// created geometries are owned by their vertex
+		CHECK(find_drawio_geometry(v[4]) != nullptr && find_drawio_geometry(v[4])->owning_element == v[4]);
+	}
+
+	// two layers with swapped targets: sweeps find the ordering without crossings
+	{
+		DI::Diagram root;
+		std::vector<DrawioMxcell*> top, bottom;
+		for (int i = 0; i < 4; i++) top.push_back(add_vertex(&root));
+		for (int i = 0; i < 4; i++) bottom.push_back(add_vertex(&root));
+		for (int i = 0; i < 4; i++) add_edge(&root, top[i], bottom[3 - i]);
+		add_edge(&root, top[0], bottom[2]);
+
+		drawio::HierarchicalLayout layout;
+		layout.layout(&root);
+		CHECK(layout.crossings() == 0);
+	}
+
+	// cycles are broken, neighbors in a layer keep their spacing
+	{
+		DI::Diagram root;
+		std::vector<DrawioMxcell*> v;
+		for (int i = 0; i < 40; i++) v.push_back(add_vertex(&root));
+		for (int i = 0; i < 40; i++)
+		{
+			add_edge(&root, v[i], v[(i + 1) % 40]);
+			add_edge(&root, v[i], v[(i * 7 + 3) % 40]);
+		}
+
+		drawio::HierarchicalLayout layout;
+		layout.node_spacing = 30;
+		layout.layout(&root);
+
+		std::vector<Bounds> placed;
+		for (const DrawioMxcell* cell : v) placed.push_back(bounds_of(cell));
+		std::sort(placed.begin(), placed.end(), [](const Bounds& a, const Bounds& b) { return a.pos.y != b.pos.y ? a.pos.y < b.pos.y : a.pos.x < b.pos.x; });
+
+		size_t layers = 1;
+		for (size_t i = 1; i < placed.size(); i++)
+		{
+			if (placed[i].pos.y != placed[i - 1].pos.y)
+			{
+				layers++;
+				continue;
+			}
+			CHECK(placed[i].pos.x >= placed[i - 1].pos.x + placed[i - 1].dim.width + layout.node_spacing - 1e-9);
+		}
+		CHECK(layers > 1);
+
+		// same result with one thread
+		std::vector<Point> positions;
+		for (const DrawioMxcell* cell : v) positions.push_back(bounds_of(cell).pos);
+		layout.threads = 1;
+		layout.layout(&root);
+		for (size_t i = 0; i < v.size(); i++)
+		{
+			CHECK(bounds_of(v[i]).pos.x == positions[i].x && bounds_of(v[i]).pos.y == positions[i].y);
+		}
+	}
+
+	return test::result();
+}
@@ -0,0 +1,44 @@
+#include "DiagramDrawioLowering.hpp"
+#include "DiagramGraphicsRaster.hpp"
+#include "tests/check.hpp"
+
+/*
+* Lowering test.drawio.xml, twice into the same canvas
+*/
+int main()
+{
+	DI::Diagram diagram;
+	parse_drawio_file("test.drawio.xml", &diagram);
+
+	DG::Canvas canvas;
+	drawio::DrawioLowering lowering;
+	lowering.lower(&diagram, canvas);
+	CHECK(canvas.members.size() == 9);
+	CHECK(canvas.package_styles.size() == 7);
+
+	// the second pass appends to package_styles, styles shared by the first pass must stay valid
+	lowering.lower(&diagram, canvas);
+	CHECK(canvas.members.size() == 18);
+	CHECK(canvas.package_styles.size() == 14);
+
+	for (const DG::abstracts::GraphicalElement* member : canvas.members)
+	{
+		for (const DG::Style* style : member->s_shared)
+		{
+			bool owned = false;
+			for (const DG::Style& shared : canvas.package_styles) owned |= &shared == style;
+			CHECK(owned);
+		}
+	}
+
+	DG::raster::RenderOptions options;
+	options.width = 600;
+	options.height = 450;
+	const DG::raster::Image image = DG::raster::render(canvas, options);
+
+	// inside vertex "A", fillColor=#d5e8d4
+	const uint8_t* pixel = image.row(215) + 110 * 4;
+	CHECK(pixel[0] == 0xd5 && pixel[1] == 0xe8 && pixel[2] == 0xd4 && pixel[3] == 0xff);
+
+	return test::result();
+}
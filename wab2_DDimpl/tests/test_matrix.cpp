@@ -0,0 +1,61 @@
+#include "DiagramGraphics.hpp"
+#include "tests/check.hpp"
+#include <random>
+
+/*
+* DG::Matrix: composition, inversion and batch transformation
+*/
+using namespace DG;
+
+namespace
+{
+	bool near(const Point& p, double x, double y, double tolerance = 1e-9)
+	{
+		return std::abs(p.x - x) <= tolerance && std::abs(p.y - y) <= tolerance;
+	}
+}
+
+int main()
+{
+	CHECK(near(Matrix::translation(3, -4) * Point{ 1, 1 }, 4, -3));
+	CHECK(near(Matrix::scaling(2, 3) * Point{ 1, 1 }, 2, 3));
+	CHECK(near(Matrix::rotation(90) * Point{ 1, 0 }, 0, 1, 1e-12));
+	CHECK(near(Matrix::rotation(180, Point{ 5, 5 }) * Point{ 6, 5 }, 4, 5, 1e-12));
+	CHECK(near(Matrix::skewing(45, 0) * Point{ 0, 1 }, 1, 1, 1e-12));
+
+	// like svg, the left matrix is applied last
+	const Matrix composed = Matrix::translation(10, 0) * Matrix::scaling(2, 2);
+	CHECK(near(composed * Point{ 1, 1 }, 12, 2));
+	CHECK(Matrix().is_identity());
+	CHECK(!composed.is_identity());
+	CHECK(composed.determinant() == 4);
+
+	const Matrix m = Matrix::rotation(30, Point{ 5, 7 }) * Matrix::scaling(2, 3) * Matrix::translation(1, -2) * Matrix::skewing(10, 5);
+	CHECK(near(m * m.inverse() * Point{ 3, 4 }, 3, 4));
+
+	bool thrown = false;
+	try { Matrix(0, 0, 0, 0, 1, 1).inverse(); }
+	catch (const std::logic_error&) { thrown = true; }
+	CHECK(thrown);
+
+	// the batch transformation matches single points for every count, including the remainder of vectorized loops
+	std::mt19937 rng(7);
+	for (size_t count = 0; count < 12; count++)
+	{
+		std::vector<Point> points(count);
+		for (Point& p : points) p = Point{ double(rng() % 1000), double(rng() % 1000) };
+
+		std::vector<Point> batch = points;
+		m.transform(batch);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Point single = m * points.at(i);
+			CHECK(near(batch.at(i), single.x, single.y));
+		}
+
+		m.inverse().transform(batch);
+		for (size_t i = 0; i < count; i++) CHECK(near(batch.at(i), points.at(i).x, points.at(i).y, 1e-6));
+	}
+
+	return test::result();
+}
@@ -0,0 +1,85 @@
+#include "BijectiveModifiers.h"
+#include "tests/check.hpp"
+#include <type_traits>
+
+/*
+* BijeciveModifiers from BijectiveModifiers.h, their batch paths and columns over them
+*/
+struct Item
+{
+	Color color = KnownColor::black;
+	double size = 0;
+	std::vector<Item*> children;
+};
+
+int main()
+{
+	// batch and row-wise conversion agree
+	{
+		const auto m = modifiers::int_to_string<Item>();
+		const std::vector<int> values = { 0, -1, 42, 2147483647, -2147483647 - 1 };
+		const std::vector<std::string> strings = m.apply_batch(values);
+
+		CHECK(strings.size() == values.size());
+		for (size_t i = 0; i < values.size(); i++) CHECK(strings.at(i) == m.apply(values.at(i)));
+		CHECK(m.revert_batch(strings) == values);
+	}
+
+	// Color has no default constructor, chains and columns over it stay row-wise
+	CHECK(!std::is_default_constructible_v<Color>);
+	{
+		auto chain = modifiers::hex_color_to_rgb<Item>().chain_with(modifiers::rgb_to_string<Item>());
+		CHECK(chain.apply("#ff8000") == "255,128,0");
+		CHECK(chain.revert("0,16,255") == "#0010ff");
+		CHECK(chain.apply_batch(std::vector<std::string>{ "#000000", "#ffffff" }) == (std::vector<std::string>{ "0,0,0", "255,255,255" }));
+
+		std::vector<Item> items(3);
+		Item root;
+		for (Item& item : items) root.children.push_back(&item);
+		items.at(1).color = KnownColor::white;
+
+		SelectiveView<Item> view([](const Item* node) { return node->children; }, &root);
+		BijectiveAlgorithm<Item> alg(view);
+		auto path = alg.make_path<Color>([](const Item* i) { return i->color; }, [](Item* i, const Color& c) { i->color = c; return true; });
+		Column<Item, Color>* col = alg.make_column(path, modifiers::rgb_to_string<Item>(), "Color");
+		alg.register_column(col);
+
+		const std::vector<std::vector<std::string>> table = alg.apply();
+		CHECK(table.at(0) == (std::vector<std::string>{ "Color", "0,0,0", "255,255,255", "0,0,0" }));
+
+		CHECK(alg.sync_with(&root, { { "Color", "1,2,3", "255,255,255", "0,0,0" } }));
+		CHECK(items.at(0).color == Color(1, 2, 3));
+
+		TypedTable<Item> typed = alg.apply_typed();
+		typed.column<Color>(0).at(2) = Color(9, 9, 9);
+		CHECK(alg.sync_with(typed));
+		CHECK(items.at(2).color == Color(9, 9, 9));
+
+		delete col;
+	}
+
+	// linear_scale reverts exactly for power of two factors, is_valid rejects values which don't survive the round trip
+	{
+		std::vector<Item> items(2);
+		Item root;
+		for (Item& item : items) root.children.push_back(&item);
+		items.at(0).size = 0.1;
+		items.at(1).size = 7.3;
+
+		SelectiveView<Item> view([](const Item* node) { return node->children; }, &root);
+		AttributePath<Item, double> path([](const Item* i) { return i->size; }, [](Item* i, const double& v) { i->size = v; return true; });
+
+		const auto exact = modifiers::linear_scale<Item>(4);
+		CHECK(exact.is_valid(path, view));
+		CHECK(exact.revert_batch(exact.apply_batch(std::vector<double>{ 0.1, 7.3, -1e300 })) == (std::vector<double>{ 0.1, 7.3, -1e300 }));
+
+		CHECK(!modifiers::linear_scale<Item>(3).is_valid(path, view));
+
+		bool thrown = false;
+		try { modifiers::linear_scale<Item>(0); }
+		catch (const std::invalid_argument&) { thrown = true; }
+		CHECK(thrown);
+	}
+
+	return test::result();
+}
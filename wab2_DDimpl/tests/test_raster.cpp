@@ -0,0 +1,379 @@
+#include "DiagramGraphicsRaster.hpp"
+#include "tests/check.hpp"
+#include <cstdlib>
+#include <sstream>
+
+/*
+* Rasterizer output checked at single pixels
+*/
+using namespace DG;
+
+namespace
+{
+	struct Pixel
+	{
+		int r, g, b, a;
+	};
+
+	Pixel pixel(const raster::Image& image, int x, int y)
+	{
+		const uint8_t* p = image.row(y) + x * 4;
+		return Pixel{ p[0], p[1], p[2], p[3] };
+	}
+
+	bool near(const Pixel& p, int r, int g, int b, int tolerance = 2)
+	{
+		return std::abs(p.r - r) <= tolerance && std::abs(p.g - g) <= tolerance && std::abs(p.b - b) <= tolerance;
+	}
+
+	Rectangle* add_rect(Canvas& canvas, double x, double y, double w, double h, const Style& style)
+	{
+		Rectangle* rect = canvas.create<Rectangle>();
+		rect->bounds = Bounds{ Point{ x, y }, Dimension{ w, h } };
+		rect->s_local.push_back(style);
+		canvas.add_member(rect);
+		return rect;
+	}
+
+	raster::RenderOptions options(int width, int height)
+	{
+		raster::RenderOptions o;
+		o.width = width;
+		o.height = height;
+		return o;
+	}
+}
+
+int main()
+{
+	// solid fills, strokes, opacity and anti-aliased edges
+	{
+		Canvas canvas;
+		add_rect(canvas, 10.5, 10, 40, 40, Style().set_fill_color(Color(255, 0, 0)));
+		add_rect(canvas, 60, 10, 40, 40, Style().set_fill_color(Color(0, 0, 255)).set_stroke_color(KnownColor::black).set_stroke_width(4));
+		add_rect(canvas, 110, 10, 40, 40, Style().set_fill_color(Color(255, 0, 0)).set_fill_opacity(0.5));
+
+		Circle* circle = canvas.create<Circle>();
+		circle->center = Point{ 180, 30 };
+		circle->radius = 20;
+		circle->s_local.push_back(Style().set_fill_color(Color(0, 128, 0)));
+		canvas.add_member(circle);
+
+		const raster::Image image = raster::render(canvas, options(210, 60));
+
+		CHECK(near(pixel(image, 30, 30), 255, 0, 0));
+		CHECK(near(pixel(image, 5, 5), 255, 255, 255));
+		// half covered column at x = 10.5
+		CHECK(near(pixel(image, 10, 30), 255, 128, 128, 4));
+
+		CHECK(near(pixel(image, 80, 30), 0, 0, 255));
+		CHECK(near(pixel(image, 60, 30), 0, 0, 0));
+
+		CHECK(near(pixel(image, 130, 30), 255, 128, 128, 2));
+
+		CHECK(near(pixel(image, 180, 30), 0, 128, 0));
+		CHECK(near(pixel(image, 163, 13), 255, 255, 255));
+
+		// tiles and threads don't change the result
+		raster::RenderOptions small_tiles = options(210, 60);
+		small_tiles.tile_size = 16;
+		small_tiles.threads = 3;
+		CHECK(raster::render(canvas, small_tiles).pixels == image.pixels);
+
+		// the view matrix maps canvas to pixel coordinates
+		raster::RenderOptions zoomed = options(420, 120);
+		zoomed.view = Matrix::scaling(2, 2);
+		CHECK(near(pixel(raster::render(canvas, zoomed), 360, 60), 0, 128, 0));
+
+		bool thrown = false;
+		try { raster::render(canvas, options(0, 10)); }
+		catch (const std::invalid_argument&) { thrown = true; }
+		CHECK(thrown);
+	}
+
+	// image files
+	{
+		Canvas canvas;
+		canvas.c_background = Color(1, 2, 3);
+		const raster::Image image = raster::render(canvas, options(4, 3));
+
+		std::ostringstream ppm;
+		raster::write_ppm(image, ppm);
+		const std::string ppm_header = "P6\n4 3\n255\n";
+		CHECK(ppm.str().size() == ppm_header.size() + 4 * 3 * 3);
+		CHECK(ppm.str().compare(0, ppm_header.size(), ppm_header) == 0);
+		CHECK(ppm.str().compare(ppm_header.size(), 3, "\x01\x02\x03") == 0);
+
+		std::ostringstream png;
+		raster::write_png(image, png);
+		CHECK(png.str().compare(0, 8, "\x89PNG\r\n\x1a\n") == 0);
+		CHECK(png.str().compare(12, 4, "IHDR") == 0);
+		CHECK(png.str().compare(png.str().size() - 8, 4, "IEND") == 0);
+	}
+
+	// gradient and pattern fills
+	{
+		Canvas canvas;
+		LinearGradient* linear = canvas.create<LinearGradient>();
+		linear->x1 = 0; linear->y1 = 0; linear->x2 = 1; linear->y2 = 0;
+		linear->stops = { { KnownColor::red, 0, 1 }, { Color(0, 0, 255), 1, 1 } };
+
+		RadialGradient* radial = canvas.create<RadialGradient>();
+		radial->stops = { { KnownColor::white, 0, 1 }, { Color(0, 0, 0), 1, 1 } };
+
+		Pattern* pattern = canvas.create<Pattern>();
+		pattern->bounds = Bounds{ Point{ 0, 0 }, Dimension{ 20, 20 } };
+		Circle* dot = canvas.create<Circle>();
+		dot->center = Point{ 10, 10 };
+		dot->radius = 5;
+		Style dot_style;
+		dot_style.set_fill_color(Color(0, 128, 0));
+		dot->s_local.push_back(dot_style);
+		pattern->tile = dot;
+		canvas.package_fills = { linear, radial, pattern };
+
+		Style style;
+		add_rect(canvas, 0, 0, 100, 100, Style(style).set_fill(linear));
+		add_rect(canvas, 100, 0, 100, 100, Style(style).set_fill(radial));
+		add_rect(canvas, 200, 0, 100, 100, Style(style).set_fill(pattern));
+
+		const raster::Image image = raster::render(canvas, options(300, 100));
+
+		CHECK(near(pixel(image, 1, 50), 253, 0, 2, 4));
+		CHECK(near(pixel(image, 98, 50), 2, 0, 253, 4));
+		CHECK(near(pixel(image, 50, 50), 128, 0, 128, 4));
+
+		CHECK(near(pixel(image, 150, 50), 255, 255, 255, 6));
+		CHECK(near(pixel(image, 101, 1), 0, 0, 0, 6));
+
+		// dots at the tile centers, the white canvas background between them
+		CHECK(near(pixel(image, 210, 10), 0, 128, 0));
+		CHECK(near(pixel(image, 250, 30), 0, 128, 0));
+		CHECK(near(pixel(image, 200, 0), 255, 255, 255));
+
+		// fills edited in place are picked up by a persistent renderer without invalidating it
+		raster::RenderOptions o = options(300, 100);
+		raster::IncrementalRenderer renderer(canvas, o);
+		renderer.update();
+		linear->stops.front().color = Color(0, 255, 0);
+		linear->invalidate();
+		CHECK(!renderer.update().empty());
+		CHECK(near(pixel(renderer.result(), 1, 50), 2, 253, 2, 4));
+
+		dot->s_local.front().set_fill_color(Color(255, 0, 0));
+		dot->invalidate_style();
+		CHECK(!renderer.update().empty());
+		CHECK(near(pixel(renderer.result(), 210, 10), 255, 0, 0));
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+		CHECK(renderer.update().empty());
+
+		// gradients recreated at a recycled address don't reuse the table of the old one
+		canvas.clear();
+		LinearGradient* recreated = canvas.create<LinearGradient>();
+		recreated->x1 = 0; recreated->y1 = 0; recreated->x2 = 1; recreated->y2 = 0;
+		recreated->stops = { { Color(0, 0, 255), 0, 1 }, { Color(0, 0, 255), 1, 1 } };
+		canvas.package_fills = { recreated };
+		add_rect(canvas, 0, 0, 100, 100, Style().set_fill(recreated));
+		renderer.update();
+		CHECK(near(pixel(renderer.result(), 1, 50), 0, 0, 255));
+	}
+
+	// clip paths in the user space of the clipped element
+	{
+		Canvas canvas;
+		ClipPath* clip = canvas.create<ClipPath>();
+		Circle* circle = canvas.create<Circle>();
+		circle->center = Point{ 50, 50 };
+		circle->radius = 30;
+		clip->add_member(circle);
+
+		Rectangle* rect = add_rect(canvas, 0, 0, 100, 100, Style().set_fill_color(Color(255, 0, 0)));
+		rect->mask = clip;
+
+		Translate* move = canvas.create<Translate>();
+		move->x_delta = 100;
+		move->y_delta = 0;
+		rect->transforms.push_back(move);
+		rect->invalidate_transform();
+
+		// groups clip all members
+		Group* group = canvas.create<Group>();
+		group->mask = clip;
+		canvas.add_member(group);
+		Rectangle* member = canvas.create<Rectangle>();
+		member->bounds = Bounds{ Point{ 0, 0 }, Dimension{ 100, 100 } };
+		member->s_local.push_back(Style().set_fill_color(Color(0, 0, 255)));
+		group->add_member(member);
+
+		const raster::Image image = raster::render(canvas, options(200, 100));
+		CHECK(near(pixel(image, 150, 50), 255, 0, 0));
+		CHECK(near(pixel(image, 105, 5), 255, 255, 255));
+		CHECK(near(pixel(image, 175, 50), 255, 0, 0));
+		CHECK(near(pixel(image, 185, 50), 255, 255, 255));
+		CHECK(near(pixel(image, 50, 50), 0, 0, 255));
+		CHECK(near(pixel(image, 5, 5), 255, 255, 255));
+	}
+
+	// markers are placed on the vertices and oriented along the path
+	{
+		Canvas canvas;
+		Marker* arrow = canvas.create<Marker>();
+		arrow->size = Dimension{ 20, 20 };
+		arrow->reference = Point{ 20, 10 };
+		Polygon* head = canvas.create<Polygon>();
+		head->points = { { 0, 0 }, { 20, 10 }, { 0, 20 } };
+		head->s_local.push_back(Style().set_fill_color(Color(255, 0, 0)));
+		arrow->add_member(head);
+
+		Line* across = canvas.create<Line>();
+		across->start = Point{ 10, 50 };
+		across->end = Point{ 100, 50 };
+		across->s_local.push_back(Style().set_stroke_color(KnownColor::black).set_stroke_width(2));
+		static_cast<abstracts::MarkedElement*>(across)->end = arrow;
+		canvas.add_member(across);
+
+		PolyLine* down = canvas.create<PolyLine>();
+		down->points = { { 150, 10 }, { 150, 100 } };
+		down->s_local.push_back(Style().set_stroke_color(KnownColor::black).set_stroke_width(2));
+		down->end = arrow;
+		canvas.add_member(down);
+
+		const raster::Image image = raster::render(canvas, options(200, 120));
+		CHECK(near(pixel(image, 85, 50), 255, 0, 0));
+		CHECK(near(pixel(image, 95, 42), 255, 255, 255));
+		CHECK(near(pixel(image, 50, 50), 0, 0, 0));
+
+		// rotated by 90 degrees, the tip stays on the end point
+		CHECK(near(pixel(image, 150, 85), 255, 0, 0));
+		CHECK(near(pixel(image, 158, 98), 255, 255, 255));
+		CHECK(near(pixel(image, 150, 104), 255, 255, 255));
+
+		// the bounds include the reach of the marker
+		CHECK(across->local_bounds().x1 >= 100 + std::hypot(20, 10) - 1e-9);
+
+		// editing the shared marker changes every instance
+		raster::RenderOptions o = options(200, 120);
+		raster::IncrementalRenderer renderer(canvas, o);
+		renderer.update();
+		head->s_local.front().set_fill_color(Color(0, 0, 255));
+		head->invalidate_style();
+		CHECK(!renderer.update().empty());
+		CHECK(near(pixel(renderer.result(), 85, 50), 0, 0, 255));
+		CHECK(near(pixel(renderer.result(), 150, 85), 0, 0, 255));
+	}
+
+	// incremental updates redraw only changed tiles and match a full render
+	{
+		Canvas canvas;
+		for (int i = 0; i < 16; i++)
+		{
+			add_rect(canvas, 10 + (i % 4) * 60.0, 10 + (i / 4) * 60.0, 40, 40, Style().set_fill_color(Color(i * 16, 100, 200)));
+		}
+		Rectangle* top = add_rect(canvas, 40, 40, 50, 50, Style().set_fill_color(Color(0, 200, 0)).set_fill_opacity(0.5));
+
+		raster::RenderOptions o = options(256, 256);
+		o.tile_size = 32;
+		raster::IncrementalRenderer renderer(canvas, o);
+
+		CHECK(renderer.update().size() == 64);
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+		CHECK(renderer.update().empty());
+
+		// a moved element redraws the tiles of its old and new position, 3 x 3 tiles here
+		Rectangle* moved = static_cast<Rectangle*>(canvas.members.at(15));
+		moved->bounds.pos.x += 5;
+		moved->invalidate_bounds();
+		const size_t redrawn = renderer.update().size();
+		CHECK(redrawn > 0 && redrawn <= 9);
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// style change
+		canvas.members.at(5)->s_local.front().set_fill_color(Color(255, 255, 0));
+		canvas.members.at(5)->invalidate_style();
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// reordering overlapping elements
+		std::swap(canvas.members.at(0), canvas.members.back());
+		CHECK(canvas.members.at(0) == top);
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// removal
+		canvas.members.erase(canvas.members.begin() + 3);
+		canvas.invalidate_bounds();
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+		CHECK(renderer.update().empty());
+	}
+
+	// changes inside nested groups and of clip paths reach the incremental renderer
+	{
+		Canvas canvas;
+		for (int i = 0; i < 8; i++) add_rect(canvas, 10 + i * 30.0, 200, 20, 20, Style().set_fill_color(Color(200, 0, i * 30)));
+
+		Group* outer = canvas.create<Group>();
+		Group* inner = canvas.create<Group>();
+		canvas.add_member(outer);
+		outer->add_member(inner);
+
+		Rectangle* below = canvas.create<Rectangle>();
+		below->bounds = Bounds{ Point{ 20, 20 }, Dimension{ 60, 60 } };
+		below->s_local.push_back(Style().set_fill_color(Color(0, 0, 255)));
+		Rectangle* above = canvas.create<Rectangle>();
+		above->bounds = Bounds{ Point{ 50, 50 }, Dimension{ 60, 60 } };
+		above->s_local.push_back(Style().set_fill_color(Color(0, 255, 0)));
+		inner->add_member(above);
+		inner->add_member(below);
+
+		ClipPath* clip = canvas.create<ClipPath>();
+		Circle* circle = canvas.create<Circle>();
+		circle->center = Point{ 200, 60 };
+		circle->radius = 30;
+		clip->add_member(circle);
+		Rectangle* clipped = canvas.create<Rectangle>();
+		clipped->bounds = Bounds{ Point{ 150, 10 }, Dimension{ 100, 100 } };
+		clipped->s_local.push_back(Style().set_fill_color(Color(255, 0, 0)));
+		clipped->mask = clip;
+		outer->add_member(clipped);
+
+		raster::RenderOptions o = options(256, 256);
+		o.tile_size = 32;
+		raster::IncrementalRenderer renderer(canvas, o);
+		renderer.update();
+		CHECK(renderer.update().empty());
+
+		// an edit two levels down only touches the tiles of the element
+		below->bounds.pos.y += 4;
+		below->invalidate_bounds();
+		const std::vector<size_t> redrawn = renderer.update();
+		CHECK(!redrawn.empty() && redrawn.size() <= 9);
+		CHECK(std::is_sorted(redrawn.begin(), redrawn.end()));
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// reordering the members of a nested group without invalidating it
+		std::swap(inner->members.at(0), inner->members.at(1));
+		CHECK(!renderer.update().empty());
+		CHECK(near(pixel(renderer.result(), 60, 60), 0, 0, 255));
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// clip paths are not drawn, their changes don't reach the owner chain of the clipped element
+		circle->radius = 45;
+		circle->invalidate_bounds();
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+
+		// moved offscreen and back
+		above->bounds.pos.x = 1000;
+		above->invalidate_bounds();
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+		above->bounds.pos.x = 100;
+		above->invalidate_bounds();
+		CHECK(!renderer.update().empty());
+		CHECK(renderer.result().pixels == raster::render(canvas, o).pixels);
+		CHECK(renderer.update().empty());
+	}
+
+	return test::result();
+}
@@ -0,0 +1,269 @@
+#include "DiagramDrawioRouting.hpp"
+#include "tests/check.hpp"
+#include <algorithm>
+
+/*
+* Orthogonal edge routing over DI trees built in code
+*/
+namespace
+{
+	DrawioMxcell* add_vertex(DI::DiagramElement* parent, double x, double y, double w, double h)
+	{
+		DrawioMxcell* cell = new DrawioMxcell();
+		cell->local_style->set("vertex", "1");
+		parent->add_owned_element(cell);
+
+		DI::DiagramElement* geometry = new DI::DiagramElement();
+		geometry->local_style->set("as", "geometry");
+		geometry->local_style->set("x", std::to_string(x));
+		geometry->local_style->set("y", std::to_string(y));
+		geometry->local_style->set("width", std::to_string(w));
+		geometry->local_style->set("height", std::to_string(h));
+		cell->add_owned_element(geometry);
+		return cell;
+	}
+
+	DrawioArrow* add_edge(DI::DiagramElement* parent, DI::DiagramElement* source, DI::DiagramElement* target)
+	{
+		DrawioArrow* arrow = new DrawioArrow();
+		arrow->drawio_style = { { "edgeStyle", "orthogonalEdgeStyle" } };
+		arrow->touch_style();
+		parent->add_owned_element(arrow);
+		arrow->connect(source, target);
+		return arrow;
+	}
+
+	void move(DI::DiagramElement* cell, double x, double y)
+	{
+		DI::DiagramElement* geometry = const_cast<DI::DiagramElement*>(find_drawio_geometry(cell));
+		geometry->local_style->set("x", std::to_string(x));
+		geometry->local_style->set("y", std::to_string(y));
+	}
+
+	void remove_owned(DI::DiagramElement* parent, DI::DiagramElement* child)
+	{
+		std::vector<DI::DiagramElement*>& owned = parent->owned_elements;
+		owned.erase(std::remove(owned.begin(), owned.end(), child), owned.end());
+		delete child;
+	}
+
+	bool registered(const DI::DiagramElement* cell, const DI::Edge* edge)
+	{
+		return std::find(cell->incident_edges.begin(), cell->incident_edges.end(), edge) != cell->incident_edges.end();
+	}
+
+	/*
+	* \brief route of edge from the center of its source over the waypoints to the center of its target
+	*/
+	std::vector<Point> route_of(const drawio::EdgeRouter& router, const DrawioArrow* edge)
+	{
+		const Bounds* s = router.absolute_bounds(edge->source);
+		const Bounds* t = router.absolute_bounds(edge->target);
+
+		std::vector<Point> route = { Point{ s->pos.x + s->dim.width / 2, s->pos.y + s->dim.height / 2 } };
+		route.insert(route.end(), edge->waypoints.begin(), edge->waypoints.end());
+		route.push_back(Point{ t->pos.x + t->dim.width / 2, t->pos.y + t->dim.height / 2 });
+		return route;
+	}
+
+	/*
+	* \brief number of route segments which pass through a vertex other than the endpoints of their edge
+	*/
+	size_t violations(const drawio::EdgeRouter& router, const std::vector<DrawioMxcell*>& cells)
+	{
+		size_t count = 0;
+		for (const DrawioArrow* edge : router.orthogonal_edges())
+		{
+			const std::vector<Point> route = route_of(router, edge);
+			for (size_t i = 0; i + 1 < route.size(); i++)
+			{
+				const double x0 = std::min(route[i].x, route[i + 1].x), x1 = std::max(route[i].x, route[i + 1].x);
+				const double y0 = std::min(route[i].y, route[i + 1].y), y1 = std::max(route[i].y, route[i + 1].y);
+				for (const DrawioMxcell* cell : cells)
+				{
+					if (cell == edge->source || cell == edge->target) continue;
+					const BoundingBox b = BoundingBox::from(*router.absolute_bounds(cell));
+					if (x0 < b.x1 && x1 > b.x0 && y0 < b.y1 && y1 > b.y0) count++;
+				}
+			}
+		}
+		return count;
+	}
+
+	bool orthogonal(const std::vector<Point>& waypoints)
+	{
+		for (size_t i = 1; i < waypoints.size(); i++)
+		{
+			if (waypoints[i].x != waypoints[i - 1].x && waypoints[i].y != waypoints[i - 1].y) return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	// routes go around vertices in their way
+	{
+		DI::Diagram root;
+		DrawioMxcell* a = add_vertex(&root, 20, 150, 60, 40);
+		DrawioMxcell* b = add_vertex(&root, 420, 150, 60, 40);
+		DrawioMxcell* wall = add_vertex(&root, 200, 50, 80, 250);
+		DrawioMxcell* c = add_vertex(&root, 220, 330, 60, 40);
+		DrawioArrow* ab = add_edge(&root, a, b);
+		add_edge(&root, b, c);
+		add_edge(&root, c, a);
+
+		// edges without edgeStyle=orthogonalEdgeStyle are left alone
+		DrawioArrow* straight = new DrawioArrow();
+		root.add_owned_element(straight);
+		straight->connect(a, c);
+
+		drawio::EdgeRouter router;
+		router.route(&root);
+		CHECK(router.orthogonal_edges().size() == 3);
+		CHECK(straight->waypoints.empty());
+		CHECK(!ab->waypoints.empty());
+		CHECK(violations(router, { a, b, wall, c }) == 0);
+		for (const DrawioArrow* edge : router.orthogonal_edges()) CHECK(orthogonal(edge->waypoints));
+
+		// keeps its distance to the wall
+		for (const Point& p : ab->waypoints)
+		{
+			CHECK(p.y <= 50 - drawio::EdgeRouter::MARGIN || p.y >= 300 + drawio::EdgeRouter::MARGIN || p.x <= 200 - drawio::EdgeRouter::MARGIN || p.x >= 280 + drawio::EdgeRouter::MARGIN);
+		}
+	}
+
+	// dense grids, the result does not depend on the number of threads
+	{
+		DI::Diagram root;
+		std::vector<DrawioMxcell*> cells;
+		for (int y = 0; y < 8; y++)
+		{
+			for (int x = 0; x < 10; x++) cells.push_back(add_vertex(&root, x * 160 + (x * 7 + y * 13) % 40, y * 120 + (x * 11 + y * 5) % 30, 80, 50));
+		}
+		for (int i = 0; i < 150; i++)
+		{
+			const int source = (i * 37) % 80;
+			const int tx = std::min(9, source % 10 + 1 + i % 3), ty = std::min(7, source / 10 + (i / 3) % 3);
+			add_edge(&root, cells[source], cells[ty * 10 + tx]);
+		}
+
+		drawio::EdgeRouter router;
+		router.route(&root);
+		CHECK(violations(router, cells) == 0);
+
+		std::vector<std::vector<Point>> parallel;
+		for (const DrawioArrow* edge : router.orthogonal_edges())
+		{
+			CHECK(orthogonal(edge->waypoints));
+			parallel.push_back(edge->waypoints);
+		}
+
+		drawio::EdgeRouter single;
+		single.threads = 1;
+		single.route(&root);
+		size_t equal = 0;
+		for (size_t i = 0; i < parallel.size(); i++)
+		{
+			const std::vector<Point>& waypoints = single.orthogonal_edges()[i]->waypoints;
+			equal += std::equal(waypoints.begin(), waypoints.end(), parallel[i].begin(), parallel[i].end(), [](const Point& p, const Point& q) { return p.x == q.x && p.y == q.y; });
+		}
+		CHECK(equal == parallel.size());
+	}
+
+	// deleting an edge unregisters it, deleting a vertex clears the endpoint of its edges
+	{
+		DI::Diagram root;
+		DrawioMxcell* a = add_vertex(&root, 0, 0, 40, 40);
+		DrawioMxcell* b = add_vertex(&root, 200, 0, 40, 40);
+		DrawioArrow* ab = add_edge(&root, a, b);
+		DrawioArrow* ba = add_edge(&root, b, a);
+		CHECK(registered(a, ab) && registered(b, ab));
+
+		remove_owned(&root, ab);
+		CHECK(!registered(a, ab) && !registered(b, ab));
+		CHECK(a->incident_edges.size() == 1 && b->incident_edges.size() == 1);
+
+		remove_owned(&root, b);
+		CHECK(ba->source == nullptr);
+		CHECK(ba->target == a);
+		CHECK(registered(a, ba));
+
+		ba->disconnect();
+		CHECK(a->incident_edges.empty());
+	}
+
+	// reroute after an edge was deleted and the tree indexed again
+	{
+		DI::Diagram root;
+		DrawioMxcell* a = add_vertex(&root, 0, 0, 40, 40);
+		DrawioMxcell* b = add_vertex(&root, 300, 0, 40, 40);
+		DrawioMxcell* c = add_vertex(&root, 0, 300, 40, 40);
+		add_edge(&root, a, b);
+		DrawioArrow* ac = add_edge(&root, a, c);
+
+		drawio::EdgeRouter router;
+		router.route(&root);
+
+		remove_owned(&root, ac);
+		router.index(&root);
+
+		move(a, 20, 20);
+		router.moved(a);
+		const std::vector<DrawioArrow*> rerouted = router.update();
+		CHECK(rerouted.size() == 1);
+	}
+
+	// moving a vertex reroutes its edges and the edges through its new place, like routing them from scratch
+	{
+		DI::Diagram root;
+		std::vector<DrawioMxcell*> cells;
+		for (int y = 0; y < 6; y++)
+		{
+			for (int x = 0; x < 6; x++) cells.push_back(add_vertex(&root, x * 160, y * 120, 80, 50));
+		}
+		for (int y = 0; y < 6; y++)
+		{
+			for (int x = 0; x + 1 < 6; x++) add_edge(&root, cells[y * 6 + x], cells[y * 6 + x + 1]);
+		}
+
+		drawio::EdgeRouter router;
+		router.route(&root);
+		const size_t edge_count = router.orthogonal_edges().size();
+
+		// into the corridor between rows 2 and 3
+		DrawioMxcell* moved = cells[2 * 6 + 3];
+		move(moved, 3 * 160 + 40, 2 * 120 + 60);
+		router.moved(moved);
+		const std::vector<DrawioArrow*> rerouted = router.update();
+
+		CHECK(rerouted.size() < edge_count);
+		for (const DI::Edge* edge : moved->incident_edges)
+		{
+			CHECK(std::find(rerouted.begin(), rerouted.end(), edge) != rerouted.end());
+		}
+		CHECK(violations(router, cells) == 0);
+
+		std::vector<std::vector<Point>> kept;
+		for (const DrawioArrow* edge : rerouted) kept.push_back(edge->waypoints);
+
+		drawio::EdgeRouter fresh;
+		fresh.index(&root);
+		fresh.route_edges(rerouted);
+		for (size_t i = 0; i < rerouted.size(); i++)
+		{
+			const std::vector<Point>& waypoints = rerouted[i]->waypoints;
+			CHECK(std::equal(waypoints.begin(), waypoints.end(), kept[i].begin(), kept[i].end(), [](const Point& p, const Point& q) { return p.x == q.x && p.y == q.y; }));
+		}
+
+		// edits without notification are found by refresh
+		CHECK(router.update().empty());
+		move(cells[0], 0, 60);
+		const std::vector<DrawioArrow*> refreshed = router.refresh(&root);
+		CHECK(!refreshed.empty());
+		CHECK(violations(router, cells) == 0);
+		CHECK(router.refresh(&root).empty());
+	}
+
+	return test::result();
+}
@@ -0,0 +1,104 @@
+#include "DiagramGraphics.hpp"
+#include "tests/check.hpp"
+#include <thread>
+#include <unordered_set>
+
+/*
+* Packed DG::Style: presence bitmask, equality, hashing and interned values
+*/
+using namespace DG;
+
+int main()
+{
+	// properties are present once set, unset removes them
+	{
+		Style style;
+		CHECK(style.empty());
+		CHECK(!style.has(Style::Key::strokeWidth));
+
+		style.set_stroke_width(2.5).set_font_bold(true);
+		CHECK(!style.empty());
+		CHECK(style.has(Style::Key::strokeWidth) && style.has(Style::Key::fontBold));
+		CHECK(!style.has(Style::Key::fontItalic));
+		CHECK(style.stroke_width() == 2.5f && style.font_bold());
+
+		// unset font flags are still present
+		style.set_font_bold(false);
+		CHECK(style.has(Style::Key::fontBold) && !style.font_bold());
+
+		style.unset(Style::Key::strokeWidth);
+		style.unset(Style::Key::fontBold);
+		CHECK(style.empty());
+		CHECK(style == Style());
+	}
+
+	// equality and hashing do not depend on the order of the setters
+	{
+		Style a, b;
+		a.set_fill_color(Color(1, 2, 3)).set_font_name("Arial").set_stroke_dash_length({ 4, 2 }).set_font_italic(true);
+		b.set_font_italic(true).set_stroke_dash_length({ 4, 2 }).set_font_name("Arial").set_fill_color(Color(1, 2, 3));
+		CHECK(a == b);
+		CHECK(a.hash() == b.hash());
+		CHECK(a.font_name() == "Arial");
+		CHECK((a.stroke_dash_length() == std::vector<double>{ 4, 2 }));
+
+		// interned values are shared
+		CHECK(&a.font_name() == &b.font_name());
+
+		b.set_font_name("Helvetica");
+		CHECK(a != b);
+
+		// a set value differs from an unset one even if it is zero
+		Style zero;
+		zero.set_stroke_width(0);
+		CHECK(zero != Style());
+
+		// +0 and -0 are equal and hash equal
+		Style negative;
+		negative.set_stroke_width(-0.0);
+		CHECK(zero == negative && zero.hash() == negative.hash());
+
+		std::unordered_set<Style> unique = { a, b, Style(a), zero, negative };
+		CHECK(unique.size() == 3);
+	}
+
+	// dash arrays need an even number of lengths
+	{
+		bool thrown = false;
+		try { Style().set_stroke_dash_length({ 1, 2, 3 }); }
+		catch (const std::invalid_argument&) { thrown = true; }
+		CHECK(thrown);
+	}
+
+	// lookups don't lock and see values interned by other threads
+	{
+		InternTable<std::string>& table = InternTable<std::string>::instance();
+		const uint16_t first = table.intern("first");
+
+		std::atomic<bool> stop{ false };
+		std::atomic<size_t> mismatches{ 0 };
+		std::thread reader([&]()
+		{
+			while (!stop.load())
+			{
+				if (table.get(first) != "first") mismatches++;
+			}
+		});
+
+		std::vector<uint16_t> ids;
+		for (int i = 0; i < 2000; i++) ids.push_back(table.intern("name" + std::to_string(i)));
+		stop = true;
+		reader.join();
+
+		CHECK(mismatches == 0);
+		CHECK(table.intern("name1999") == ids.back());
+		CHECK(table.get(ids.at(1234)) == "name1234");
+
+		bool thrown = false;
+		try { table.get(UINT16_MAX); }
+		catch (const std::out_of_range&) { thrown = true; }
+		CHECK(thrown);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,138 @@
+#include "DiagramDrawioLowering.hpp"
+#include "DiagramGraphicsSvg.hpp"
+#include "tests/check.hpp"
+#include <sstream>
+
+/*
+* SVG export of hand built and lowered canvases
+*/
+using namespace DG;
+
+namespace
+{
+	bool contains(const std::string& text, const std::string& part)
+	{
+		return text.find(part) != std::string::npos;
+	}
+
+	std::string to_svg(const Canvas& canvas, double width, double height)
+	{
+		std::ostringstream out;
+		svg::write_svg(canvas, width, height, out);
+		return out.str();
+	}
+}
+
+int main()
+{
+	// numbers are written without rounding noise
+	{
+		Canvas canvas;
+		Rectangle* rect = canvas.create<Rectangle>();
+		rect->bounds = Bounds{ Point{ 0.1 + 0.2, 350 - 1e-13 }, Dimension{ 1.0 / 3, 1e6 + 0.5 } };
+		Style style;
+		style.set_fill_color(Color(255, 0, 0)).set_stroke_width(1.5);
+		rect->s_local.push_back(style);
+
+		Rotate* rotate = canvas.create<Rotate>();
+		rotate->angle = 45;
+		rotate->center = Point{ 0, 0 };
+		rect->transforms.push_back(rotate);
+		canvas.add_member(rect);
+
+		const std::string svg = to_svg(canvas, 100, 100);
+		CHECK(contains(svg, "x=\"0.3\""));
+		CHECK(contains(svg, "y=\"350\""));
+		CHECK(contains(svg, "width=\"0.333333333333\""));
+		CHECK(contains(svg, "height=\"1000000.5\""));
+		CHECK(contains(svg, "stroke-width=\"1.5\""));
+		CHECK(contains(svg, "fill=\"#ff0000\""));
+		CHECK(contains(svg, "matrix(0.707106781187 0.707106781187 -0.707106781187 0.707106781187 0 0)"));
+	}
+
+	// fills, markers and clip paths are defined once and referenced by id, text is escaped
+	{
+		Canvas canvas;
+		LinearGradient* gradient = canvas.create<LinearGradient>();
+		gradient->x1 = 0; gradient->y1 = 0; gradient->x2 = 1; gradient->y2 = 0;
+		gradient->stops = { { Color(255, 0, 0), 0, 1 }, { Color(0, 0, 255), 1, 1 } };
+		canvas.package_fills.push_back(gradient);
+
+		ClipPath* clip = canvas.create<ClipPath>();
+		Rectangle* clip_rect = canvas.create<Rectangle>();
+		clip_rect->bounds = Bounds{ Point{ 0, 0 }, Dimension{ 10, 10 } };
+		clip->add_member(clip_rect);
+
+		for (int i = 0; i < 2; i++)
+		{
+			Rectangle* rect = canvas.create<Rectangle>();
+			rect->bounds = Bounds{ Point{ 20, 20 + 70.0 * i }, Dimension{ 120, 60 } };
+			rect->s_local.push_back(Style().set_fill(gradient));
+			rect->mask = clip;
+			canvas.add_member(rect);
+		}
+
+		Marker* marker = canvas.create<Marker>();
+		marker->size = Dimension{ 10, 10 };
+		marker->reference = Point{ 10, 5 };
+		Polygon* head = canvas.create<Polygon>();
+		head->points = { { 0, 0 }, { 10, 5 }, { 0, 10 } };
+		marker->add_member(head);
+		PolyLine* line = canvas.create<PolyLine>();
+		line->points = { { 0, 0 }, { 50, 50 }, { 100, 0 } };
+		line->end = marker;
+		canvas.add_member(line);
+
+		Text* text = canvas.create<Text>();
+		text->data = "a<b & \"c\"";
+		text->bounds = Bounds{ Point{ 0, 0 }, Dimension{ 100, 20 } };
+		text->alignment = AlignmentKind::center;
+		canvas.add_member(text);
+
+		const std::string svg = to_svg(canvas, 300, 200);
+		CHECK(svg.find("<linearGradient id=\"fill0\"") == svg.rfind("<linearGradient"));
+		CHECK(svg.find("<clipPath id=\"clip0\"") == svg.rfind("<clipPath"));
+		CHECK(contains(svg, "<rect fill=\"url(#fill0)\" clip-path=\"url(#clip0)\" x=\"20\" y=\"90\""));
+		CHECK(contains(svg, "<polyline marker-end=\"url(#marker0)\" points=\"0,0 50,50 100,0\"/>"));
+		CHECK(contains(svg, ">a&lt;b &amp; &quot;c&quot;</text>"));
+		CHECK(svg.find("</defs>") < svg.find("<g>"));
+	}
+
+	// output larger than the write buffer is flushed completely
+	{
+		Canvas canvas;
+		const size_t count = 5000;
+		for (size_t i = 0; i < count; i++)
+		{
+			Rectangle* rect = canvas.create<Rectangle>();
+			rect->bounds = Bounds{ Point{ double(i % 100), double(i / 100) }, Dimension{ 1, 1 } };
+			canvas.add_member(rect);
+		}
+
+		const std::string svg = to_svg(canvas, 100, 50);
+		CHECK(svg.size() > svg::SvgWriter::FLUSH_SIZE);
+
+		size_t rects = 0;
+		for (size_t pos = svg.find("<rect x="); pos != std::string::npos; pos = svg.find("<rect x=", pos + 1)) rects++;
+		CHECK(rects == count);
+		CHECK(svg.size() >= 7 && svg.compare(svg.size() - 7, 6, "</svg>") == 0);
+	}
+
+	// lowered drawio diagram
+	{
+		DI::Diagram diagram;
+		parse_drawio_file("test.drawio.xml", &diagram);
+		Canvas canvas;
+		drawio::DrawioLowering().lower(&diagram, canvas);
+
+		const std::string svg = to_svg(canvas, 600, 400);
+		CHECK(svg.rfind("<?xml", 0) == 0);
+		CHECK(contains(svg, "viewBox=\"0 0 600 400\""));
+		CHECK(contains(svg, "<rect fill=\"#d5e8d4\" stroke=\"#82b366\" stroke-width=\"1\" x=\"100\" y=\"200\" width=\"120\" height=\"60\"/>"));
+		CHECK(contains(svg, "<marker id=\"marker0\""));
+		CHECK(!contains(svg, "99999"));
+		CHECK(contains(svg, "</svg>"));
+	}
+
+	return test::result();
+}
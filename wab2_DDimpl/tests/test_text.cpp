@@ -0,0 +1,125 @@
+#include "DiagramGraphicsRaster.hpp"
+#include "tests/check.hpp"
+
+/*
+* Text measurement, layout, glyph cache and rendering
+*/
+using namespace DG;
+
+namespace
+{
+	std::string line_text(const std::string& data, const text::LayoutLine& line)
+	{
+		return data.substr(line.begin, line.end - line.begin);
+	}
+}
+
+int main()
+{
+	// UTF-8 decoding and measurement
+	{
+		const std::string data = "A\xc3\x84\xe2\x82\xac\xff";
+		size_t position = 0;
+		CHECK(text::next_codepoint(data, position) == 'A');
+		CHECK(text::next_codepoint(data, position) == 0xc4);
+		CHECK(text::next_codepoint(data, position) == 0x20ac);
+		CHECK(text::next_codepoint(data, position) == 0xfffd);
+		CHECK(position == data.size());
+
+		// the font is monospaced, multi byte characters count once
+		CHECK(std::abs(text::measure(data, 0, data.size()) - 4 * text::ADVANCE) < 1e-12);
+
+		// truncated sequences do not read past the end
+		const std::string truncated = "\xe2\x82";
+		position = 0;
+		CHECK(text::next_codepoint(truncated, position) == 0xfffd);
+	}
+
+	// wrapped lines fit into the bounds and break between words
+	{
+		const std::string data = "Hello wonderful  world of diagrams, supercalifragilistic words";
+		const Bounds bounds{ Point{ 0, 0 }, Dimension{ 80, 100 } };
+		text::TextLayout layout;
+		text::layout(data, bounds, AlignmentKind::center, 10, true, layout);
+
+		CHECK(layout.lines.size() == 6);
+		CHECK(line_text(data, layout.lines[0]) == "Hello");
+		CHECK(line_text(data, layout.lines[2]) == "world of");
+
+		// a word longer than the line is split
+		CHECK(line_text(data, layout.lines[4]) == "supercalifrag");
+
+		for (const text::LayoutLine& line : layout.lines)
+		{
+			CHECK(line.width <= bounds.dim.width);
+			CHECK(line.origin.x >= 0 && line.origin.x + line.width <= bounds.dim.width);
+
+			// centered
+			CHECK(std::abs(line.origin.x + line.width / 2 - 40) <= 0.5);
+		}
+		for (size_t i = 1; i < layout.lines.size(); i++)
+		{
+			CHECK(std::abs(layout.lines[i].origin.y - layout.lines[i - 1].origin.y - 10 * text::LINE_HEIGHT) < 1e-9);
+		}
+
+		// without wrap only line breaks start new lines
+		text::layout("first\nsecond line", bounds, AlignmentKind::start, 10, false, layout);
+		CHECK(layout.lines.size() == 2);
+		CHECK(layout.lines[0].origin.x == 0);
+		CHECK(layout.lines[1].width > bounds.dim.width / 2);
+	}
+
+	// the glyph cache returns rasterized glyphs and evicts the least recently used one
+	{
+		text::GlyphCache cache(2);
+		const text::GlyphBitmap& a = cache.get('A', 20, false, false);
+		CHECK(a.width > 0 && a.height > 0);
+		cache.get('A', 20, false, false);
+		CHECK(cache.hits == 1 && cache.misses == 1);
+
+		// style and size are part of the key
+		cache.get('A', 20, true, false);
+		cache.get('A', 20, false, false);
+		cache.get('B', 20, false, false);
+		CHECK(cache.size() == 2);
+		CHECK(cache.misses == 3);
+
+		// the bold A was used least recently
+		cache.get('A', 20, true, false);
+		CHECK(cache.misses == 4);
+	}
+
+	// rendered text is drawn inside its bounds in the font color
+	{
+		Canvas canvas;
+		Text* label = canvas.create<Text>();
+		label->data = "Diagram";
+		label->bounds = Bounds{ Point{ 10, 10 }, Dimension{ 100, 30 } };
+		label->alignment = AlignmentKind::center;
+		label->s_local.push_back(Style().set_font_size(16).set_font_color(Color(0, 0, 255)));
+		canvas.add_member(label);
+
+		raster::RenderOptions o;
+		o.width = 120;
+		o.height = 50;
+		const raster::Image image = raster::render(canvas, o);
+
+		int inside = 0, outside = 0;
+		for (int y = 0; y < image.height; y++)
+		{
+			const uint8_t* row = image.row(y);
+			for (int x = 0; x < image.width; x++)
+			{
+				const uint8_t* p = row + x * 4;
+				// fully covered glyph pixels, anti-aliased edges blend with the white background
+				if (p[0] > 10 || p[1] > 10 || p[2] < 200) continue;
+				if (x >= 10 && x < 110 && y >= 10 && y < 40) inside++;
+				else outside++;
+			}
+		}
+		CHECK(inside > 50);
+		CHECK(outside == 0);
+	}
+
+	return test::result();
+}
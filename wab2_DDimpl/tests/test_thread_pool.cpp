@@ -0,0 +1,86 @@
+#include "DiagramThreadPool.hpp"
+#include "tests/check.hpp"
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+/*
+* Persistent worker threads
+*/
+int main()
+{
+	// every index runs exactly once, worker ids stay below the pool size
+	{
+		ThreadPool pool(4);
+		CHECK(pool.size() == 4);
+
+		std::vector<std::atomic<int>> calls(10000);
+		std::atomic<bool> worker_in_range{ true };
+		pool.parallel_for(calls.size(), [&](size_t i, unsigned worker)
+		{
+			calls[i]++;
+			if (worker >= pool.size()) worker_in_range = false;
+		});
+		bool once = true;
+		for (const std::atomic<int>& count : calls) once &= count == 1;
+		CHECK(once);
+		CHECK(worker_in_range);
+
+		// the same threads serve every loop
+		std::mutex mutex;
+		std::set<std::thread::id> seen;
+		for (int round = 0; round < 50; round++)
+		{
+			pool.parallel_for(64, [&](size_t, unsigned)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				seen.insert(std::this_thread::get_id());
+			});
+		}
+		CHECK(seen.size() <= pool.size());
+
+		// limited loops only use the first workers
+		std::atomic<bool> limited{ true };
+		pool.parallel_for(1000, [&](size_t, unsigned worker) { if (worker >= 2) limited = false; }, 2);
+		CHECK(limited);
+
+		// empty loops return immediately
+		pool.parallel_for(0, [&](size_t, unsigned) { CHECK(false); });
+	}
+
+	// exceptions reach the caller, the pool stays usable
+	{
+		ThreadPool pool(3);
+		bool thrown = false;
+		try
+		{
+			pool.parallel_for(1000, [](size_t i, unsigned)
+			{
+				if (i == 500) throw std::runtime_error("failed");
+			});
+		}
+		catch (const std::runtime_error&) { thrown = true; }
+		CHECK(thrown);
+
+		std::atomic<size_t> sum{ 0 };
+		pool.parallel_for(100, [&](size_t i, unsigned) { sum += i; });
+		CHECK(sum == 4950);
+	}
+
+	// loops started from inside a loop run on the calling thread
+	{
+		ThreadPool pool(2);
+		std::atomic<size_t> inner{ 0 };
+		pool.parallel_for(8, [&](size_t, unsigned)
+		{
+			pool.parallel_for(10, [&](size_t, unsigned nested_worker)
+			{
+				CHECK(nested_worker == 0);
+				inner++;
+			});
+		});
+		CHECK(inner == 80);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,90 @@
+#include "BijectiveModifiers.h"
+#include "tests/check.hpp"
+
+/*
+* Typed tables: values stay in their native type until they are exported
+*/
+struct Record
+{
+	int id = 0;
+	std::string name;
+	std::vector<Record*> children;
+};
+
+int main()
+{
+	std::vector<Record> records(5);
+	Record root;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		records.at(i).id = static_cast<int>(i) * 10;
+		records.at(i).name = "n" + std::to_string(i);
+		root.children.push_back(&records.at(i));
+	}
+
+	SelectiveView<Record> view([](const Record* node) { return node->children; }, &root);
+	BijectiveAlgorithm<Record> alg(view);
+	auto p_id = alg.make_path<int>([](const Record* r) { return r->id; }, [](Record* r, const int& v) { r->id = v; return true; });
+	auto p_name = alg.make_path<std::string>([](const Record* r) { return r->name; }, [](Record* r, const std::string& v) { r->name = v; return true; });
+	Column<Record, int>* col_id = alg.make_column(p_id, modifiers::int_to_string<Record>(), "ID");
+	Column<Record, std::string>* col_name = alg.make_column(p_name, BijeciveModifier<Record, std::string, std::string>::passthrough([](const std::string& s) { return s; }), "Name");
+	alg.register_column(col_id);
+	alg.register_column(col_name);
+
+	TypedTable<Record> table = alg.apply_typed();
+	CHECK(table.columns.size() == 2);
+	CHECK(table.column<int>(0).size() == 5);
+	CHECK(table.column<int>(0).at(2) == 20);
+	CHECK(table.export_strings() == alg.apply());
+
+	// the stored type is checked
+	bool thrown = false;
+	try { table.column<double>(0); }
+	catch (const std::logic_error&) { thrown = true; }
+	CHECK(thrown);
+
+	// only changed rows are reported and written
+	table.column<int>(0).at(2) = 21;
+	table.column<std::string>(1).at(0) = "first";
+	CHECK(table.columns.at(0)->diff(alg.view) == std::vector<size_t>{ 2 });
+	CHECK(table.columns.at(1)->diff(alg.view) == std::vector<size_t>{ 0 });
+	CHECK(table.columns.at(0)->export_value(2) == "21");
+
+	CHECK(alg.sync_with(table));
+	CHECK(records.at(2).id == 21);
+	CHECK(records.at(0).name == "first");
+	CHECK(table.columns.at(0)->diff(alg.view).empty());
+
+	// an edited row must not take the value of another row
+	table.column<int>(0).at(3) = 40;
+	CHECK(!table.columns.at(0)->is_valid(alg.view));
+	CHECK(!alg.sync_with(table));
+	CHECK(records.at(3).id == 30);
+
+	// neither may two edited rows take the same new value
+	table.column<int>(0).at(3) = 35;
+	table.column<int>(0).at(1) = 35;
+	CHECK(!alg.sync_with(table));
+	CHECK(records.at(1).id == 10 && records.at(3).id == 30);
+
+	// swapping values keeps the column bijective
+	table.column<int>(0).at(1) = 30;
+	table.column<int>(0).at(3) = 10;
+	CHECK(alg.sync_with(table));
+	CHECK(records.at(1).id == 30 && records.at(3).id == 10);
+
+	// load replaces the stored values with the tree
+	records.at(4).name = "changed";
+	table.columns.at(1)->load(alg.view);
+	CHECK(table.column<std::string>(1).at(4) == "changed");
+
+	// a table of another size is rejected before anything is written
+	table.column<int>(0).data.pop_back();
+	table.column<std::string>(1).at(1) = "unwritten";
+	CHECK(!alg.sync_with(table));
+	CHECK(records.at(1).name == "n1");
+
+	delete col_id;
+	delete col_name;
+	return test::result();
+}